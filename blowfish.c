@@ -42,8 +42,97 @@
 
   */ 
 
+#include <stdlib.h>
+#include <string.h>
 #include <blowfish.h>
 
+#ifdef _OPENMP
+
+#include <omp.h>
+
+#endif
+
+/* SIMD stream kernels are compiled using per-function target attributes, and only selected at runtime if the processor supports them (define BLOWFISH_NO_SIMD to disable). */ 
+
+#if !defined ( BLOWFISH_NO_SIMD ) && defined ( __GNUC__ ) && ( defined ( __x86_64__ ) || defined ( __i386__ ) )
+
+#define _BLOWFISH_SIMD
+
+#define _BLOWFISH_TARGET_AVX512	__attribute__ ( ( target ( "avx512f" ) ) )
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#endif
+
+/* Atomic pointer access, used to publish the selected kernel to other threads, atomic addition, used to share the thread budget, and atomic 32-bit access, used by the job queue. */ 
+
+#if defined ( __GNUC__ )
+
+#define _BLOWFISH_ATOMIC_LOAD_POINTER( Pointer )						__atomic_load_n ( &( Pointer ), __ATOMIC_ACQUIRE )
+#define _BLOWFISH_ATOMIC_STORE_POINTER( Pointer, Value )				__atomic_store_n ( &( Pointer ), Value, __ATOMIC_RELEASE )
+#define _BLOWFISH_ATOMIC_CAS_POINTER( Pointer, Expected, Value )		__sync_bool_compare_and_swap ( &( Pointer ), Expected, Value )
+#define _BLOWFISH_ATOMIC_ADD( Value, Delta )							__atomic_add_fetch ( &( Value ), Delta, __ATOMIC_ACQ_REL )
+#define _BLOWFISH_ATOMIC_LOAD( Value )									__atomic_load_n ( &( Value ), __ATOMIC_ACQUIRE )
+#define _BLOWFISH_ATOMIC_STORE( Value, New )							__atomic_store_n ( &( Value ), New, __ATOMIC_RELEASE )
+#define _BLOWFISH_ATOMIC_CAS( Value, Expected, New )					__sync_bool_compare_and_swap ( &( Value ), Expected, New )
+
+#elif defined ( _MSC_VER )
+
+#include <intrin.h>
+
+#define _BLOWFISH_ATOMIC_LOAD_POINTER( Pointer )						( Pointer )
+#define _BLOWFISH_ATOMIC_STORE_POINTER( Pointer, Value )				_InterlockedExchangePointer ( (void * volatile *)&( Pointer ), (void *)( Value ) )
+#define _BLOWFISH_ATOMIC_CAS_POINTER( Pointer, Expected, Value )		( _InterlockedCompareExchangePointer ( (void * volatile *)&( Pointer ), (void *)( Value ), (void *)( Expected ) ) == (void *)( Expected ) )
+#define _BLOWFISH_ATOMIC_ADD( Value, Delta )							( _InterlockedExchangeAdd ( &( Value ), Delta ) + ( Delta ) )
+#define _BLOWFISH_ATOMIC_LOAD( Value )									( Value )
+#define _BLOWFISH_ATOMIC_STORE( Value, New )							_InterlockedExchange ( (long volatile *)&( Value ), (long)( New ) )
+#define _BLOWFISH_ATOMIC_CAS( Value, Expected, New )					( _InterlockedCompareExchange ( (long volatile *)&( Value ), (long)( New ), (long)( Expected ) ) == (long)( Expected ) )
+
+#else
+
+/* Plain loads and stores are not atomic, and would let the job queue hand the same slot to two threads */ 
+
+#error "Atomic operations are not defined for this compiler"
+
+#endif
+
+/* Hint to the processor that the calling thread is spinning on a lock, which saves power and frees execution resources for a sibling hyperthread that may hold it. */ 
+
+#if defined ( __GNUC__ ) && ( defined ( __x86_64__ ) || defined ( __i386__ ) )
+
+#define _BLOWFISH_SPIN_PAUSE( )	__builtin_ia32_pause ( )
+
+#elif defined ( __GNUC__ ) && ( defined ( __aarch64__ ) || defined ( __arm__ ) )
+
+#define _BLOWFISH_SPIN_PAUSE( )	__asm__ __volatile__ ( "yield" )
+
+#elif defined ( _MSC_VER ) && ( defined ( _M_X64 ) || defined ( _M_IX86 ) )
+
+#define _BLOWFISH_SPIN_PAUSE( )	_mm_pause ( )
+
+#else
+
+#define _BLOWFISH_SPIN_PAUSE( )
+
+#endif
+
+/* Byte swap a 32-bit value (see #BLOWFISH_SetByteOrder), using the compiler's intrinsic where there is one, which compiles to a single instruction. */ 
+
+#if defined ( __GNUC__ )
+
+#define _BLOWFISH_BSWAP32( Value )	__builtin_bswap32 ( Value )
+
+#elif defined ( _MSC_VER )
+
+#define _BLOWFISH_BSWAP32( Value )	( (BLOWFISH_ULONG)_byteswap_ulong ( Value ) )
+
+#else
+
+#define _BLOWFISH_BSWAP32( Value )	( ( ( Value ) << 24 ) | ( ( ( Value ) << 8 ) & 0x00ff0000 ) | ( ( ( Value ) >> 8 ) & 0x0000ff00 ) | ( ( Value ) >> 24 ) )
+
+#endif
+
 /**
 
 	@ingroup blowfish
@@ -52,9 +141,7 @@
 
 	@details	See description for @ref blowfish.c
 
-	@todo		Include support for little-endian systems.
-
-	@todo		Remove restrictions on buffer lengths being a multiple of 8 by either padding input buffers, or truncating enciphered data, depending on the selected block cipher mode.
+	@todo		Remove the remaining restriction on buffer lengths being a multiple of 8, which applies to #BLOWFISH_EncipherBuffer/#BLOWFISH_DecipherBuffer (and their session and job equivalents) in every mode except #BLOWFISH_MODE_CBC_CS3, including #BLOWFISH_MODE_CBC_LANES, by truncating the final block of keystream in the CFB, OFB and CTR modes, and stealing ciphertext across the lanes in #BLOWFISH_MODE_CBC_LANES. Streams already accept any length, as do the padded buffer functions (#BLOWFISH_EncipherBufferPadded/#BLOWFISH_DecipherBufferPadded) and #BLOWFISH_MODE_CBC_CS3 buffers of at least 8 bytes.
 
   */ 
 
@@ -86,16 +173,52 @@
 
   */ 
 
+/* Internal function prototypes (key schedule expansion) */ 
+
+static void _BLOWFISH_EncipherBlock ( BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 );
+
 /* Internal function prototypes (Encipher/Decipher stream callbacks) */ 
 
-static void _BLOWFISH_EncipherStream_ECB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_DecipherStream_ECB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_EncipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_DecipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_EncipherStream_CFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_DecipherStream_CFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_EncipherDecipherStream_OFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
-static void _BLOWFISH_EncipherDecipherStream_CTR ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherStream_ECB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_ECB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherStream_CBC ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_CBC ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherStream_CFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_CFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherDecipherStream_OFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherDecipherStream_CTR ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherDecipherStream_CTR64 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherStream_ECB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_ECB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_CBC_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_DecipherStream_CFB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherDecipherStream_CTR_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static void _BLOWFISH_EncipherDecipherStream_CTR64_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+
+/* Internal function prototypes (multi-key encipher/decipher callbacks) */ 
+
+static void _BLOWFISH_EncipherKeys ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+static void _BLOWFISH_DecipherKeys ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+static void _BLOWFISH_EncipherKeys_X4 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+static void _BLOWFISH_DecipherKeys_X4 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+
+/* Internal function prototypes (keystream records) */ 
+
+static void _BLOWFISH_SetKeystream ( BLOWFISH_PSESSION Session, BLOWFISH_PKEYSTREAM Keystream );
+static void _BLOWFISH_DetachKeystream ( BLOWFISH_PSESSION Session );
+
+#ifdef _BLOWFISH_SIMD
+
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherStream_ECB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_ECB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_CBC_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_CFB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherDecipherStream_CTR_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherDecipherStream_CTR64_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherKeys_AVX512 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherKeys_AVX512 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count );
+
+#endif
 
 /** @internal Original S-Boxes (hexdigits of pi). */ 
 
@@ -379,572 +502,521 @@ static const BLOWFISH_ULONG _BLOWFISH_PArray [ BLOWFISH_SUBKEYS ] =
 	0xb5470917l, 0x9216d5d9l, 0x8979fb1bl
 };
 
-/**
-
-	@internal
-
-	Set the mode and original initialisation vector in a context record.
-
-	@param Context	Pointer to a context record to set the mode and initialisation vector.
-
-	@param Mode		Mode to use when enciphering/decipering blocks. For supported modes see #BLOWFISH_MODE.
-
-	@param IvHigh32	High 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+/** @internal Encipher/decipher stream callbacks provided by a kernel for each block cipher mode. */ 
 
-	@param IvLow32	Low 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+typedef struct __BLOWFISH_KERNEL_TABLE
+{
+	BLOWFISH_KERNEL	Kernel;												/*!< Kernel implementing the callbacks. */ 
+	void			( *EncipherStream [ BLOWFISH_MODE_CTR64 + 1 ] ) ( );	/*!< Encipher stream callbacks, indexed by #BLOWFISH_MODE. */ 
+	void			( *DecipherStream [ BLOWFISH_MODE_CTR64 + 1 ] ) ( );	/*!< Decipher stream callbacks, indexed by #BLOWFISH_MODE. */ 
+	void			( *EncipherKeys ) ( );								/*!< Multi-key encipher callback, see #BLOWFISH_EncipherMultiKey. */ 
+	void			( *DecipherKeys ) ( );								/*!< Multi-key decipher callback, see #BLOWFISH_DecipherMultiKey. */ 
 
-	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+} _BLOWFISH_KERNEL_TABLE;
 
-	@return #BLOWFISH_RC_SUCCESS		The mode and original initialisation vector were set successfully.
+/** @internal Scalar kernel, supported by all processors. */ 
 
-	@return #BLOWFISH_RC_INVALID_MODE	The mode supplied was invalid.
+static const _BLOWFISH_KERNEL_TABLE _BLOWFISH_KernelScalar =
+{
+	BLOWFISH_KERNEL_SCALAR,
+	{ 0, &_BLOWFISH_EncipherStream_ECB, &_BLOWFISH_EncipherStream_CBC, &_BLOWFISH_EncipherStream_CFB, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR, &_BLOWFISH_EncipherDecipherStream_CTR64 },
+	{ 0, &_BLOWFISH_DecipherStream_ECB, &_BLOWFISH_DecipherStream_CBC, &_BLOWFISH_DecipherStream_CFB, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR, &_BLOWFISH_EncipherDecipherStream_CTR64 },
+	&_BLOWFISH_EncipherKeys,
+	&_BLOWFISH_DecipherKeys
+};
 
-  */ 
+/** @internal Interleaved scalar kernel, supported by all processors. */ 
 
-static BLOWFISH_RC _BLOWFISH_SetMode ( BLOWFISH_PCONTEXT Context, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+static const _BLOWFISH_KERNEL_TABLE _BLOWFISH_KernelInterleaved =
 {
-	/* Validate the block cipher mode, and set pointers to the encipher/decipher stream callbacks */ 
-
-	switch ( Mode )
-	{
-		case BLOWFISH_MODE_ECB:
-		{
-			Context->EncipherStream = &_BLOWFISH_EncipherStream_ECB;
-			Context->DecipherStream = &_BLOWFISH_DecipherStream_ECB;
+	BLOWFISH_KERNEL_INTERLEAVED,
+	{ 0, &_BLOWFISH_EncipherStream_ECB_X4, &_BLOWFISH_EncipherStream_CBC, &_BLOWFISH_EncipherStream_CFB, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR_X4, &_BLOWFISH_EncipherDecipherStream_CTR64_X4 },
+	{ 0, &_BLOWFISH_DecipherStream_ECB_X4, &_BLOWFISH_DecipherStream_CBC_X4, &_BLOWFISH_DecipherStream_CFB_X4, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR_X4, &_BLOWFISH_EncipherDecipherStream_CTR64_X4 },
+	&_BLOWFISH_EncipherKeys_X4,
+	&_BLOWFISH_DecipherKeys_X4
+};
 
-			break;
-		}
-		case BLOWFISH_MODE_CBC:
-		{
-			Context->EncipherStream = &_BLOWFISH_EncipherStream_CBC;
-			Context->DecipherStream = &_BLOWFISH_DecipherStream_CBC;
+#ifdef _BLOWFISH_SIMD
 
-			break;
-		}
-		case BLOWFISH_MODE_CFB:
-		{
-			Context->EncipherStream = &_BLOWFISH_EncipherStream_CFB;
-			Context->DecipherStream = &_BLOWFISH_DecipherStream_CFB;
+/** @internal AVX-512 kernel. */ 
 
-			break;
-		}
-		case BLOWFISH_MODE_OFB:
-		{
-			Context->EncipherStream = &_BLOWFISH_EncipherDecipherStream_OFB;
-			Context->DecipherStream = &_BLOWFISH_EncipherDecipherStream_OFB;
+static const _BLOWFISH_KERNEL_TABLE _BLOWFISH_KernelAvx512 =
+{
+	BLOWFISH_KERNEL_AVX512,
+	{ 0, &_BLOWFISH_EncipherStream_ECB_AVX512, &_BLOWFISH_EncipherStream_CBC, &_BLOWFISH_EncipherStream_CFB, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR_AVX512, &_BLOWFISH_EncipherDecipherStream_CTR64_AVX512 },
+	{ 0, &_BLOWFISH_DecipherStream_ECB_AVX512, &_BLOWFISH_DecipherStream_CBC_AVX512, &_BLOWFISH_DecipherStream_CFB_AVX512, &_BLOWFISH_EncipherDecipherStream_OFB, &_BLOWFISH_EncipherDecipherStream_CTR_AVX512, &_BLOWFISH_EncipherDecipherStream_CTR64_AVX512 },
+	&_BLOWFISH_EncipherKeys_AVX512,
+	&_BLOWFISH_DecipherKeys_AVX512
+};
 
-			break;
-		}
-		case BLOWFISH_MODE_CTR:
-		{
-			Context->EncipherStream = &_BLOWFISH_EncipherDecipherStream_CTR;
-			Context->DecipherStream = &_BLOWFISH_EncipherDecipherStream_CTR;
+#endif
 
-			break;
-		}
-		default:
-		{
-			return BLOWFISH_RC_INVALID_MODE;
-		}
-	}
+/** @internal Names accepted by the BLOWFISH_KERNEL environment variable, indexed by #BLOWFISH_KERNEL. */ 
 
-	/* Save the initialisation vector */ 
+static const char * const _BLOWFISH_KernelName [ ] = { "auto", "scalar", "interleaved", "avx512" };
 
-	Context->OriginalIvHigh32 = IvHigh32;
-	Context->OriginalIvLow32 = IvLow32;
+/** @internal Kernel used when initialising context records (null until first use). */ 
 
-	return BLOWFISH_RC_SUCCESS;
-}
+static const _BLOWFISH_KERNEL_TABLE * volatile _BLOWFISH_ActiveKernel = 0;
 
 /**
 
 	@internal
 
-	Initialise the P-Array and S-Boxes in a context record based on the key.
+	Retrieve the kernel table for the specified kernel, if it is compiled in and supported by the processor and operating system.
 
-	@param Context		Pointer to a context record to initialise.
-
-	@param Key			Pointer to the key.
+	@param Kernel	Kernel to retrieve (must not be #BLOWFISH_KERNEL_AUTO).
 
-	@param KeyLength	Length of the Key buffer.
+	@return Pointer to the kernel table, or null if the kernel is not supported.
 
-	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+  */ 
 
-	@return #BLOWFISH_RC_SUCCESS		Successfully initialised the context record.
+static const _BLOWFISH_KERNEL_TABLE * _BLOWFISH_ProbeKernel ( BLOWFISH_KERNEL Kernel )
+{
+#ifdef _BLOWFISH_SIMD
 
-	@return #BLOWFISH_RC_INVALID_KEY	The length of the key is invalid.
+	unsigned int	Eax;
+	unsigned int	Ebx;
+	unsigned int	Ecx;
+	unsigned int	Edx;
+	unsigned int	Xcr0Low;
+	unsigned int	Xcr0High;
 
-	@return #BLOWFISH_RC_WEAK_KEY		The key has been deemed to be weak.
+#endif
 
-  */ 
+	if ( Kernel == BLOWFISH_KERNEL_SCALAR )
+	{
+		return &_BLOWFISH_KernelScalar;
+	}
 
-static BLOWFISH_RC _BLOWFISH_SetKey ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
-{
-	BLOWFISH_SIZE_T	i;
-	BLOWFISH_SIZE_T	j;
-	BLOWFISH_SIZE_T	k;
-	BLOWFISH_ULONG	Data = 0;
-	BLOWFISH_ULONG	XLeft = 0;
-	BLOWFISH_ULONG	XRight = 0;
+	if ( Kernel == BLOWFISH_KERNEL_INTERLEAVED )
+	{
+		return &_BLOWFISH_KernelInterleaved;
+	}
 
-	/* Ensure the key length is valid, ( between 4 and 56 bytes ) */ 
+#ifdef _BLOWFISH_SIMD
 
-	if ( KeyLength < BLOWFISH_MIN_KEY_LENGTH || KeyLength > BLOWFISH_MAX_KEY_LENGTH )
+	if ( Kernel != BLOWFISH_KERNEL_AVX512 )
 	{
-		return BLOWFISH_RC_INVALID_KEY;
+		return 0;
 	}
 
-	/* Copy the original S-Boxes to the context */ 
-
-	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	if ( __get_cpuid ( 1, &Eax, &Ebx, &Ecx, &Edx ) == 0 )
 	{
-		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j++ )
-		{
-			Context->SBox [ i ] [ j ] = _BLOWFISH_SBox [ i ] [ j ];
-		}
+		return 0;
 	}
 
-	/* XOR the original P-Array and key into the context P-Array */ 
+	/* AVX-512 requires the operating system to preserve the extended register state (XCR0) */ 
 
-	for ( i = 0, j = 0; i < BLOWFISH_SUBKEYS; i++ )
+	if ( ( Ecx & bit_OSXSAVE ) == 0 || ( Ecx & bit_AVX ) == 0 || __get_cpuid_max ( 0, 0 ) < 7 )
 	{
-		for ( k = 0; k < 4; k++ )
-		{
-			Data = ( Data << 8 ) | Key [ j ];
-
-			/* Have we reached the end of the key? */ 
+		return 0;
+	}
 
-			j++;
+	__asm__ __volatile__ ( "xgetbv" : "=a" ( Xcr0Low ), "=d" ( Xcr0High ) : "c" ( 0 ) );
 
-			if ( j >= KeyLength )
-			{
-				/* Resume from the begining of the key */ 
+	__cpuid_count ( 7, 0, Eax, Ebx, Ecx, Edx );
 
-				j = 0;
-			}
-		}
+	/* SSE, AVX, opmask and ZMM state */ 
 
-		Context->PArray [ i ] = _BLOWFISH_PArray [ i ] ^ Data;
-	}
+	return ( Xcr0Low & 0xe6 ) == 0xe6 && ( Ebx & bit_AVX512F ) != 0 ? &_BLOWFISH_KernelAvx512 : 0;
 
-	/* Update all entries in the context P-Array with output from the continuously changing blowfish algorithm */ 
+#else
 
-	for ( i = 0; i < BLOWFISH_SUBKEYS; i += 2 )
-	{
-		 BLOWFISH_Encipher ( Context, &XLeft, &XRight );
+	return 0;
 
-		 Context->PArray [ i ] = XLeft;
-		 Context->PArray [ i + 1 ] = XRight;
-	}
+#endif
+}
 
-	/* Update all entries in the context S-Boxes with output from the continuously changing blowfish algorithm */ 
+/**
 
-	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
-	{
-		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j += 2 )
-		{
-			BLOWFISH_Encipher ( Context, &XLeft, &XRight );
+	@internal
 
-			/* Test the strength of the key */ 
+	Select a kernel automatically, either as specified by the BLOWFISH_KERNEL environment variable, or the fastest supported by the processor.
 
-			if ( XLeft == XRight )
-			{
-				return BLOWFISH_RC_WEAK_KEY;
-			}
+	@remarks If the environment variable specifies a kernel that is not supported, the fastest supported kernel is used instead.
 
-			Context->SBox [ i ] [ j ] = XLeft;
-			Context->SBox [ i ] [ j + 1 ] = XRight;
-		}
-	}
+	@return Pointer to the selected kernel table.
 
-	return BLOWFISH_RC_SUCCESS;
-}
+  */ 
 
-BLOWFISH_RC BLOWFISH_Init ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+static const _BLOWFISH_KERNEL_TABLE * _BLOWFISH_SelectKernel ( void )
 {
-	BLOWFISH_RC	ReturnCode;
+	const _BLOWFISH_KERNEL_TABLE *	Table = 0;
+	const char *					Name = getenv ( "BLOWFISH_KERNEL" );
+	BLOWFISH_SIZE_T					i;
 
-	/* Ensure pointers are valid */ 
+	/* Has a specific kernel been requested? */ 
 
-	if ( Context == 0 || Key == 0 )
+	if ( Name != 0 )
 	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
-	}
+		for ( i = BLOWFISH_KERNEL_SCALAR; i < (BLOWFISH_SIZE_T)( sizeof ( _BLOWFISH_KernelName ) / sizeof ( _BLOWFISH_KernelName [ 0 ] ) ); i++ )
+		{
+			if ( strcmp ( Name, _BLOWFISH_KernelName [ i ] ) == 0 )
+			{
+				Table = _BLOWFISH_ProbeKernel ( (BLOWFISH_KERNEL)i );
 
-	/* Set the mode and initialisation vector */ 
+				break;
+			}
+		}
+	}
 
-	ReturnCode = _BLOWFISH_SetMode ( Context, Mode, IvHigh32, IvLow32 );
+	/* Otherwise use the AVX-512 kernel if supported, or the interleaved kernel */ 
 
-	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	if ( Table == 0 )
 	{
-		/* Initialise the P-Array and S-Boxes based on the key */ 
+		Table = _BLOWFISH_ProbeKernel ( BLOWFISH_KERNEL_AVX512 );
+	}
 
-		ReturnCode = _BLOWFISH_SetKey ( Context, Key, KeyLength );
+	if ( Table == 0 )
+	{
+		Table = &_BLOWFISH_KernelInterleaved;
 	}
 
-	return ReturnCode;
+	return Table;
 }
 
-BLOWFISH_RC BLOWFISH_Reset ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
-{
-	BLOWFISH_RC	ReturnCode = BLOWFISH_RC_SUCCESS;
+/**
 
-	/* Ensure the context pointer is valid */ 
+	@internal
 
-	if ( Context == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
-	}
+	Retrieve the kernel used when initialising context records, selecting one on first use.
 
-	/* Has a new mode been specified */ 
+	@return Pointer to the current kernel table.
 
-	if ( Mode != BLOWFISH_MODE_CURRENT )
+  */ 
+
+static const _BLOWFISH_KERNEL_TABLE * _BLOWFISH_GetKernelTable ( void )
+{
+	const _BLOWFISH_KERNEL_TABLE *	Table = _BLOWFISH_ATOMIC_LOAD_POINTER ( _BLOWFISH_ActiveKernel );
+
+	if ( Table == 0 )
 	{
-		/* Reinitialise the mode and initialisation vector */ 
+		/* Only publish the selection if no other thread has selected a kernel in the meantime */ 
 
-		ReturnCode = _BLOWFISH_SetMode ( Context, Mode, IvHigh32, IvLow32 );
+		Table = _BLOWFISH_SelectKernel ( );
 
-		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		if ( !_BLOWFISH_ATOMIC_CAS_POINTER ( _BLOWFISH_ActiveKernel, (const _BLOWFISH_KERNEL_TABLE *)0, Table ) )
 		{
-			return ReturnCode;
+			Table = _BLOWFISH_ATOMIC_LOAD_POINTER ( _BLOWFISH_ActiveKernel );
 		}
 	}
 
-	/* Has a new key been specified? */ 
-
-	if ( Key != 0 )
-	{
-		/* Reinitialise the P-Array and S-Boxes based on the new key */ 
-
-		ReturnCode = _BLOWFISH_SetKey ( Context, Key, KeyLength );
-	}
-
-	return ReturnCode;
+	return Table;
 }
 
-BLOWFISH_RC BLOWFISH_CloneContext ( BLOWFISH_PCONTEXT InContext, BLOWFISH_PCONTEXT OutContext )
+BLOWFISH_RC BLOWFISH_SetKernel ( BLOWFISH_KERNEL Kernel )
 {
-	if ( InContext == 0 || OutContext == 0 )
+	const _BLOWFISH_KERNEL_TABLE *	Table;
+
+	if ( Kernel == BLOWFISH_KERNEL_AUTO )
 	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
+		Table = _BLOWFISH_SelectKernel ( );
 	}
+	else
+	{
+		Table = _BLOWFISH_ProbeKernel ( Kernel );
 
-	/* Copy the context record */ 
+		if ( Table == 0 )
+		{
+			return BLOWFISH_RC_KERNEL_NOT_SUPPORTED;
+		}
+	}
 
-	*OutContext = *InContext;
+	_BLOWFISH_ATOMIC_STORE_POINTER ( _BLOWFISH_ActiveKernel, Table );
 
 	return BLOWFISH_RC_SUCCESS;
 }
 
-BLOWFISH_RC BLOWFISH_Exit ( BLOWFISH_PCONTEXT Context )
+BLOWFISH_KERNEL BLOWFISH_GetKernel ( void )
 {
-	BLOWFISH_PUCHAR	MemoryToWipe = (BLOWFISH_PUCHAR)Context;
-	BLOWFISH_SIZE_T	i;
+	return _BLOWFISH_GetKernelTable ( )->Kernel;
+}
 
-	/* Ensure the context pointer is valid */ 
+/** @internal Minimum number of bytes processed by each thread of a parallelised stream function. */ 
 
-	if ( Context == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
-	}
+static volatile BLOWFISH_SIZE_T _BLOWFISH_ParallelThreshold = BLOWFISH_DEFAULT_PARALLEL_THRESHOLD;
 
-	/* Overwrite the context record with null bytes (do not use memset!) */ 
+#ifdef _OPENMP
 
-	for ( i = 0; i < (BLOWFISH_SIZE_T)sizeof ( *Context ); i++ )
-	{
-		MemoryToWipe [ i ] = 0x00;
-	}
+/** @internal Number of threads currently reserved by parallel regions of the library, across all calling threads. */ 
 
-	return BLOWFISH_RC_SUCCESS;
-}
+static volatile long _BLOWFISH_ReservedThreads = 0;
 
 /**
 
 	@internal
 
-	Restore the original initialisation vector in a context record.
+	Reserve threads for a parallel region from the budget shared by all callers of the library.
 
-	@param Context	Pointer to an initialised context record.
+	@param Wanted	Number of threads wanted, including the calling thread.
 
-*/ 
+	@remarks The budget is the maximum number of OpenMP threads. When other calls already hold part of it, fewer threads are granted, down to the calling thread alone. Calls made from within a parallel region are never given more threads.
 
-#define _BLOWFISH_BEGINSTREAM( Context )			\
-{													\
-	Context->IvHigh32 = Context->OriginalIvHigh32;	\
-	Context->IvLow32 = Context->OriginalIvLow32;	\
-}
+	@return Number of threads granted (at least 1). If more than 1, they must be returned with #_BLOWFISH_ReleaseThreads.
 
-BLOWFISH_RC BLOWFISH_BeginStream ( BLOWFISH_PCONTEXT Context )
+  */ 
+
+static int _BLOWFISH_ReserveThreads ( BLOWFISH_SIZE_T Wanted )
 {
-	/* Ensure the context pointer is valid */ 
+	long	MaxThreads = omp_get_max_threads ( );
+	long	Reserved;
+	long	Others;
+	long	Granted;
 
-	if ( Context == 0 )
+	if ( Wanted <= 1 || MaxThreads <= 1 || omp_in_parallel ( ) )
 	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
+		return 1;
 	}
 
-	_BLOWFISH_BEGINSTREAM ( Context );
+	/* Reserve what is wanted, then give back whatever exceeds the budget left by other calls */ 
 
-	return BLOWFISH_RC_SUCCESS;
+	Reserved = Wanted < MaxThreads ? (long)Wanted : MaxThreads;
+	Others = _BLOWFISH_ATOMIC_ADD ( _BLOWFISH_ReservedThreads, Reserved ) - Reserved;
+	Granted = MaxThreads - Others < Reserved ? MaxThreads - Others : Reserved;
+
+	if ( Granted < 2 )
+	{
+		_BLOWFISH_ATOMIC_ADD ( _BLOWFISH_ReservedThreads, -Reserved );
+
+		return 1;
+	}
+
+	if ( Granted < Reserved )
+	{
+		_BLOWFISH_ATOMIC_ADD ( _BLOWFISH_ReservedThreads, Granted - Reserved );
+	}
+
+	return (int)Granted;
 }
 
 /**
 
 	@internal
 
-	Overwrite the final initialisation vector in a context record.
-
-	@param Context	Pointer to an initialised context record.
+	Return threads reserved by #_BLOWFISH_ReserveThreads to the shared budget.
 
-*/ 
+	@param Threads	Number of threads granted.
 
-#define _BLOWFISH_ENDSTREAM( Context )	\
-{										\
-	Context->IvHigh32 = 0;				\
-	Context->IvLow32 = 0;				\
-}
+  */ 
 
-BLOWFISH_RC BLOWFISH_EndStream ( BLOWFISH_PCONTEXT Context )
+static void _BLOWFISH_ReleaseThreads ( int Threads )
 {
-	/* Ensure the context pointer is valid */ 
-
-	if ( Context == 0 )
+	if ( Threads > 1 )
 	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
+		_BLOWFISH_ATOMIC_ADD ( _BLOWFISH_ReservedThreads, -(long)Threads );
 	}
 
-	_BLOWFISH_ENDSTREAM ( Context );
-
-	return BLOWFISH_RC_SUCCESS;
+	return;
 }
 
 /**
 
 	@internal
 
-	Perform a single round of the cipher.
+	Reserve threads for a parallelised stream function, and record the number granted in the session record.
 
-	xL = xL XOR Pn
+	@param Session		Pointer to the session record being processed.
 
-	xR = F(xL) XOR xR
+	@param StreamLength	Length of the stream in 4-byte blocks.
 
-	Divide xL into four eight-bit quarters: a, b, c, and d.
+	@remarks Streams shorter than twice the threshold are processed by the calling thread alone, so that small buffers do not pay the cost of waking the rest of the team. The number of threads is also limited by the session record's budget, if any.
 
-	Then, F(xL) = ((S0,a + S1,b mod 232) XOR S2,c) + S3,d mod 232. 
+	@return Number of threads to use. The threads are returned by #_BLOWFISH_CallStream.
 
-	See @link glossary @endlink for more information.
+  */ 
 
-	@remarks After each round the caller must swap xL and xR.
+static int _BLOWFISH_StreamThreads ( BLOWFISH_PSESSION Session, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_SIZE_T	Wanted = ( StreamLength * 4 ) / _BLOWFISH_ParallelThreshold;
 
-	@param XLeft			High 32-bits of the message to encipher.
+	/* Later regions of the same call (such as the remaining blocks of a vector kernel) are run by the calling thread, keeping the threads already reserved */ 
 
-	@param XRight			Low 32-bits of the message to encipher.
+	if ( Session->Threads > 1 )
+	{
+		return 1;
+	}
 
-	@param P				Pointer to the P-Array.
+	if ( Session->MaxThreads != 0 && Wanted > (BLOWFISH_SIZE_T)Session->MaxThreads )
+	{
+		Wanted = (BLOWFISH_SIZE_T)Session->MaxThreads;
+	}
 
-	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+	Session->Threads = (BLOWFISH_ULONG)_BLOWFISH_ReserveThreads ( Wanted );
 
-	@param Round			Current round to perform (0-15 to encipher, 17-2 to decipher).
+	return (int)Session->Threads;
+}
 
-  */ 
+#endif
 
-#define _BLOWFISH_CIPHER( XLeft, XRight, P, S0, S1, S2, S3, Round )	\
-{																	\
-	XLeft ^= P [ Round ];											\
-	XRight ^= ( ( ( S0 [ XLeft >> 24 ] +							\
-		S1 [ ( XLeft >> 16 ) & 0xff ] ) ^							\
-		S2 [ ( XLeft >> 8 ) & 0xff ] ) +							\
-		S3 [ XLeft & 0xff ] );										\
-}
+/** @internal Executor registered by #BLOWFISH_SetExecutor, or null to use OpenMP. */ 
+
+static const BLOWFISH_EXECUTOR * volatile _BLOWFISH_Executor = 0;
 
 /**
 
 	@internal
 
-	Perform 16-round encipher, finalise round and unswap xL and xR:
-
-	xR = xR XOR P18
+	Run the iterations [0, Count) of a parallel loop on the registered executor, on OpenMP threads reserved from the shared budget, or on the calling thread.
 
-	xL = xL XOR P17
+	@param Count		Number of iterations.
 
-	See @link glossary @endlink for more information.
+	@param Body			Callback to run for each range of iterations.
 
-	@param BufferHigh		Pointer to the high 32-bits of the output buffer.
+	@param BodyContext	Value passed to the callback.
 
-	@param BufferLow		Pointer to the low 32-bits of the output buffer.
+	@remarks Each iteration should be a substantial amount of work (such as a group of keys or messages), as OpenMP runs them one at a time.
 
-	@param XLeft			High 32-bits of the message to encipher.
+  */ 
 
-	@param XRight			Low 32-bits of the message to encipher.
+static void _BLOWFISH_ParallelFor ( BLOWFISH_SIZE_T Count, BLOWFISH_PARALLEL_BODY Body, void * BodyContext )
+{
+	const BLOWFISH_EXECUTOR *	Executor = _BLOWFISH_ATOMIC_LOAD_POINTER ( _BLOWFISH_Executor );
 
-	@param P				Pointer to the P-Array.
+#ifdef _OPENMP
 
-	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+	BLOWFISH_SIZE_T				i;
+	int							Threads;
 
-	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+#endif
 
-  */ 
+	if ( Count == 0 )
+	{
+		return;
+	}
 
-#define _BLOWFISH_ENCIPHER( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3 )	\
-{																						\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 0 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 1 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 2 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 3 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 4 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 5 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 6 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 7 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 8 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 9 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 10 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 11 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 12 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 13 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 14 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 15 );							\
-	BufferLow = XLeft ^ P [ 16 ];														\
-	BufferHigh = XRight ^ P [ 17 ];														\
-}
+	if ( Executor != 0 && Count > 1 )
+	{
+		Executor->ParallelFor ( Executor->Context, 0, Count, 1, Body, BodyContext );
 
-void BLOWFISH_Encipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
-{
-	BLOWFISH_ULONG	XLeft = *High32;
-	BLOWFISH_ULONG	XRight = *Low32;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
+		return;
+	}
 
-	/* Encipher 8-byte plaintext block */ 
+#ifdef _OPENMP
 
-	_BLOWFISH_ENCIPHER ( *High32, *Low32, XLeft, XRight, P, S0, S1, S2, S3 );
+	Threads = _BLOWFISH_ReserveThreads ( Count );
 
-	return;
-}
+	/* A single thread runs the loop without entering a parallel region, which would add to the cost of any regions entered by the body */ 
 
-/**
+	if ( Threads == 1 )
+	{
+		Body ( BodyContext, 0, Count );
 
-	@internal
+		return;
+	}
 
-	Encipher a stream of data in electronic codebook mode.
+	#pragma omp parallel for default ( none ) private ( i ) shared ( Count, Body, BodyContext ) schedule ( dynamic ) num_threads ( Threads )
 
-	Cn = Ek ( Pn )
+	for ( i = 0; i < Count; i++ )
+	{
+		Body ( BodyContext, i, i + 1 );
+	}
 
-	See @link glossary @endlink for more information.
+	_BLOWFISH_ReleaseThreads ( Threads );
 
-	@param Context			Pointer to an initialised context record.
+#else
 
-	@param PlainTextStream	Buffer of plaintext to encipher.
+	Body ( BodyContext, 0, Count );
 
-	@param CipherTextStream	Buffer to receive the ciphertext.
+#endif
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+	return;
+}
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+/**
 
-	@remarks This function can be parallelised using OpenMP.
+	@internal
 
-  */ 
+	Load a 32-bit word of stream data.
 
-static void _BLOWFISH_EncipherStream_ECB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+	@param Word		Pointer to the word, which need not be aligned.
 
-	/* Encipher plaintext in 8-byte blocks */ 
+	@param Swap		Non-zero to byte swap the word (see #BLOWFISH_SetByteOrder).
 
-#ifdef _OPENMP
+	@remarks Copying the word, rather than dereferencing a pointer to it, compiles to a single load that is valid at any alignment.
 
-	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength ) schedule ( static )
+	@return The word, in the byte order of the host.
 
-#endif
+  */ 
 
-	for ( i = 0; i < StreamLength; i += 2 )
-	{
-		XLeft = PlainTextStream [ i ];
-		XRight = PlainTextStream [ i + 1 ];
+static BLOWFISH_ULONG _BLOWFISH_Load ( const void * Word, BLOWFISH_ULONG Swap )
+{
+	BLOWFISH_ULONG	Value;
 
-		_BLOWFISH_ENCIPHER ( CipherTextStream [ i ], CipherTextStream [ i + 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
-	}
+	memcpy ( &Value, Word, sizeof ( Value ) );
 
-	return;
+	return Swap != 0 ? _BLOWFISH_BSWAP32 ( Value ) : Value;
 }
 
 /**
 
 	@internal
 
-	Encipher a stream of data in cipher block chaining mode.
-
-	Round 1:
+	Store a 32-bit word of stream data.
 
-	C0 = Ek ( P0 XOR Iv )
+	@param Word		Pointer to the word, which need not be aligned.
 
-	Round n:
+	@param Value	Word to store, in the byte order of the host.
 
-	Cn = Ek ( Pn XOR ( Cn - 1 ) )
+	@param Swap		Non-zero to byte swap the word (see #BLOWFISH_SetByteOrder).
 
-	See @link glossary @endlink for more information.
+  */ 
 
-	@param Context			Pointer to an initialised context record.
+static void _BLOWFISH_Store ( void * Word, BLOWFISH_ULONG Value, BLOWFISH_ULONG Swap )
+{
+	if ( Swap != 0 )
+	{
+		Value = _BLOWFISH_BSWAP32 ( Value );
+	}
 
-	@param PlainTextStream	Buffer of plaintext to encipher.
+	memcpy ( Word, &Value, sizeof ( Value ) );
 
-	@param CipherTextStream	Buffer to receive the ciphertext.
+	return;
+}
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+/** @internal Maximum number of ranges a chained stream is split into when deciphering (see #_BLOWFISH_CallStream). */ 
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+#define _BLOWFISH_MAX_CHAINED_RANGES	256
 
-  */ 
+/** @internal A stream being split into ranges of blocks run in parallel. */ 
 
-static void _BLOWFISH_EncipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+typedef struct __BLOWFISH_STREAM_SPLIT
 {
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
-
-	/* XOR the first block of plaintext with the initialisation vector */ 
+	BLOWFISH_PSESSION	Session;			/*!< Session record the stream is processed with (only read while the ranges run). */ 
+	void				( *Callback ) ( );	/*!< Stream callback run on each range. */ 
+	BLOWFISH_PCULONG	InStream;			/*!< Input stream. */ 
+	BLOWFISH_PULONG		OutStream;			/*!< Output stream. */ 
+	BLOWFISH_SIZE_T		Blocks;				/*!< Length of the stream in 8-byte blocks. */ 
+	BLOWFISH_SIZE_T		RangeBlocks;		/*!< Length of each range in 8-byte blocks (except perhaps the last), or 1 if the executor chooses the ranges. */ 
+	BLOWFISH_PULONG		Chain;				/*!< Ciphertext block preceding each range but the first, when deciphering a chained mode (saved before any range runs, as deciphering in place overwrites it). */ 
+	volatile long		Ranges;				/*!< Number of ranges run. */ 
+	BLOWFISH_ULONG		IvHigh32;			/*!< High 32-bits of the initialisation vector after the last range. */ 
+	BLOWFISH_ULONG		IvLow32;			/*!< Low 32-bits of the initialisation vector after the last range. */ 
+
+} _BLOWFISH_STREAM_SPLIT;
 
-	XLeft = PlainTextStream [ 0 ] ^ Context->IvHigh32;
-	XRight = PlainTextStream [ 1 ] ^ Context->IvLow32;
+/**
 
-	/* Encipher the first block of plaintext */ 
+	@internal
 
-	_BLOWFISH_ENCIPHER ( CipherTextStream [ 0 ], CipherTextStream [ 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
+	Save the ciphertext block preceding each range of a chained stream being deciphered, before any range runs.
 
-	/* Encrypt any remaining blocks */ 
+	@param Split	Pointer to the stream being split, whose RangeBlocks and Chain members are set.
 
-	for ( i = 2; i < StreamLength; i += 2 )
-	{
-		/* XOR the block of plaintext with the previous block of ciphertext */ 
+	@param Ranges	Number of ranges (at most #_BLOWFISH_MAX_CHAINED_RANGES).
 
-		XLeft = PlainTextStream [ i ] ^ CipherTextStream [ i - 2 ];
-		XRight = PlainTextStream [ i + 1 ] ^ CipherTextStream [ i - 1 ];
+  */ 
 
-		/* Encipher the block of plaintext  */ 
+static void _BLOWFISH_SaveChain ( _BLOWFISH_STREAM_SPLIT * Split, BLOWFISH_SIZE_T Ranges )
+{
+	BLOWFISH_SIZE_T	i;
 
-		_BLOWFISH_ENCIPHER ( CipherTextStream [ i ], CipherTextStream [ i + 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
+	for ( i = 1; i < Ranges; i++ )
+	{
+		Split->Chain [ i * 2 - 2 ] = _BLOWFISH_Load ( Split->InStream + i * Split->RangeBlocks * 2 - 2, Split->Session->SwapBytes );
+		Split->Chain [ i * 2 - 1 ] = _BLOWFISH_Load ( Split->InStream + i * Split->RangeBlocks * 2 - 1, Split->Session->SwapBytes );
 	}
 
-	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
-
-	Context->IvHigh32 = CipherTextStream [ i - 2 ];
-	Context->IvLow32 = CipherTextStream [ i - 1 ];
-
 	return;
 }
 
@@ -952,75 +1024,77 @@ static void _BLOWFISH_EncipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_P
 
 	@internal
 
-	Encipher a stream of data in cipher feedback mode.
+	Run a stream callback on a range of blocks, with a copy of the session record positioned at the first block of the range.
 
-	Round 1:
+	@param BodyContext	Pointer to the stream being split (see #_BLOWFISH_STREAM_SPLIT).
 
-	C0 = P0 XOR Ek ( Iv )
+	@param Begin		Index of the first range (of RangeBlocks blocks) to run.
 
-	Round n:
+	@param End			Index of the range following the last to run.
 
-	Cn = Pn XOR Ek ( ( Cn - 1 ) )
+  */ 
 
-	See @link glossary @endlink for more information.
+static void _BLOWFISH_StreamRange ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	_BLOWFISH_STREAM_SPLIT *	Split = (_BLOWFISH_STREAM_SPLIT *)BodyContext;
+	BLOWFISH_SESSION			Session = *Split->Session;
+	BLOWFISH_SIZE_T				First = Begin * Split->RangeBlocks;
+	BLOWFISH_SIZE_T				Last = End * Split->RangeBlocks < Split->Blocks ? End * Split->RangeBlocks : Split->Blocks;
+	BLOWFISH_ULONGLONG			Counter;
 
-	@param Context			Pointer to an initialised context record.
+	switch ( Session.Mode )
+	{
+		case BLOWFISH_MODE_CBC:
+		case BLOWFISH_MODE_CBC_CS3:
+		case BLOWFISH_MODE_CFB:
 
-	@param PlainTextStream	Buffer of plaintext to encipher.
+			/* Deciphering chains from the ciphertext block saved before the ranges ran */ 
 
-	@param CipherTextStream	Buffer to receive the ciphertext.
+			if ( Begin > 0 )
+			{
+				Session.IvHigh32 = Split->Chain [ Begin * 2 - 2 ];
+				Session.IvLow32 = Split->Chain [ Begin * 2 - 1 ];
+			}
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+			break;
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+		case BLOWFISH_MODE_CTR:
 
-  */ 
+			/* Both halves of the counter advance by one per 4-byte block */ 
 
-static void _BLOWFISH_EncipherStream_CFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft = Context->IvHigh32;
-	BLOWFISH_ULONG	XRight = Context->IvLow32;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+			Session.IvHigh32 += (BLOWFISH_ULONG)( First * 2 );
+			Session.IvLow32 += (BLOWFISH_ULONG)( First * 2 );
 
-	/* Encipher the initialisation vector */ 
+			break;
 
-	_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+		case BLOWFISH_MODE_CTR64:
 
-	/* XOR the enciphered initialisation vector with the plaintext to yeild the ciphertext */ 
+			Counter = ( ( (BLOWFISH_ULONGLONG)Session.IvHigh32 << 32 ) | Session.IvLow32 ) + (BLOWFISH_ULONGLONG)First;
 
-	XRight ^= PlainTextStream [ 0 ];
-	XLeft ^= PlainTextStream [ 1 ];
+			Session.IvHigh32 = (BLOWFISH_ULONG)( Counter >> 32 );
+			Session.IvLow32 = (BLOWFISH_ULONG)Counter;
 
-	CipherTextStream [ 0 ] = XRight;
-	CipherTextStream [ 1 ] = XLeft;
+			break;
 
-	for ( i = 2; i < StreamLength; i += 2 )
-	{
-		/* Encipher the previous block of ciphertext */ 
+		default:
 
-		XLeft = CipherTextStream [ i - 2 ];
-		XRight = CipherTextStream [ i - 1 ];
+			break;
+	}
 
-		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+	/* The executor provides the parallelism, so the callback runs on this thread alone */ 
 
-		/* XOR the enciphered previous block of ciphertext with the plaintext to yeild the current block of ciphertext */ 
+	Session.MaxThreads = 1;
+	Session.Threads = 1;
 
-		XRight ^= PlainTextStream [ i ];
-		XLeft ^= PlainTextStream [ i + 1 ];
+	Split->Callback ( &Session, Split->InStream + First * 2, Split->OutStream + First * 2, ( Last - First ) * 2 );
 
-		CipherTextStream [ i ] = XRight;
-		CipherTextStream [ i + 1 ] = XLeft;
+	if ( Last == Split->Blocks )
+	{
+		Split->IvHigh32 = Session.IvHigh32;
+		Split->IvLow32 = Session.IvLow32;
 	}
 
-	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
-
-	Context->IvHigh32 = XRight;
-	Context->IvLow32 = XLeft;
+	_BLOWFISH_ATOMIC_ADD ( Split->Ranges, 1 );
 
 	return;
 }
@@ -1029,272 +1103,6916 @@ static void _BLOWFISH_EncipherStream_CFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_P
 
 	@internal
 
-	Encipher/Decipher a stream of data in output feedback mode.
-
-	Iv = Ek ( Iv )
-
-	Cn = Pn XOR Iv
+	Call an encipher/decipher stream callback, returning any threads it reserved once it completes.
 
-	To decipher simply swap C and P.
+	@param Session		Pointer to an initialised session record.
 
-	See @link glossary @endlink for more information.
+	@param Callback		Stream callback to call.
 
-	@param Context		Pointer to an initialised context record.
+	@param Decipher		Non-zero if the callback deciphers the stream.
 
-	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+	@param InStream		Pointer to the input stream.
 
-	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+	@param OutStream	Pointer to the output stream.
 
-	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+	@param StreamLength	Length of the stream in 4-byte blocks.
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+	@remarks If an executor is registered and every block can be processed independently of the output of the blocks before it, the stream is split into ranges run by the executor instead. Chained modes are deciphered in ranges fixed in advance (one per thread under OpenMP), so that the ciphertext block each range chains from can be saved before deciphering in place overwrites it.
 
   */ 
 
-static void _BLOWFISH_EncipherDecipherStream_OFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+static void _BLOWFISH_CallStream ( BLOWFISH_PSESSION Session, void ( *Callback ) ( ), int Decipher, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
 {
-	BLOWFISH_ULONG	XLeft = Context->IvHigh32;
-	BLOWFISH_ULONG	XRight = Context->IvLow32;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+	const BLOWFISH_EXECUTOR *	Executor = _BLOWFISH_ATOMIC_LOAD_POINTER ( _BLOWFISH_Executor );
+	_BLOWFISH_STREAM_SPLIT		Split;
+	BLOWFISH_ULONG				Chain [ ( _BLOWFISH_MAX_CHAINED_RANGES - 1 ) * 2 ];
+	BLOWFISH_SIZE_T				Grain;
+	BLOWFISH_SIZE_T				Ranges;
+	int							Chained = Decipher && ( Session->Mode == BLOWFISH_MODE_CBC || Session->Mode == BLOWFISH_MODE_CBC_CS3 || Session->Mode == BLOWFISH_MODE_CFB );
 
-	for ( i = 0; i < StreamLength; i += 2 )
-	{
-		/* Encipher the initialisation vector */ 
+#ifdef _OPENMP
 
-		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+	BLOWFISH_SIZE_T				i;
+	int							Threads;
 
-		/* Store and swap the enciphered initialisation vector */ 
+#endif
 
-		OutStream [ i ] = XRight;
-		OutStream [ i + 1 ] = XLeft;
+	Split.Session = Session;
+	Split.Callback = Callback;
+	Split.InStream = InStream;
+	Split.OutStream = OutStream;
+	Split.Blocks = StreamLength >> 1;
+	Split.RangeBlocks = 1;
+	Split.Chain = Chain;
+	Split.Ranges = 0;
+	Split.IvHigh32 = Session->IvHigh32;
+	Split.IvLow32 = Session->IvLow32;
+
+	if ( Executor != 0 && ( Session->Mode == BLOWFISH_MODE_ECB || Session->Mode == BLOWFISH_MODE_CTR || Session->Mode == BLOWFISH_MODE_CTR64 || Chained ) )
+	{
+		/* Streams shorter than twice the threshold are not split, and the ranges are lengthened so there are no more of them than the session record's thread limit */ 
 
-		XLeft = OutStream [ i ];
-		XRight = OutStream [ i + 1 ];
+		Grain = _BLOWFISH_ParallelThreshold >> 3;
 
-		/* XOR the enciphered initialisation vector with the ciphertext or plaintext */ 
+		if ( Split.Blocks >= Grain * 2 && Session->MaxThreads != 0 && Grain < ( Split.Blocks + (BLOWFISH_SIZE_T)Session->MaxThreads - 1 ) / (BLOWFISH_SIZE_T)Session->MaxThreads )
+		{
+			Grain = ( Split.Blocks + (BLOWFISH_SIZE_T)Session->MaxThreads - 1 ) / (BLOWFISH_SIZE_T)Session->MaxThreads;
+		}
 
-		OutStream [ i ] ^= InStream [ i ];
-		OutStream [ i + 1 ] ^= InStream [ i + 1 ];
-	}
+		if ( Split.Blocks >= Grain * 2 || ( Session->MaxThreads > 1 && Split.Blocks > Grain ) )
+		{
+			if ( Chained )
+			{
+				/* Fix the ranges in advance (no more of them than can be saved), and save the block each chains from */ 
 
-	/* Preserve the enciphered initialisation vector as the new initialisation vector for stream based operations */ 
+				Split.RangeBlocks = ( Split.Blocks + _BLOWFISH_MAX_CHAINED_RANGES - 1 ) / _BLOWFISH_MAX_CHAINED_RANGES;
 
-	Context->IvHigh32 = XLeft;
-	Context->IvLow32 = XRight;
+				if ( Split.RangeBlocks < Grain )
+				{
+					Split.RangeBlocks = Grain;
+				}
 
-	return;
-}
+				Ranges = ( Split.Blocks + Split.RangeBlocks - 1 ) / Split.RangeBlocks;
 
-/**
+				_BLOWFISH_SaveChain ( &Split, Ranges );
 
-	@internal
+				Executor->ParallelFor ( Executor->Context, 0, Ranges, 1, &_BLOWFISH_StreamRange, &Split );
+			}
+			else
+			{
+				Executor->ParallelFor ( Executor->Context, 0, Split.Blocks, Grain, &_BLOWFISH_StreamRange, &Split );
+			}
 
-	Encipher/Decipher a stream of data in counter (segmented integer counter) mode.
+			Session->IvHigh32 = Split.IvHigh32;
+			Session->IvLow32 = Split.IvLow32;
+			Session->Threads = (BLOWFISH_ULONG)Split.Ranges;
 
-	O = Ek ( Iv ADD ( n ) )
+			return;
+		}
+	}
 
-	Cn = Pn XOR O
+	/* Callbacks that are not parallelised leave the calling thread as the only one used */ 
 
-	To decipher simply swap C and P.
+	Session->Threads = 1;
 
-	See @link glossary @endlink for more information.
+#ifdef _OPENMP
 
-	@param Context		Pointer to an initialised context record.
+	if ( Chained )
+	{
+		/* Decipher a range of the stream on each thread, chaining each from the saved block preceding it */ 
 
-	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+		Threads = _BLOWFISH_StreamThreads ( Session, StreamLength );
 
-	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+		if ( Threads > 1 )
+		{
+			Ranges = Threads < _BLOWFISH_MAX_CHAINED_RANGES ? (BLOWFISH_SIZE_T)Threads : _BLOWFISH_MAX_CHAINED_RANGES;
 
-	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+			Split.RangeBlocks = ( Split.Blocks + Ranges - 1 ) / Ranges;
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+			Ranges = ( Split.Blocks + Split.RangeBlocks - 1 ) / Split.RangeBlocks;
 
-	@remarks This function can be parallelised using OpenMP.
+			_BLOWFISH_SaveChain ( &Split, Ranges );
 
-  */ 
+			#pragma omp parallel for default ( none ) private ( i ) shared ( Split, Ranges ) schedule ( static ) num_threads ( (int)Ranges )
 
-static void _BLOWFISH_EncipherDecipherStream_CTR ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_ULONG	IvHigh32 = Context->IvHigh32;
-	BLOWFISH_ULONG	IvLow32 = Context->IvLow32;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+			for ( i = 0; i < Ranges; i++ )
+			{
+				_BLOWFISH_StreamRange ( &Split, i, i + 1 );
+			}
 
-#ifdef _OPENMP
+			Session->IvHigh32 = Split.IvHigh32;
+			Session->IvLow32 = Split.IvLow32;
 
-	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( InStream, OutStream, IvHigh32, IvLow32, P, S0, S1, S2, S3, StreamLength ) schedule ( static )
+			_BLOWFISH_ReleaseThreads ( Threads );
+
+			return;
+		}
+	}
 
 #endif
 
-	for ( i = 0; i < StreamLength; i += 2 )
-	{
-		/* Encipher the initialisation vector added with the counter */ 
+	Callback ( Session, InStream, OutStream, StreamLength );
 
-		XLeft = IvHigh32 + (BLOWFISH_ULONG)i;
-		XRight = IvLow32 + (BLOWFISH_ULONG)( i + 1 );
+#ifdef _OPENMP
 
-		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+	_BLOWFISH_ReleaseThreads ( (int)Session->Threads );
 
-		/* XOR the enciphered initialisation vector with the plaintext or ciphertext */ 
+#endif
 
-		OutStream [ i ] = InStream [ i ] ^ XRight;
-		OutStream [ i + 1 ] = InStream [ i + 1 ] ^ XLeft;
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_SetParallelThreshold ( BLOWFISH_SIZE_T BytesPerThread )
+{
+	/* Ensure the threshold is at least one block */ 
+
+	if ( BytesPerThread < 8 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_ParallelThreshold = BytesPerThread;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_SIZE_T BLOWFISH_GetParallelThreshold ( void )
+{
+	return _BLOWFISH_ParallelThreshold;
+}
+
+BLOWFISH_RC BLOWFISH_SetExecutor ( BLOWFISH_PCEXECUTOR Executor )
+{
+	/* Ensure the executor record (if any) has a parallel for callback */ 
+
+	if ( Executor != 0 && Executor->ParallelFor == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_ATOMIC_STORE_POINTER ( _BLOWFISH_Executor, Executor );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_PCEXECUTOR BLOWFISH_GetExecutor ( void )
+{
+	return _BLOWFISH_ATOMIC_LOAD_POINTER ( _BLOWFISH_Executor );
+}
+
+/**
+
+	@internal
+
+	Set the mode and original initialisation vector in a session record.
+
+	@param Session	Pointer to a session record to set the mode and initialisation vector.
+
+	@param Mode		Mode to use when enciphering/decipering blocks. For supported modes see #BLOWFISH_MODE.
+
+	@param IvHigh32	High 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+
+	@param IvLow32	Low 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS		The mode and original initialisation vector were set successfully.
+
+	@return #BLOWFISH_RC_INVALID_MODE	The mode supplied was invalid.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SetMode ( BLOWFISH_PSESSION Session, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+{
+	const _BLOWFISH_KERNEL_TABLE *	Table;
+	BLOWFISH_MODE					Callbacks = Mode;
+
+	/* Validate the block cipher mode */ 
+
+	if ( (int)Mode < BLOWFISH_MODE_ECB || (int)Mode > BLOWFISH_MODE_CBC_LANES )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+	/* Set pointers to the encipher/decipher stream callbacks provided by the current kernel (ciphertext stealing uses those of CBC for all but the last two blocks, and interleaved lanes those of ECB, chaining the blocks itself) */ 
+
+	if ( Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		Callbacks = BLOWFISH_MODE_CBC;
+	}
+	else if ( Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		Callbacks = BLOWFISH_MODE_ECB;
+	}
+
+	Table = _BLOWFISH_GetKernelTable ( );
+
+	Session->EncipherStream = Table->EncipherStream [ Callbacks ];
+	Session->DecipherStream = Table->DecipherStream [ Callbacks ];
+	Session->Mode = Mode;
+
+	/* Clear the thread limit, byte order, any partial block and any attached keystream record */ 
+
+	Session->MaxThreads = 0;
+	Session->Threads = 0;
+	Session->PendingLength = 0;
+	Session->SwapBytes = 0;
+	Session->Keystream = 0;
+
+	/* Save the initialisation vector */ 
+
+	Session->OriginalIvHigh32 = IvHigh32;
+	Session->OriginalIvLow32 = IvLow32;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	XOR a key, repeated as often as necessary, into the P-Array of a key schedule.
+
+	@param KeySchedule	Pointer to a key schedule.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the Key buffer.
+
+	@remarks It is an unchecked runtime error to supply a null pointer, or a zero key length to this function.
+
+  */ 
+
+static void _BLOWFISH_MixKey ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_SIZE_T	k;
+	BLOWFISH_ULONG	Data = 0;
+
+	for ( i = 0, j = 0; i < BLOWFISH_SUBKEYS; i++ )
+	{
+		for ( k = 0; k < 4; k++ )
+		{
+			Data = ( Data << 8 ) | Key [ j ];
+
+			/* Have we reached the end of the key? */ 
+
+			j++;
+
+			if ( j >= KeyLength )
+			{
+				/* Resume from the begining of the key */ 
+
+				j = 0;
+			}
+		}
+
+		KeySchedule->PArray [ i ] ^= Data;
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Copy the original P-Array and S-Boxes into a key schedule.
+
+	@param KeySchedule	Pointer to a key schedule to initialise.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+  */ 
+
+static void _BLOWFISH_CopyOriginal ( BLOWFISH_PKEY_SCHEDULE KeySchedule )
+{
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+
+	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	{
+		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j++ )
+		{
+			KeySchedule->SBox [ i ] [ j ] = _BLOWFISH_SBox [ i ] [ j ];
+		}
+	}
+
+	for ( i = 0; i < BLOWFISH_SUBKEYS; i++ )
+	{
+		KeySchedule->PArray [ i ] = _BLOWFISH_PArray [ i ];
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Copy the original S-Boxes into a key schedule, and XOR the original P-Array with the key into the key schedule (the first step of expanding a key).
+
+	@param KeySchedule	Pointer to a key schedule to initialise.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the Key buffer.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS		Successfully initialised the key schedule.
+
+	@return #BLOWFISH_RC_INVALID_KEY	The length of the key is invalid.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SeedKey ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	/* Ensure the key length is valid, ( between 4 and 56 bytes ) */ 
+
+	if ( KeyLength < BLOWFISH_MIN_KEY_LENGTH || KeyLength > BLOWFISH_MAX_KEY_LENGTH )
+	{
+		return BLOWFISH_RC_INVALID_KEY;
+	}
+
+	_BLOWFISH_CopyOriginal ( KeySchedule );
+
+	_BLOWFISH_MixKey ( KeySchedule, Key, KeyLength );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Initialise the P-Array and S-Boxes in a key schedule based on the key.
+
+	@param KeySchedule	Pointer to a key schedule to initialise.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the Key buffer.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS		Successfully initialised the key schedule.
+
+	@return #BLOWFISH_RC_INVALID_KEY	The length of the key is invalid.
+
+	@return #BLOWFISH_RC_WEAK_KEY		The key has been deemed to be weak.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SetKey ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	BLOWFISH_RC		ReturnCode;
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_ULONG	XLeft = 0;
+	BLOWFISH_ULONG	XRight = 0;
+
+	ReturnCode = _BLOWFISH_SeedKey ( KeySchedule, Key, KeyLength );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Update all entries in the key schedule P-Array with output from the continuously changing blowfish algorithm */ 
+
+	for ( i = 0; i < BLOWFISH_SUBKEYS; i += 2 )
+	{
+		 _BLOWFISH_EncipherBlock ( KeySchedule, &XLeft, &XRight );
+
+		 KeySchedule->PArray [ i ] = XLeft;
+		 KeySchedule->PArray [ i + 1 ] = XRight;
+	}
+
+	/* Update all entries in the key schedule S-Boxes with output from the continuously changing blowfish algorithm */ 
+
+	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	{
+		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j += 2 )
+		{
+			_BLOWFISH_EncipherBlock ( KeySchedule, &XLeft, &XRight );
+
+			/* Test the strength of the key */ 
+
+			if ( XLeft == XRight )
+			{
+				return BLOWFISH_RC_WEAK_KEY;
+			}
+
+			KeySchedule->SBox [ i ] [ j ] = XLeft;
+			KeySchedule->SBox [ i ] [ j + 1 ] = XRight;
+		}
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Overwrite a record with null bytes (do not use memset!).
+
+	@param Memory	Pointer to the record to overwrite.
+
+	@param Length	Length of the record in bytes.
+
+	@remarks The record is written through a volatile pointer, so that the compiler cannot remove the stores when the record is not read again (such as a local variable about to go out of scope).
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+  */ 
+
+static void _BLOWFISH_Wipe ( void * Memory, BLOWFISH_SIZE_T Length )
+{
+	volatile BLOWFISH_UCHAR *	MemoryToWipe = (volatile BLOWFISH_UCHAR *)Memory;
+	BLOWFISH_SIZE_T				i;
+
+	for ( i = 0; i < Length; i++ )
+	{
+		MemoryToWipe [ i ] = 0x00;
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Point the session record in a context record at the key schedule in the same context record.
+
+	@param Context	Pointer to a context record.
+
+	@remarks Rebinding on every use keeps context records that have been copied by assignment (rather than #BLOWFISH_CloneContext) independent.
+
+*/ 
+
+#define _BLOWFISH_BIND( Context )									\
+{																	\
+	( Context )->Session.KeySchedule = &( Context )->KeySchedule;	\
+}
+
+BLOWFISH_RC BLOWFISH_InitKeySchedule ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	/* Ensure pointers are valid */ 
+
+	if ( KeySchedule == 0 || Key == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Initialise the P-Array and S-Boxes based on the key */ 
+
+	return _BLOWFISH_SetKey ( KeySchedule, Key, KeyLength );
+}
+
+BLOWFISH_RC BLOWFISH_ExitKeySchedule ( BLOWFISH_PKEY_SCHEDULE KeySchedule )
+{
+	/* Ensure the key schedule pointer is valid */ 
+
+	if ( KeySchedule == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_Wipe ( KeySchedule, (BLOWFISH_SIZE_T)sizeof ( *KeySchedule ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_InitSession ( BLOWFISH_PSESSION Session, BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+{
+	BLOWFISH_RC	ReturnCode;
+
+	/* Ensure pointers are valid */ 
+
+	if ( Session == 0 || KeySchedule == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Set the mode and initialisation vector */ 
+
+	ReturnCode = _BLOWFISH_SetMode ( Session, Mode, IvHigh32, IvLow32 );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		/* Reference the shared key schedule */ 
+
+		Session->KeySchedule = KeySchedule;
+	}
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_ExitSession ( BLOWFISH_PSESSION Session )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_Wipe ( Session, (BLOWFISH_SIZE_T)sizeof ( *Session ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_Init ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+{
+	BLOWFISH_RC	ReturnCode;
+
+	/* Ensure pointers are valid */ 
+
+	if ( Context == 0 || Key == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	/* Set the mode and initialisation vector */ 
+
+	ReturnCode = _BLOWFISH_SetMode ( &Context->Session, Mode, IvHigh32, IvLow32 );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		/* Initialise the P-Array and S-Boxes based on the key */ 
+
+		ReturnCode = _BLOWFISH_SetKey ( &Context->KeySchedule, Key, KeyLength );
+	}
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_Reset ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+{
+	BLOWFISH_RC	ReturnCode = BLOWFISH_RC_SUCCESS;
+
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	/* The ring of an attached keystream record was generated with the current key and initialisation vector, so detach it (wiping the ring) before either changes */ 
+
+	if ( ( Mode != BLOWFISH_MODE_CURRENT || Key != 0 ) && Context->Session.Keystream != 0 )
+	{
+		_BLOWFISH_DetachKeystream ( &Context->Session );
+	}
+
+	/* Has a new mode been specified */ 
+
+	if ( Mode != BLOWFISH_MODE_CURRENT )
+	{
+		/* Reinitialise the mode and initialisation vector */ 
+
+		ReturnCode = _BLOWFISH_SetMode ( &Context->Session, Mode, IvHigh32, IvLow32 );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	/* Has a new key been specified? */ 
+
+	if ( Key != 0 )
+	{
+		/* Reinitialise the P-Array and S-Boxes based on the new key */ 
+
+		ReturnCode = _BLOWFISH_SetKey ( &Context->KeySchedule, Key, KeyLength );
+	}
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_CloneContext ( BLOWFISH_PCONTEXT InContext, BLOWFISH_PCONTEXT OutContext )
+{
+	if ( InContext == 0 || OutContext == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Copy the context record, and bind the copied session to the copied key schedule */ 
+
+	*OutContext = *InContext;
+
+	_BLOWFISH_BIND ( OutContext );
+
+	/* A keystream record has a single consumer, so stays attached to the original only */ 
+
+	if ( OutContext->Session.Keystream != 0 )
+	{
+		_BLOWFISH_SetKeystream ( &OutContext->Session, 0 );
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_Exit ( BLOWFISH_PCONTEXT Context )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Overwrite the context record with null bytes */ 
+
+	_BLOWFISH_Wipe ( Context, (BLOWFISH_SIZE_T)sizeof ( *Context ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Restore the original initialisation vector in a session record, and discard any partial block.
+
+	@param Session	Pointer to an initialised session record.
+
+*/ 
+
+#define _BLOWFISH_BEGINSTREAM( Session )						\
+{																\
+	( Session )->IvHigh32 = ( Session )->OriginalIvHigh32;	\
+	( Session )->IvLow32 = ( Session )->OriginalIvLow32;		\
+	( Session )->PendingLength = 0;							\
+}
+
+BLOWFISH_RC BLOWFISH_BeginSessionStream ( BLOWFISH_PSESSION Session )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_BeginStream ( BLOWFISH_PCONTEXT Context )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BEGINSTREAM ( &Context->Session );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Overwrite the final initialisation vector and partial block in a session record.
+
+	@param Session	Pointer to an initialised session record.
+
+*/ 
+
+#define _BLOWFISH_ENDSTREAM( Session )		\
+{											\
+	( Session )->IvHigh32 = 0;				\
+	( Session )->IvLow32 = 0;				\
+	( Session )->PendingBlock [ 0 ] = 0;	\
+	( Session )->PendingBlock [ 1 ] = 0;	\
+	( Session )->PendingLength = 0;			\
+}
+
+/**
+
+	@internal
+
+	End a stream, overwriting the final initialisation vector and partial block in a session record.
+
+	@param Session	Pointer to an initialised session record.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS			The stream was ended successfully.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	Bytes buffered by a #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC stream were discarded.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_EndStream ( BLOWFISH_PSESSION Session )
+{
+	BLOWFISH_RC	ReturnCode = BLOWFISH_RC_SUCCESS;
+
+	/* Block modes cannot output a partial block, so report the truncated stream */ 
+
+	if ( Session->PendingLength != 0 && ( Session->Mode == BLOWFISH_MODE_ECB || Session->Mode == BLOWFISH_MODE_CBC ) )
+	{
+		ReturnCode = BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_EndSessionStream ( BLOWFISH_PSESSION Session )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_EndStream ( Session );
+}
+
+BLOWFISH_RC BLOWFISH_EndStream ( BLOWFISH_PCONTEXT Context )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_EndStream ( &Context->Session );
+}
+
+/**
+
+	@internal
+
+	Position the stream of a session record at a byte offset from its start.
+
+	@param Session		Pointer to an initialised session record.
+
+	@param ByteOffset	Offset from the start of the stream.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS			The stream was positioned successfully.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The offset of a #BLOWFISH_MODE_ECB stream is not a multiple of 8.
+
+	@return #BLOWFISH_RC_INVALID_MODE		Streams in the mode of the session record cannot be positioned.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SeekStream ( BLOWFISH_PSESSION Session, BLOWFISH_ULONGLONG ByteOffset )
+{
+	static const BLOWFISH_ULONG	Zero [ 2 ] = { 0, 0 };
+
+	BLOWFISH_ULONGLONG	Counter;
+
+	switch ( Session->Mode )
+	{
+		case BLOWFISH_MODE_ECB:
+		{
+			/* Blocks are independent, so there is no state to position other than the partial block (which cannot be rebuilt without the bytes before the offset) */ 
+
+			if ( ( ByteOffset & 0x07 ) != 0 )
+			{
+				return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+			}
+
+			Session->PendingLength = 0;
+
+			return BLOWFISH_RC_SUCCESS;
+		}
+		case BLOWFISH_MODE_CTR64:
+		{
+			/* Add the index of the block containing the offset to the original counter */ 
+
+			Counter = ( (BLOWFISH_ULONGLONG)Session->OriginalIvHigh32 << 32 | Session->OriginalIvLow32 ) + ( ByteOffset >> 3 );
+
+			Session->IvHigh32 = (BLOWFISH_ULONG)( Counter >> 32 );
+			Session->IvLow32 = (BLOWFISH_ULONG)Counter;
+			Session->PendingLength = 0;
+
+			/* Within a block, generate its keystream (advancing the counter past it) and mark the bytes before the offset as used */ 
+
+			if ( ( ByteOffset & 0x07 ) != 0 )
+			{
+				_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, Zero, Session->PendingBlock, 2 );
+
+				Session->PendingLength = (BLOWFISH_ULONG)( ByteOffset & 0x07 );
+			}
+
+			return BLOWFISH_RC_SUCCESS;
+		}
+		default:
+		{
+			/* Chained modes depend on the preceding ciphertext, and the counters of #BLOWFISH_MODE_CTR depend on how the stream was divided */ 
+
+			return BLOWFISH_RC_INVALID_MODE;
+		}
+	}
+}
+
+BLOWFISH_RC BLOWFISH_SeekSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_ULONGLONG ByteOffset )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_SeekStream ( Session, ByteOffset );
+}
+
+BLOWFISH_RC BLOWFISH_SeekStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_ULONGLONG ByteOffset )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_SeekStream ( &Context->Session, ByteOffset );
+}
+
+BLOWFISH_RC BLOWFISH_SetSessionThreads ( BLOWFISH_PSESSION Session, BLOWFISH_ULONG MaxThreads )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	Session->MaxThreads = MaxThreads;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_SetThreads ( BLOWFISH_PCONTEXT Context, BLOWFISH_ULONG MaxThreads )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	Context->Session.MaxThreads = MaxThreads;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Set the byte order of the data enciphered/deciphered with a session record.
+
+	@param Session		Pointer to an initialised session record.
+
+	@param ByteOrder	Byte order of stream and buffer data.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS			The byte order was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The byte order is invalid.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SetByteOrder ( BLOWFISH_PSESSION Session, BLOWFISH_BYTE_ORDER ByteOrder )
+{
+	BLOWFISH_ULONG	Word = 1;
+
+	switch ( ByteOrder )
+	{
+		case BLOWFISH_BYTE_ORDER_HOST:
+		{
+			Session->SwapBytes = 0;
+
+			return BLOWFISH_RC_SUCCESS;
+		}
+		case BLOWFISH_BYTE_ORDER_BIG_ENDIAN:
+		{
+			/* Only little-endian hosts need to swap */ 
+
+			Session->SwapBytes = *(BLOWFISH_PUCHAR)&Word == 1;
+
+			return BLOWFISH_RC_SUCCESS;
+		}
+		default:
+		{
+			return BLOWFISH_RC_INVALID_PARAMETER;
+		}
+	}
+}
+
+BLOWFISH_RC BLOWFISH_SetSessionByteOrder ( BLOWFISH_PSESSION Session, BLOWFISH_BYTE_ORDER ByteOrder )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_SetByteOrder ( Session, ByteOrder );
+}
+
+BLOWFISH_RC BLOWFISH_SetByteOrder ( BLOWFISH_PCONTEXT Context, BLOWFISH_BYTE_ORDER ByteOrder )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_SetByteOrder ( &Context->Session, ByteOrder );
+}
+
+BLOWFISH_ULONG BLOWFISH_GetSessionThreadsUsed ( BLOWFISH_PSESSION Session )
+{
+	return Session != 0 ? Session->Threads : 0;
+}
+
+BLOWFISH_ULONG BLOWFISH_GetThreadsUsed ( BLOWFISH_PCONTEXT Context )
+{
+	return Context != 0 ? Context->Session.Threads : 0;
+}
+
+BLOWFISH_ULONG BLOWFISH_GetSessionStreamPending ( BLOWFISH_PSESSION Session )
+{
+	return Session != 0 ? Session->PendingLength : 0;
+}
+
+BLOWFISH_ULONG BLOWFISH_GetStreamPending ( BLOWFISH_PCONTEXT Context )
+{
+	return Context != 0 ? Context->Session.PendingLength : 0;
+}
+
+/**
+
+	@internal
+
+	Acquire the spin lock protecting a key cache.
+
+	@param Cache	Pointer to an initialised key cache record.
+
+	@remarks Only short, non-blocking work is performed while the lock is held (keys are never expanded under the lock).
+
+*/ 
+
+#define _BLOWFISH_LOCK_CACHE( Cache )																									\
+{																																		\
+	while ( _BLOWFISH_ATOMIC_LOAD_POINTER ( ( Cache )->Lock ) != 0 || !_BLOWFISH_ATOMIC_CAS_POINTER ( ( Cache )->Lock, (void *)0, (void *)( Cache ) ) )	\
+	{																																	\
+		_BLOWFISH_SPIN_PAUSE ( );																										\
+	}																																	\
+}
+
+/**
+
+	@internal
+
+	Release the spin lock protecting a key cache.
+
+	@param Cache	Pointer to an initialised key cache record.
+
+*/ 
+
+#define _BLOWFISH_UNLOCK_CACHE( Cache )	_BLOWFISH_ATOMIC_STORE_POINTER ( ( Cache )->Lock, (void *)0 )
+
+/**
+
+	@internal
+
+	Convert a 1-based entry index (as stored in the key cache links) to a pointer to the entry.
+
+	@param Cache	Pointer to an initialised key cache record.
+
+	@param Index	Index + 1 of the entry.
+
+*/ 
+
+#define _BLOWFISH_CACHE_ENTRY( Cache, Index )	( &( Cache )->Entries [ ( Index ) - 1 ] )
+
+/**
+
+	@internal
+
+	Hash a key (32-bit FNV-1a).
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key.
+
+	@return Hash of the key.
+
+  */ 
+
+static BLOWFISH_ULONG _BLOWFISH_HashKey ( BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	BLOWFISH_ULONG	Hash = 0x811c9dc5;
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < KeyLength; i++ )
+	{
+		Hash = ( Hash ^ Key [ i ] ) * 0x01000193;
+	}
+
+	return Hash;
+}
+
+/**
+
+	@internal
+
+	Find the entry holding the key schedule for a key.
+
+	@param Cache		Pointer to a locked key cache record.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key.
+
+	@param Hash			Hash of the key.
+
+	@remarks Keys are compared without an early exit, so that the time taken does not depend on where they differ.
+
+	@return Index + 1 of the entry, or 0 if the key is not in the cache.
+
+  */ 
+
+static BLOWFISH_SIZE_T _BLOWFISH_FindKey ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_ULONG Hash )
+{
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry;
+	BLOWFISH_SIZE_T				Index = Cache->Entries [ Hash % Cache->EntryCount ].Bucket;
+	BLOWFISH_SIZE_T				i;
+	BLOWFISH_UCHAR				Difference;
+
+	for ( ; Index != 0; Index = Entry->NextInBucket )
+	{
+		Entry = _BLOWFISH_CACHE_ENTRY ( Cache, Index );
+
+		if ( Entry->Hash == Hash && Entry->KeyLength == KeyLength )
+		{
+			for ( i = 0, Difference = 0; i < KeyLength; i++ )
+			{
+				Difference |= Entry->Key [ i ] ^ Key [ i ];
+			}
+
+			if ( Difference == 0 )
+			{
+				break;
+			}
+		}
+	}
+
+	return Index;
+}
+
+/**
+
+	@internal
+
+	Move an entry to the most recently used end of the key cache.
+
+	@param Cache	Pointer to a locked key cache record.
+
+	@param Index	Index + 1 of the entry.
+
+  */ 
+
+static void _BLOWFISH_TouchKey ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_SIZE_T Index )
+{
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry = _BLOWFISH_CACHE_ENTRY ( Cache, Index );
+
+	if ( Cache->Newest == Index )
+	{
+		return;
+	}
+
+	/* Unlink the entry (it cannot be the newest, so always has a newer entry) */ 
+
+	_BLOWFISH_CACHE_ENTRY ( Cache, Entry->Newer )->Older = Entry->Older;
+
+	if ( Entry->Older != 0 )
+	{
+		_BLOWFISH_CACHE_ENTRY ( Cache, Entry->Older )->Newer = Entry->Newer;
+	}
+	else
+	{
+		Cache->Oldest = Entry->Newer;
+	}
+
+	/* Relink the entry as the newest */ 
+
+	Entry->Older = Cache->Newest;
+	Entry->Newer = 0;
+
+	_BLOWFISH_CACHE_ENTRY ( Cache, Cache->Newest )->Newer = Index;
+
+	Cache->Newest = Index;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Reserve the least recently used entry in the key cache that is not pinned, to receive a new key schedule.
+
+	@param Cache	Pointer to a locked key cache record.
+
+	@remarks The entry is unlinked from its hash bucket and pinned, so that the evicted key schedule and key can be wiped and overwritten without holding the lock. It must then be either inserted with #_BLOWFISH_InsertKey, or wiped and unpinned.
+
+	@return Index + 1 of the entry, or 0 if every entry is pinned.
+
+  */ 
+
+static BLOWFISH_SIZE_T _BLOWFISH_ReserveKey ( BLOWFISH_PKEY_CACHE Cache )
+{
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry = 0;
+	BLOWFISH_SIZE_T *			Link;
+	BLOWFISH_SIZE_T				Index;
+
+	/* Find the least recently used entry that is not pinned (unused entries are always the oldest) */ 
+
+	for ( Index = Cache->Oldest; Index != 0; Index = Entry->Newer )
+	{
+		Entry = _BLOWFISH_CACHE_ENTRY ( Cache, Index );
+
+		if ( Entry->References == 0 )
+		{
+			break;
+		}
+	}
+
+	if ( Index == 0 )
+	{
+		return 0;
+	}
+
+	if ( Entry->KeyLength != 0 )
+	{
+		/* Unlink the evicted entry from its hash bucket */ 
+
+		for ( Link = &Cache->Entries [ Entry->Hash % Cache->EntryCount ].Bucket; *Link != Index; Link = &_BLOWFISH_CACHE_ENTRY ( Cache, *Link )->NextInBucket )
+		{
+		}
+
+		*Link = Entry->NextInBucket;
+
+		Entry->KeyLength = 0;
+
+		Cache->Statistics.Evictions++;
+		Cache->Statistics.EntriesUsed--;
+	}
+
+	Entry->References = 1;
+
+	return Index;
+}
+
+/**
+
+	@internal
+
+	Insert a reserved entry, whose key schedule and key have been overwritten, into the key cache.
+
+	@param Cache		Pointer to a locked key cache record.
+
+	@param Index		Index + 1 of the entry returned by #_BLOWFISH_ReserveKey.
+
+	@param KeyLength	Length of the key.
+
+	@param Hash			Hash of the key.
+
+	@remarks The entry remains pinned by the caller.
+
+  */ 
+
+static void _BLOWFISH_InsertKey ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_SIZE_T Index, BLOWFISH_SIZE_T KeyLength, BLOWFISH_ULONG Hash )
+{
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry = _BLOWFISH_CACHE_ENTRY ( Cache, Index );
+
+	Entry->KeyLength = KeyLength;
+	Entry->Hash = Hash;
+
+	/* Link the entry into its new hash bucket */ 
+
+	Entry->NextInBucket = Cache->Entries [ Hash % Cache->EntryCount ].Bucket;
+	Cache->Entries [ Hash % Cache->EntryCount ].Bucket = Index;
+
+	Cache->Statistics.EntriesUsed++;
+
+	_BLOWFISH_TouchKey ( Cache, Index );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Look up (or expand and insert) the key schedule for a key, and pin it in the key cache.
+
+	@param Cache		Pointer to an initialised key cache record.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key.
+
+	@param Scratch		Pointer to a key schedule used to expand the key on a miss.
+
+	@param KeySchedule	Pointer to receive the pinned key schedule.
+
+	@remarks Scratch is only written on a miss, and is overwritten with null bytes before returning, unless #BLOWFISH_RC_CACHE_FULL is returned, in which case it holds the key schedule expanded from the key.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return See #BLOWFISH_AcquireKeySchedule.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_AcquireKeySchedule ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_PKEY_SCHEDULE Scratch, BLOWFISH_PCKEY_SCHEDULE * KeySchedule )
+{
+	BLOWFISH_RC					ReturnCode;
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry;
+	BLOWFISH_ULONG				Hash;
+	BLOWFISH_SIZE_T				Index;
+	BLOWFISH_SIZE_T				Reserved = 0;
+	BLOWFISH_SIZE_T				i;
+
+	/* Ensure the key length is valid before hashing the key */ 
+
+	if ( KeyLength < BLOWFISH_MIN_KEY_LENGTH || KeyLength > BLOWFISH_MAX_KEY_LENGTH )
+	{
+		return BLOWFISH_RC_INVALID_KEY;
+	}
+
+	Hash = _BLOWFISH_HashKey ( Key, KeyLength );
+
+	_BLOWFISH_LOCK_CACHE ( Cache );
+
+	Index = _BLOWFISH_FindKey ( Cache, Key, KeyLength, Hash );
+
+	if ( Index != 0 )
+	{
+		_BLOWFISH_CACHE_ENTRY ( Cache, Index )->References++;
+
+		_BLOWFISH_TouchKey ( Cache, Index );
+
+		Cache->Statistics.Hits++;
+	}
+
+	_BLOWFISH_UNLOCK_CACHE ( Cache );
+
+	if ( Index == 0 )
+	{
+		/* Expand the key without holding the lock */ 
+
+		ReturnCode = _BLOWFISH_SetKey ( Scratch, Key, KeyLength );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			_BLOWFISH_Wipe ( Scratch, (BLOWFISH_SIZE_T)sizeof ( *Scratch ) );
+
+			return ReturnCode;
+		}
+
+		_BLOWFISH_LOCK_CACHE ( Cache );
+
+		Cache->Statistics.Misses++;
+
+		/* Another thread may have inserted the same key in the meantime, otherwise reserve an entry for it */ 
+
+		Index = _BLOWFISH_FindKey ( Cache, Key, KeyLength, Hash );
+
+		if ( Index != 0 )
+		{
+			_BLOWFISH_CACHE_ENTRY ( Cache, Index )->References++;
+
+			_BLOWFISH_TouchKey ( Cache, Index );
+		}
+		else
+		{
+			Reserved = _BLOWFISH_ReserveKey ( Cache );
+		}
+
+		_BLOWFISH_UNLOCK_CACHE ( Cache );
+
+		if ( Reserved != 0 )
+		{
+			/* Wipe the evicted key schedule and key, and copy the new ones into the reserved entry, without holding the lock */ 
+
+			Entry = _BLOWFISH_CACHE_ENTRY ( Cache, Reserved );
+
+			_BLOWFISH_Wipe ( &Entry->KeySchedule, (BLOWFISH_SIZE_T)sizeof ( Entry->KeySchedule ) );
+			_BLOWFISH_Wipe ( Entry->Key, (BLOWFISH_SIZE_T)sizeof ( Entry->Key ) );
+
+			Entry->KeySchedule = *Scratch;
+
+			for ( i = 0; i < BLOWFISH_MAX_KEY_LENGTH; i++ )
+			{
+				Entry->Key [ i ] = i < KeyLength ? Key [ i ] : 0x00;
+			}
+
+			_BLOWFISH_LOCK_CACHE ( Cache );
+
+			/* Use the same key if another thread inserted it while the lock was released, otherwise insert the reserved entry */ 
+
+			Index = _BLOWFISH_FindKey ( Cache, Key, KeyLength, Hash );
+
+			if ( Index != 0 )
+			{
+				_BLOWFISH_CACHE_ENTRY ( Cache, Index )->References++;
+
+				_BLOWFISH_TouchKey ( Cache, Index );
+			}
+			else
+			{
+				_BLOWFISH_InsertKey ( Cache, Reserved, KeyLength, Hash );
+
+				Index = Reserved;
+				Reserved = 0;
+			}
+
+			_BLOWFISH_UNLOCK_CACHE ( Cache );
+
+			/* Wipe the duplicate key schedule and key of an abandoned reservation before unpinning it (the entry remains unused) */ 
+
+			if ( Reserved != 0 )
+			{
+				_BLOWFISH_Wipe ( &Entry->KeySchedule, (BLOWFISH_SIZE_T)sizeof ( Entry->KeySchedule ) );
+				_BLOWFISH_Wipe ( Entry->Key, (BLOWFISH_SIZE_T)sizeof ( Entry->Key ) );
+
+				_BLOWFISH_LOCK_CACHE ( Cache );
+
+				Entry->References = 0;
+
+				_BLOWFISH_UNLOCK_CACHE ( Cache );
+			}
+		}
+
+		if ( Index == 0 )
+		{
+			return BLOWFISH_RC_CACHE_FULL;
+		}
+
+		/* The key schedule is cached, so overwrite the scratch copy */ 
+
+		_BLOWFISH_Wipe ( Scratch, (BLOWFISH_SIZE_T)sizeof ( *Scratch ) );
+	}
+
+	*KeySchedule = &_BLOWFISH_CACHE_ENTRY ( Cache, Index )->KeySchedule;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_InitKeyCache ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PKEY_CACHE_ENTRY Entries, BLOWFISH_SIZE_T EntryCount )
+{
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure pointers and the entry count are valid */ 
+
+	if ( Cache == 0 || Entries == 0 || EntryCount <= 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_Wipe ( Cache, (BLOWFISH_SIZE_T)sizeof ( *Cache ) );
+	_BLOWFISH_Wipe ( Entries, EntryCount * (BLOWFISH_SIZE_T)sizeof ( *Entries ) );
+
+	Cache->Entries = Entries;
+	Cache->EntryCount = EntryCount;
+	Cache->Statistics.EntryCount = EntryCount;
+
+	/* Link every (unused) entry into the least recently used list */ 
+
+	for ( i = 0; i < EntryCount; i++ )
+	{
+		Entries [ i ].Newer = i + 1 < EntryCount ? i + 2 : 0;
+		Entries [ i ].Older = i;
+	}
+
+	Cache->Oldest = 1;
+	Cache->Newest = EntryCount;
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_ExitKeyCache ( BLOWFISH_PKEY_CACHE Cache )
+{
+	/* Ensure the key cache pointer is valid */ 
+
+	if ( Cache == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Overwrite every key schedule and key, and then the key cache record */ 
+
+	if ( Cache->Entries != 0 )
+	{
+		_BLOWFISH_Wipe ( Cache->Entries, Cache->EntryCount * (BLOWFISH_SIZE_T)sizeof ( *Cache->Entries ) );
+	}
+
+	_BLOWFISH_Wipe ( Cache, (BLOWFISH_SIZE_T)sizeof ( *Cache ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_AcquireKeySchedule ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_PCKEY_SCHEDULE * KeySchedule )
+{
+	BLOWFISH_RC				ReturnCode;
+	BLOWFISH_KEY_SCHEDULE	Scratch;
+
+	/* Ensure pointers are valid */ 
+
+	if ( Cache == 0 || Key == 0 || KeySchedule == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	ReturnCode = _BLOWFISH_AcquireKeySchedule ( Cache, Key, KeyLength, &Scratch, KeySchedule );
+
+	/* Overwrite the scratch key schedule if it could not be cached (otherwise it is either unused, or has already been overwritten) */ 
+
+	if ( ReturnCode == BLOWFISH_RC_CACHE_FULL )
+	{
+		_BLOWFISH_Wipe ( &Scratch, (BLOWFISH_SIZE_T)sizeof ( Scratch ) );
+	}
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_ReleaseKeySchedule ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCKEY_SCHEDULE KeySchedule )
+{
+	BLOWFISH_RC					ReturnCode = BLOWFISH_RC_INVALID_PARAMETER;
+	BLOWFISH_PKEY_CACHE_ENTRY	Entry;
+	BLOWFISH_SIZE_T				Offset;
+
+	/* Ensure pointers are valid */ 
+
+	if ( Cache == 0 || KeySchedule == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ensure the key schedule is one of the cache entries (the key schedule is the first member of an entry) */ 
+
+	Offset = (BLOWFISH_SIZE_T)( (BLOWFISH_PCUCHAR)KeySchedule - (BLOWFISH_PCUCHAR)Cache->Entries );
+
+	if ( (BLOWFISH_PCUCHAR)KeySchedule < (BLOWFISH_PCUCHAR)Cache->Entries || Offset % (BLOWFISH_SIZE_T)sizeof ( *Entry ) != 0 || Offset / (BLOWFISH_SIZE_T)sizeof ( *Entry ) >= Cache->EntryCount )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	Entry = &Cache->Entries [ Offset / (BLOWFISH_SIZE_T)sizeof ( *Entry ) ];
+
+	_BLOWFISH_LOCK_CACHE ( Cache );
+
+	if ( Entry->References > 0 )
+	{
+		Entry->References--;
+
+		ReturnCode = BLOWFISH_RC_SUCCESS;
+	}
+
+	_BLOWFISH_UNLOCK_CACHE ( Cache );
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_InitFromKeyCache ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 )
+{
+	BLOWFISH_RC				ReturnCode;
+	BLOWFISH_PCKEY_SCHEDULE	KeySchedule;
+
+	/* Ensure pointers are valid */ 
+
+	if ( Cache == 0 || Context == 0 || Key == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	/* Set the mode and initialisation vector */ 
+
+	ReturnCode = _BLOWFISH_SetMode ( &Context->Session, Mode, IvHigh32, IvLow32 );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		/* Copy the cached key schedule (a miss expands the key directly into the context record) */ 
+
+		ReturnCode = _BLOWFISH_AcquireKeySchedule ( Cache, Key, KeyLength, &Context->KeySchedule, &KeySchedule );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			Context->KeySchedule = *KeySchedule;
+
+			ReturnCode = BLOWFISH_ReleaseKeySchedule ( Cache, KeySchedule );
+		}
+		else if ( ReturnCode == BLOWFISH_RC_CACHE_FULL )
+		{
+			/* The key schedule was expanded into the context record, but could not be cached */ 
+
+			ReturnCode = BLOWFISH_RC_SUCCESS;
+		}
+	}
+
+	return ReturnCode;
+}
+
+BLOWFISH_RC BLOWFISH_GetKeyCacheStatistics ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PKEY_CACHE_STATISTICS Statistics )
+{
+	/* Ensure pointers are valid */ 
+
+	if ( Cache == 0 || Statistics == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_LOCK_CACHE ( Cache );
+
+	*Statistics = Cache->Statistics;
+
+	_BLOWFISH_UNLOCK_CACHE ( Cache );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher.
+
+	xL = xL XOR Pn
+
+	xR = F(xL) XOR xR
+
+	Divide xL into four eight-bit quarters: a, b, c, and d.
+
+	Then, F(xL) = ((S0,a + S1,b mod 232) XOR S2,c) + S3,d mod 232. 
+
+	See @link glossary @endlink for more information.
+
+	@remarks After each round the caller must swap xL and xR.
+
+	@param XLeft			High 32-bits of the message to encipher.
+
+	@param XRight			Low 32-bits of the message to encipher.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+	@param Round			Current round to perform (0-15 to encipher, 17-2 to decipher).
+
+  */ 
+
+#define _BLOWFISH_CIPHER( XLeft, XRight, P, S0, S1, S2, S3, Round )	\
+{																	\
+	XLeft ^= P [ Round ];											\
+	XRight ^= ( ( ( S0 [ XLeft >> 24 ] +							\
+		S1 [ ( XLeft >> 16 ) & 0xff ] ) ^							\
+		S2 [ ( XLeft >> 8 ) & 0xff ] ) +							\
+		S3 [ XLeft & 0xff ] );										\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round encipher, finalise round and unswap xL and xR:
+
+	xR = xR XOR P18
+
+	xL = xL XOR P17
+
+	See @link glossary @endlink for more information.
+
+	@param BufferHigh		Pointer to the high 32-bits of the output buffer.
+
+	@param BufferLow		Pointer to the low 32-bits of the output buffer.
+
+	@param XLeft			High 32-bits of the message to encipher.
+
+	@param XRight			Low 32-bits of the message to encipher.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+
+  */ 
+
+#define _BLOWFISH_ENCIPHER( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3 )	\
+{																						\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 0 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 1 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 2 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 3 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 4 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 5 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 6 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 7 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 8 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 9 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 10 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 11 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 12 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 13 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 14 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 15 );							\
+	BufferLow = XLeft ^ P [ 16 ];														\
+	BufferHigh = XRight ^ P [ 17 ];														\
+}
+
+void BLOWFISH_Encipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
+{
+	BLOWFISH_ULONG		XLeft = *High32;
+	BLOWFISH_ULONG		XRight = *Low32;
+	BLOWFISH_PCULONG	P = Context->KeySchedule.PArray;
+	BLOWFISH_PCULONG	S0 = Context->KeySchedule.SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Context->KeySchedule.SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Context->KeySchedule.SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Context->KeySchedule.SBox [ 3 ];
+
+	/* Encipher 8-byte plaintext block */ 
+
+	_BLOWFISH_ENCIPHER ( *High32, *Low32, XLeft, XRight, P, S0, S1, S2, S3 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher a single 8-byte block with a key schedule.
+
+	@param KeySchedule	Pointer to a key schedule.
+
+	@param High32		Pointer to the high 32-bits of the block, which receives the high 32-bits of the enciphered block.
+
+	@param Low32		Pointer to the low 32-bits of the block, which receives the low 32-bits of the enciphered block.
+
+	@remarks Used while expanding the key, when the key schedule is still being written. See #BLOWFISH_Encipher.
+
+  */ 
+
+static void _BLOWFISH_EncipherBlock ( BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
+{
+	BLOWFISH_ULONG		XLeft = *High32;
+	BLOWFISH_ULONG		XRight = *Low32;
+	BLOWFISH_PCULONG	P = KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = KeySchedule->SBox [ 3 ];
+
+	_BLOWFISH_ENCIPHER ( *High32, *Low32, XLeft, XRight, P, S0, S1, S2, S3 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher a stream of data in electronic codebook mode.
+
+	Cn = Ek ( Pn )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param PlainTextStream	Buffer of plaintext to encipher.
+
+	@param CipherTextStream	Buffer to receive the ciphertext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks This function can be parallelised using OpenMP.
+
+  */ 
+
+static void _BLOWFISH_EncipherStream_ECB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher plaintext in 8-byte blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		XLeft = _BLOWFISH_Load ( PlainTextStream + i, Swap );
+		XRight = _BLOWFISH_Load ( PlainTextStream + i + 1, Swap );
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( CipherTextStream + i, XRight, Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 1, XLeft, Swap );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher a stream of data in cipher block chaining mode.
+
+	Round 1:
+
+	C0 = Ek ( P0 XOR Iv )
+
+	Round n:
+
+	Cn = Ek ( Pn XOR ( Cn - 1 ) )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param PlainTextStream	Buffer of plaintext to encipher.
+
+	@param CipherTextStream	Buffer to receive the ciphertext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+  */ 
+
+static void _BLOWFISH_EncipherStream_CBC ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* XOR the first block of plaintext with the initialisation vector */ 
+
+	XLeft = _BLOWFISH_Load ( PlainTextStream, Swap ) ^ Session->IvHigh32;
+	XRight = _BLOWFISH_Load ( PlainTextStream + 1, Swap ) ^ Session->IvLow32;
+
+	/* Encipher the first block of plaintext */ 
+
+	_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+	_BLOWFISH_Store ( CipherTextStream, XRight, Swap );
+	_BLOWFISH_Store ( CipherTextStream + 1, XLeft, Swap );
+
+	/* Encrypt any remaining blocks */ 
+
+	for ( i = 2; i < StreamLength; i += 2 )
+	{
+		/* XOR the block of plaintext with the previous block of ciphertext */ 
+
+		XLeft = _BLOWFISH_Load ( PlainTextStream + i, Swap ) ^ _BLOWFISH_Load ( CipherTextStream + i - 2, Swap );
+		XRight = _BLOWFISH_Load ( PlainTextStream + i + 1, Swap ) ^ _BLOWFISH_Load ( CipherTextStream + i - 1, Swap );
+
+		/* Encipher the block of plaintext  */ 
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( CipherTextStream + i, XRight, Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 1, XLeft, Swap );
+	}
+
+	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 = XRight;
+	Session->IvLow32 = XLeft;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher a stream of data in cipher feedback mode.
+
+	Round 1:
+
+	C0 = P0 XOR Ek ( Iv )
+
+	Round n:
+
+	Cn = Pn XOR Ek ( ( Cn - 1 ) )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param PlainTextStream	Buffer of plaintext to encipher.
+
+	@param CipherTextStream	Buffer to receive the ciphertext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+  */ 
+
+static void _BLOWFISH_EncipherStream_CFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft = Session->IvHigh32;
+	BLOWFISH_ULONG		XRight = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher the initialisation vector */ 
+
+	_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+	/* XOR the enciphered initialisation vector with the plaintext to yeild the ciphertext */ 
+
+	XRight ^= _BLOWFISH_Load ( PlainTextStream, Swap );
+	XLeft ^= _BLOWFISH_Load ( PlainTextStream + 1, Swap );
+
+	_BLOWFISH_Store ( CipherTextStream, XRight, Swap );
+	_BLOWFISH_Store ( CipherTextStream + 1, XLeft, Swap );
+
+	for ( i = 2; i < StreamLength; i += 2 )
+	{
+		/* Encipher the previous block of ciphertext */ 
+
+		XLeft = _BLOWFISH_Load ( CipherTextStream + i - 2, Swap );
+		XRight = _BLOWFISH_Load ( CipherTextStream + i - 1, Swap );
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered previous block of ciphertext with the plaintext to yeild the current block of ciphertext */ 
+
+		XRight ^= _BLOWFISH_Load ( PlainTextStream + i, Swap );
+		XLeft ^= _BLOWFISH_Load ( PlainTextStream + i + 1, Swap );
+
+		_BLOWFISH_Store ( CipherTextStream + i, XRight, Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 1, XLeft, Swap );
+	}
+
+	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 = XRight;
+	Session->IvLow32 = XLeft;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in output feedback mode.
+
+	Iv = Ek ( Iv )
+
+	Cn = Pn XOR Iv
+
+	To decipher simply swap C and P.
+
+	See @link glossary @endlink for more information.
+
+	@param Session		Pointer to an initialised session record.
+
+	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+
+	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+
+	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_OFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft = Session->IvHigh32;
+	BLOWFISH_ULONG		XRight = Session->IvLow32;
+	BLOWFISH_ULONG		Temp;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		/* Encipher the initialisation vector */ 
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered initialisation vector with the ciphertext or plaintext */ 
+
+		_BLOWFISH_Store ( OutStream + i, XRight ^ _BLOWFISH_Load ( InStream + i, Swap ), Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, XLeft ^ _BLOWFISH_Load ( InStream + i + 1, Swap ), Swap );
+
+		/* Swap the enciphered initialisation vector */ 
+
+		Temp = XLeft;
+		XLeft = XRight;
+		XRight = Temp;
+	}
+
+	/* Preserve the enciphered initialisation vector as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 = XLeft;
+	Session->IvLow32 = XRight;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in counter (segmented integer counter) mode.
+
+	O = Ek ( Iv ADD ( n ) )
+
+	Cn = Pn XOR O
+
+	To decipher simply swap C and P.
+
+	See @link glossary @endlink for more information.
+
+	@param Session		Pointer to an initialised session record.
+
+	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+
+	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+
+	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks This function can be parallelised using OpenMP.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_CTR ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( InStream, OutStream, IvHigh32, IvLow32, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		/* Encipher the initialisation vector added with the counter */ 
+
+		XLeft = IvHigh32 + (BLOWFISH_ULONG)i;
+		XRight = IvLow32 + (BLOWFISH_ULONG)( i + 1 );
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered initialisation vector with the plaintext or ciphertext */ 
+
+		_BLOWFISH_Store ( OutStream + i, _BLOWFISH_Load ( InStream + i, Swap ) ^ XRight, Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, _BLOWFISH_Load ( InStream + i + 1, Swap ) ^ XLeft, Swap );
+	}
+
+	/* Preserve the initialisation vector added with the counter as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 += (BLOWFISH_ULONG)StreamLength;
+	Session->IvLow32 += (BLOWFISH_ULONG)( StreamLength + 1 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in counter mode, with a 64-bit block counter.
+
+	O = Ek ( Iv + n )
+
+	Cn = Pn XOR O
+
+	To decipher simply swap C and P.
+
+	The initialisation vector is treated as a single 64-bit big-endian counter (IvHigh32 holding the most significant half), which is incremented by one for each block. Unlike #_BLOWFISH_EncipherDecipherStream_CTR the counters do not depend on how the stream is divided, so the counter for any block can be computed from its offset (see #BLOWFISH_SeekStream).
+
+	@param Session		Pointer to an initialised session record.
+
+	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+
+	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+
+	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks This function can be parallelised using OpenMP.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_CTR64 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_ULONGLONG	Counter = (BLOWFISH_ULONGLONG)Session->IvHigh32 << 32 | Session->IvLow32;
+	BLOWFISH_ULONGLONG	Block;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight, Block ) shared ( InStream, OutStream, Counter, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		/* Encipher the counter for this block */ 
+
+		Block = Counter + (BLOWFISH_ULONGLONG)( i >> 1 );
+
+		XLeft = (BLOWFISH_ULONG)( Block >> 32 );
+		XRight = (BLOWFISH_ULONG)Block;
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered counter with the plaintext or ciphertext */ 
+
+		_BLOWFISH_Store ( OutStream + i, _BLOWFISH_Load ( InStream + i, Swap ) ^ XRight, Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, _BLOWFISH_Load ( InStream + i + 1, Swap ) ^ XLeft, Swap );
+	}
+
+	/* Preserve the counter of the next block as the new initialisation vector for stream based operations */ 
+
+	Counter += (BLOWFISH_ULONGLONG)( StreamLength >> 1 );
+
+	Session->IvHigh32 = (BLOWFISH_ULONG)( Counter >> 32 );
+	Session->IvLow32 = (BLOWFISH_ULONG)Counter;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher or decipher a buffer of data of any length as part of a stream, carrying a partial block between calls in the session record.
+
+	@param Session		Pointer to an initialised session record.
+
+	@param Decipher		Non-zero to decipher the buffer, or zero to encipher it.
+
+	@param InStream		Pointer to a buffer of data within the stream.
+
+	@param OutStream	Pointer to a buffer within the stream to receive the output (see #BLOWFISH_EncipherStream for its length).
+
+	@param StreamLength	Length of the input buffer.
+
+	@remarks #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC buffer the bytes following the last whole block in PendingBlock. Other modes generate a whole block of keystream for the bytes following the last whole block, and overwrite the bytes used with the ciphertext, which #BLOWFISH_MODE_CFB feeds back once the block is complete.
+
+  */ 
+
+static void _BLOWFISH_CipherStream ( BLOWFISH_PSESSION Session, int Decipher, BLOWFISH_PCUCHAR InStream, BLOWFISH_PUCHAR OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	static const BLOWFISH_ULONG	Zero [ 2 ] = { 0, 0 };
+
+	BLOWFISH_PUCHAR		Pending = (BLOWFISH_PUCHAR)Session->PendingBlock;
+	void				( *Callback ) ( ) = Decipher ? Session->DecipherStream : Session->EncipherStream;
+	BLOWFISH_SIZE_T		Blocks;
+	BLOWFISH_UCHAR		Byte;
+
+	if ( Session->Mode == BLOWFISH_MODE_ECB || Session->Mode == BLOWFISH_MODE_CBC )
+	{
+		if ( Session->PendingLength != 0 )
+		{
+			/* Complete the buffered block */ 
+
+			while ( Session->PendingLength < 8 && StreamLength != 0 )
+			{
+				Pending [ Session->PendingLength++ ] = *InStream++;
+
+				StreamLength--;
+			}
+
+			if ( Session->PendingLength < 8 )
+			{
+				return;
+			}
+
+			_BLOWFISH_CallStream ( Session, Callback, Decipher, Session->PendingBlock, (BLOWFISH_PULONG)OutStream, 2 );
+
+			OutStream += 8;
+
+			Session->PendingLength = 0;
+		}
+
+		/* Process the whole blocks in place */ 
+
+		Blocks = StreamLength >> 3;
+
+		if ( Blocks != 0 )
+		{
+			_BLOWFISH_CallStream ( Session, Callback, Decipher, (BLOWFISH_PCULONG)InStream, (BLOWFISH_PULONG)OutStream, Blocks << 1 );
+
+			InStream += Blocks << 3;
+		}
+
+		/* Buffer the bytes following the last whole block */ 
+
+		for ( StreamLength &= 0x07; StreamLength != 0; StreamLength-- )
+		{
+			Pending [ Session->PendingLength++ ] = *InStream++;
+		}
+
+		return;
+	}
+
+	/* Use the remainder of the current block of keystream */ 
+
+	while ( Session->PendingLength != 0 && StreamLength != 0 )
+	{
+		Byte = *InStream++;
+
+		*OutStream = Byte ^ Pending [ Session->PendingLength ];
+
+		Pending [ Session->PendingLength ] = Decipher ? Byte : *OutStream;
+
+		OutStream++;
+		StreamLength--;
+
+		if ( ++Session->PendingLength == 8 )
+		{
+			/* The block is complete, so feed the ciphertext back as the initialisation vector (in the same order as the stream callbacks) */ 
+
+			if ( Session->Mode == BLOWFISH_MODE_CFB )
+			{
+				Session->IvHigh32 = _BLOWFISH_Load ( Session->PendingBlock, Session->SwapBytes );
+				Session->IvLow32 = _BLOWFISH_Load ( Session->PendingBlock + 1, Session->SwapBytes );
+			}
+
+			Session->PendingLength = 0;
+		}
+	}
+
+	/* Process the whole blocks in place */ 
+
+	Blocks = StreamLength >> 3;
+
+	if ( Blocks != 0 )
+	{
+		_BLOWFISH_CallStream ( Session, Callback, Decipher, (BLOWFISH_PCULONG)InStream, (BLOWFISH_PULONG)OutStream, Blocks << 1 );
+
+		InStream += Blocks << 3;
+		OutStream += Blocks << 3;
+	}
+
+	StreamLength &= 0x07;
+
+	if ( StreamLength != 0 )
+	{
+		/* Generate the next block of keystream by enciphering a block of zeros (not in place, as the OFB callback cannot be), which advances the counter/feedback as for a whole block (CFB feedback is corrected once the block is complete) */ 
+
+		_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, Zero, Session->PendingBlock, 2 );
+
+		for ( ; Session->PendingLength < StreamLength; Session->PendingLength++ )
+		{
+			Byte = InStream [ Session->PendingLength ];
+
+			OutStream [ Session->PendingLength ] = Byte ^ Pending [ Session->PendingLength ];
+
+			Pending [ Session->PendingLength ] = Decipher ? Byte : OutStream [ Session->PendingLength ];
+		}
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher a buffer in cipher block chaining mode with ciphertext stealing (CBC-CS3).
+
+	@param Session		Pointer to an initialised session record, whose stream has been begun.
+
+	@param InBuffer		Pointer to the plaintext.
+
+	@param OutBuffer	Pointer to a buffer to receive the ciphertext, the same length as the plaintext.
+
+	@param BufferLength	Length of the buffers, of at least 8 bytes.
+
+	@remarks The buffer is enciphered as #BLOWFISH_MODE_CBC with the final (possibly partial) block padded with zeros, then the last two blocks of ciphertext are swapped, and the new final block truncated to the length of the final block of plaintext. A buffer of a single block is enciphered as #BLOWFISH_MODE_CBC.
+
+  */ 
+
+static void _BLOWFISH_EncipherBuffer_CBC_CS3 ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR InBuffer, BLOWFISH_PUCHAR OutBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	BLOWFISH_ULONG	FinalBlock [ 2 ] = { 0, 0 };
+	BLOWFISH_ULONG	StolenBlock [ 2 ];
+	BLOWFISH_SIZE_T	WholeLength = ( BufferLength - 1 ) & ~(BLOWFISH_SIZE_T)0x07;
+	BLOWFISH_SIZE_T	FinalLength = BufferLength - WholeLength;
+
+	if ( WholeLength == 0 )
+	{
+		_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, (BLOWFISH_PCULONG)InBuffer, (BLOWFISH_PULONG)OutBuffer, 2 );
+
+		return;
+	}
+
+	/* Copy the final block of plaintext, padded with zeros, before enciphering in place can overwrite it */ 
+
+	memcpy ( FinalBlock, InBuffer + WholeLength, FinalLength );
+
+	/* Encipher the blocks preceding it, and keep the last block of ciphertext from which bytes are stolen */ 
+
+	_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, (BLOWFISH_PCULONG)InBuffer, (BLOWFISH_PULONG)OutBuffer, WholeLength >> 2 );
+
+	memcpy ( StolenBlock, OutBuffer + WholeLength - 8, sizeof ( StolenBlock ) );
+
+	/* Encipher the final block (chained from the stolen block) in its place, and follow it with as much of the stolen block as the final block was long */ 
+
+	_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, FinalBlock, (BLOWFISH_PULONG)( OutBuffer + WholeLength - 8 ), 2 );
+
+	memcpy ( OutBuffer + WholeLength, StolenBlock, FinalLength );
+
+	_BLOWFISH_Wipe ( FinalBlock, (BLOWFISH_SIZE_T)sizeof ( FinalBlock ) );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a buffer enciphered by #_BLOWFISH_EncipherBuffer_CBC_CS3.
+
+	@param Session		Pointer to an initialised session record, whose stream has been begun.
+
+	@param InBuffer		Pointer to the ciphertext.
+
+	@param OutBuffer	Pointer to a buffer to receive the plaintext, the same length as the ciphertext.
+
+	@param BufferLength	Length of the buffers, of at least 8 bytes.
+
+	@remarks Every block but the last two is deciphered by the #BLOWFISH_MODE_CBC decipher callback, which may be split between threads. Deciphering the final whole block without chaining recovers the bytes stolen from the block before it.
+
+  */ 
+
+static void _BLOWFISH_DecipherBuffer_CBC_CS3 ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR InBuffer, BLOWFISH_PUCHAR OutBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	BLOWFISH_ULONG	FinalBlock [ 2 ];
+	BLOWFISH_ULONG	StolenBlock [ 2 ];
+	BLOWFISH_ULONG	Block [ 2 ];
+	BLOWFISH_ULONG	ChainHigh32;
+	BLOWFISH_ULONG	ChainLow32;
+	BLOWFISH_SIZE_T	WholeLength = ( BufferLength - 1 ) & ~(BLOWFISH_SIZE_T)0x07;
+	BLOWFISH_SIZE_T	FinalLength = BufferLength - WholeLength;
+	BLOWFISH_SIZE_T	i;
+
+	if ( WholeLength == 0 )
+	{
+		_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)InBuffer, (BLOWFISH_PULONG)OutBuffer, 2 );
+
+		return;
+	}
+
+	/* Copy the last two blocks of ciphertext before deciphering in place can overwrite them */ 
+
+	memcpy ( FinalBlock, InBuffer + WholeLength - 8, sizeof ( FinalBlock ) );
+	memcpy ( StolenBlock, InBuffer + WholeLength, FinalLength );
+
+	/* Decipher the blocks preceding them, leaving the last of them (or the initialisation vector) to chain from */ 
+
+	if ( WholeLength > 8 )
+	{
+		_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)InBuffer, (BLOWFISH_PULONG)OutBuffer, ( WholeLength - 8 ) >> 2 );
+	}
+
+	ChainHigh32 = Session->IvHigh32;
+	ChainLow32 = Session->IvLow32;
+
+	/* Decipher the final whole block without chaining, to yield the final block of plaintext XOR the stolen block, whose missing bytes were enciphered as zeros */ 
+
+	Session->IvHigh32 = 0;
+	Session->IvLow32 = 0;
+
+	_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, FinalBlock, Block, 2 );
+
+	for ( i = 0; i < 8; i++ )
+	{
+		if ( i < FinalLength )
+		{
+			OutBuffer [ WholeLength + i ] = ( (BLOWFISH_PUCHAR)Block ) [ i ] ^ ( (BLOWFISH_PUCHAR)StolenBlock ) [ i ];
+		}
+		else
+		{
+			( (BLOWFISH_PUCHAR)StolenBlock ) [ i ] = ( (BLOWFISH_PUCHAR)Block ) [ i ];
+		}
+	}
+
+	/* Decipher the restored stolen block, chained from the block before it */ 
+
+	Session->IvHigh32 = ChainHigh32;
+	Session->IvLow32 = ChainLow32;
+
+	_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, StolenBlock, (BLOWFISH_PULONG)( OutBuffer + WholeLength - 8 ), 2 );
+
+	_BLOWFISH_Wipe ( FinalBlock, (BLOWFISH_SIZE_T)sizeof ( FinalBlock ) );
+	_BLOWFISH_Wipe ( Block, (BLOWFISH_SIZE_T)sizeof ( Block ) );
+
+	return;
+}
+
+/** @internal A buffer being enciphered/deciphered in #BLOWFISH_MODE_CBC_LANES, split into slices of lanes run in parallel. */ 
+
+typedef struct __BLOWFISH_LANES
+{
+	BLOWFISH_PSESSION	Session;								/*!< Session record the buffer is processed with (only read while the slices run). */ 
+	int					Decipher;								/*!< Non-zero if the buffer is being deciphered. */ 
+	BLOWFISH_PCUCHAR	InBuffer;								/*!< Input buffer. */ 
+	BLOWFISH_PUCHAR		OutBuffer;								/*!< Output buffer. */ 
+	BLOWFISH_SIZE_T		Blocks;									/*!< Length of the buffers in 8-byte blocks. */ 
+	BLOWFISH_SIZE_T		SliceLanes;								/*!< Number of lanes in each slice (except perhaps the last). */ 
+	BLOWFISH_ULONG		Iv [ BLOWFISH_CBC_LANES * 2 ];			/*!< Initialisation vector of each lane, as it would be stored in the buffer. */ 
+	volatile long		Slices;									/*!< Number of slices run. */ 
+
+} _BLOWFISH_LANES;
+
+/**
+
+	@internal
+
+	Encipher/decipher a range of slices of the lanes of a #BLOWFISH_MODE_CBC_LANES buffer.
+
+	@param BodyContext	Pointer to the buffer being processed (see #_BLOWFISH_LANES).
+
+	@param Begin		Index of the first slice.
+
+	@param End			Index of the slice following the range.
+
+	@remarks Each group of #BLOWFISH_CBC_LANES blocks holds one block of every lane, so the blocks of a slice within a group are adjacent, and are passed to the #BLOWFISH_MODE_ECB callback of the current kernel together. The chaining is applied to the bytes of the buffer, which is equivalent to applying it after loading them in either byte order.
+
+  */ 
+
+static void _BLOWFISH_LaneSlices ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	_BLOWFISH_LANES *	Lanes = (_BLOWFISH_LANES *)BodyContext;
+	BLOWFISH_SESSION	Session = *Lanes->Session;
+	BLOWFISH_ULONG		Previous [ BLOWFISH_CBC_LANES * 2 ];
+	BLOWFISH_ULONG		Current [ BLOWFISH_CBC_LANES * 2 ];
+	BLOWFISH_SIZE_T		FirstLane = Begin * Lanes->SliceLanes;
+	BLOWFISH_SIZE_T		LaneCount = End * Lanes->SliceLanes < BLOWFISH_CBC_LANES ? End * Lanes->SliceLanes - FirstLane : BLOWFISH_CBC_LANES - FirstLane;
+	BLOWFISH_SIZE_T		Group;
+	BLOWFISH_SIZE_T		Count;
+	BLOWFISH_SIZE_T		i;
+
+	/* The slices provide the parallelism, so the callback runs on this thread alone */ 
+
+	Session.MaxThreads = 1;
+	Session.Threads = 1;
+
+	memcpy ( Previous, Lanes->Iv + FirstLane * 2, LaneCount * 8 );
+
+	for ( Group = FirstLane; Group < Lanes->Blocks; Group += BLOWFISH_CBC_LANES )
+	{
+		BLOWFISH_PCUCHAR	In = Lanes->InBuffer + Group * 8;
+		BLOWFISH_PUCHAR		Out = Lanes->OutBuffer + Group * 8;
+
+		Count = Lanes->Blocks - Group < LaneCount ? Lanes->Blocks - Group : LaneCount;
+
+		if ( Lanes->Decipher == 0 )
+		{
+			/* Chain each plaintext block from the previous ciphertext block of its lane, then encipher the blocks in place */ 
+
+			for ( i = 0; i < Count * 2; i++ )
+			{
+				_BLOWFISH_Store ( Out + i * 4, _BLOWFISH_Load ( In + i * 4, 0 ) ^ Previous [ i ], 0 );
+			}
+
+			Session.EncipherStream ( &Session, (BLOWFISH_PCULONG)Out, (BLOWFISH_PULONG)Out, Count * 2 );
+
+			memcpy ( Previous, Out, Count * 8 );
+		}
+		else
+		{
+			/* Keep the ciphertext blocks for the next group before deciphering in place can overwrite them */ 
+
+			memcpy ( Current, In, Count * 8 );
+
+			Session.DecipherStream ( &Session, Current, (BLOWFISH_PULONG)Out, Count * 2 );
+
+			for ( i = 0; i < Count * 2; i++ )
+			{
+				_BLOWFISH_Store ( Out + i * 4, _BLOWFISH_Load ( Out + i * 4, 0 ) ^ Previous [ i ], 0 );
+			}
+
+			memcpy ( Previous, Current, Count * 8 );
+		}
+	}
+
+	_BLOWFISH_Wipe ( Previous, (BLOWFISH_SIZE_T)sizeof ( Previous ) );
+
+	_BLOWFISH_ATOMIC_ADD ( Lanes->Slices, 1 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/decipher a buffer in interleaved cipher block chaining mode (#BLOWFISH_MODE_CBC_LANES).
+
+	@param Session		Pointer to an initialised session record, whose stream has been begun.
+
+	@param Decipher		Non-zero to decipher the buffer.
+
+	@param InBuffer		Pointer to the input buffer.
+
+	@param OutBuffer	Pointer to the output buffer, the same length as the input buffer (which it may equal).
+
+	@param BufferLength	Length of the buffers, a non-zero multiple of 8.
+
+	@remarks The initialisation vector of lane j is Ek ( Ek ( Iv ) XOR j ), with j XORed into the low 32-bits. The lanes are split into slices of a multiple of 8 lanes, one per thread the buffer length allows (see #BLOWFISH_SetParallelThreshold), which are run in parallel as for #_BLOWFISH_ParallelFor.
+
+  */ 
+
+static void _BLOWFISH_CipherBuffer_CBC_LANES ( BLOWFISH_PSESSION Session, int Decipher, BLOWFISH_PCUCHAR InBuffer, BLOWFISH_PUCHAR OutBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	_BLOWFISH_LANES	Lanes;
+	BLOWFISH_ULONG	BaseHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG	BaseLow32 = Session->IvLow32;
+	BLOWFISH_ULONG	LaneHigh32;
+	BLOWFISH_ULONG	LaneLow32;
+	BLOWFISH_SIZE_T	Slices = BufferLength / _BLOWFISH_ParallelThreshold;
+	BLOWFISH_SIZE_T	j;
+
+	Lanes.Session = Session;
+	Lanes.Decipher = Decipher;
+	Lanes.InBuffer = InBuffer;
+	Lanes.OutBuffer = OutBuffer;
+	Lanes.Blocks = BufferLength >> 3;
+	Lanes.Slices = 0;
+
+	/* Derive the initialisation vector of each lane used from the enciphered initialisation vector */ 
+
+	_BLOWFISH_EncipherBlock ( Session->KeySchedule, &BaseHigh32, &BaseLow32 );
+
+	for ( j = 0; j < BLOWFISH_CBC_LANES && j < Lanes.Blocks; j++ )
+	{
+		LaneHigh32 = BaseHigh32;
+		LaneLow32 = BaseLow32 ^ (BLOWFISH_ULONG)j;
+
+		_BLOWFISH_EncipherBlock ( Session->KeySchedule, &LaneHigh32, &LaneLow32 );
+
+		_BLOWFISH_Store ( Lanes.Iv + j * 2, LaneHigh32, Session->SwapBytes );
+		_BLOWFISH_Store ( Lanes.Iv + j * 2 + 1, LaneLow32, Session->SwapBytes );
+	}
+
+	/* Split the lanes into at most one slice per thread the buffer length allows, each a multiple of 8 lanes */ 
+
+	if ( Session->MaxThreads != 0 && Slices > (BLOWFISH_SIZE_T)Session->MaxThreads )
+	{
+		Slices = (BLOWFISH_SIZE_T)Session->MaxThreads;
+	}
+
+	if ( Slices > BLOWFISH_CBC_LANES / 8 )
+	{
+		Slices = BLOWFISH_CBC_LANES / 8;
+	}
+	else if ( Slices < 1 )
+	{
+		Slices = 1;
+	}
+
+	Lanes.SliceLanes = ( ( BLOWFISH_CBC_LANES / Slices ) + 7 ) & ~(BLOWFISH_SIZE_T)0x07;
+
+	_BLOWFISH_ParallelFor ( ( BLOWFISH_CBC_LANES + Lanes.SliceLanes - 1 ) / Lanes.SliceLanes, &_BLOWFISH_LaneSlices, &Lanes );
+
+	Session->Threads = (BLOWFISH_ULONG)Lanes.Slices;
+
+	_BLOWFISH_Wipe ( Lanes.Iv, (BLOWFISH_SIZE_T)sizeof ( Lanes.Iv ) );
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextStream, BLOWFISH_PUCHAR CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	/* Ensure the session record and stream buffer pointers are non null */ 
+
+	if ( Session == 0 || PlainTextStream == 0 || CipherTextStream == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ciphertext stealing needs the end of the message, and interleaved lanes the length of the message, so cannot be streamed */ 
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 || Session->Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+	/* Ensure the stream length is non-zero */ 
+
+	if ( StreamLength == 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	} 
+
+#ifdef _OPENMP
+
+	/* Ensure the stream length is not negative */ 
+
+	if ( StreamLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	/* Encipher stream based on block cipher mode */ 
+
+	_BLOWFISH_CipherStream ( Session, 0, PlainTextStream, CipherTextStream, StreamLength );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextStream, BLOWFISH_PUCHAR CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_EncipherSessionStream ( &Context->Session, PlainTextStream, CipherTextStream, StreamLength );
+}
+
+BLOWFISH_RC BLOWFISH_EncipherSessionBuffer ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	/* Ensure the session record and buffer pointers are non null */ 
+
+	if ( Session == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ensure the buffer length is a non-zero multiple of 8 (or at least 8 when stealing ciphertext) */ 
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		if ( BufferLength < 8 )
+		{
+			return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		}
+	}
+	else if ( BufferLength == 0 || ( BufferLength & 0x07 ) != 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the buffer length is not negative */ 
+
+	if ( BufferLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	/* Encipher buffer as a stream based on the block cipher mode */ 
+
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		_BLOWFISH_EncipherBuffer_CBC_CS3 ( Session, PlainTextBuffer, CipherTextBuffer, BufferLength );
+	}
+	else if ( Session->Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		_BLOWFISH_CipherBuffer_CBC_LANES ( Session, 0, PlainTextBuffer, CipherTextBuffer, BufferLength );
+	}
+	else
+	{
+		_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, (BLOWFISH_PCULONG)PlainTextBuffer, (BLOWFISH_PULONG)CipherTextBuffer, BufferLength >> 2 );
+	}
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherBuffer ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_EncipherSessionBuffer ( &Context->Session, PlainTextBuffer, CipherTextBuffer, BufferLength );
+}
+
+/**
+
+	@internal
+
+	Perform 16-round decipher, finalise round and unswap xL and xR:
+
+	xR = xR XOR P0
+
+	xL = xL XOR P1
+
+	See @link glossary @endlink for more information.
+
+	@param BufferHigh		Pointer to the high 32-bits of the output buffer.
+
+	@param BufferLow		Pointer to the low 32-bits of the output buffer.
+
+	@param XLeft			High 32-bits of the message to decipher.
+
+	@param XRight			Low 32-bits of the message to decipher.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+
+  */ 
+
+#define _BLOWFISH_DECIPHER( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3 )	\
+{																						\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 17 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 16 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 15 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 14 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 13 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 12 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 11 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 10 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 9 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 8 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 7 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 6 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 5 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 4 );							\
+	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 3 );							\
+	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 2 );							\
+	BufferHigh = XRight ^ P [ 0 ];														\
+	BufferLow = XLeft ^ P [ 1 ];														\
+}
+
+void BLOWFISH_Decipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
+{
+	BLOWFISH_ULONG		XLeft = *High32;
+	BLOWFISH_ULONG		XRight = *Low32;
+	BLOWFISH_PCULONG	P = Context->KeySchedule.PArray;
+	BLOWFISH_PCULONG	S0 = Context->KeySchedule.SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Context->KeySchedule.SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Context->KeySchedule.SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Context->KeySchedule.SBox [ 3 ];
+
+	/* Decipher 8-byte plaintext block */ 
+
+	_BLOWFISH_DECIPHER ( *High32, *Low32, XLeft, XRight, P, S0, S1, S2, S3 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in electronic codebook mode.
+
+	Pn = Ek ( Cn )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param CipherTextStream	Buffer of ciphertext to decipher.
+
+	@param CipherTextStream	Buffer to receive the plaintext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks This function can be parallelised using OpenMP.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_ECB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Decipher ciphertext in 8-byte blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		XLeft = _BLOWFISH_Load ( CipherTextStream + i, Swap );
+		XRight = _BLOWFISH_Load ( CipherTextStream + i + 1, Swap );
+
+		_BLOWFISH_DECIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( PlainTextStream + i, XRight, Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 1, XLeft, Swap );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in cipher block chaining mode.
+
+	Round 1:
+
+	P0 = Dk ( C0 ) XOR ( Iv )
+
+	Round n:
+
+	Pn = Dk ( Cn ) XOR ( Cn - 1 )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param CipherTextStream	Buffer of ciphertext to decipher.
+
+	@param CipherTextStream	Buffer to receive the plaintext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks The previous block of ciphertext is kept in registers, so the stream may be deciphered in place. Long streams are split into ranges deciphered in parallel by #_BLOWFISH_CallStream.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_CBC ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_ULONG		CipherTextHigh32;
+	BLOWFISH_ULONG		CipherTextLow32;
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		/* Decipher block of ciphertext, keeping a copy to chain the next block from */ 
+
+		CipherTextHigh32 = _BLOWFISH_Load ( CipherTextStream + i, Swap );
+		CipherTextLow32 = _BLOWFISH_Load ( CipherTextStream + i + 1, Swap );
+
+		XLeft = CipherTextHigh32;
+		XRight = CipherTextLow32;
+
+		_BLOWFISH_DECIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the deciphered block with the previous block of ciphertext (or the initialisation vector) to yeild the plaintext */ 
+
+		_BLOWFISH_Store ( PlainTextStream + i, XRight ^ IvHigh32, Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 1, XLeft ^ IvLow32, Swap );
+
+		IvHigh32 = CipherTextHigh32;
+		IvLow32 = CipherTextLow32;
+	}
+
+	/* Preserve the last block of ciphertext as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 = IvHigh32;
+	Session->IvLow32 = IvLow32;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in cipher feedback mode.
+
+	Round 1:
+
+	P0 = C0 XOR Ek ( Iv )
+
+	Round n:
+
+	Pn = Cn XOR Ek ( ( Cn - 1 ) )
+
+	See @link glossary @endlink for more information.
+
+	@param Session			Pointer to an initialised session record.
+
+	@param CipherTextStream	Buffer of ciphertext to decipher.
+
+	@param CipherTextStream	Buffer to receive the plaintext.
+
+	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+
+	@remarks The previous block of ciphertext is kept in registers, so the stream may be deciphered in place. Long streams are split into ranges deciphered in parallel by #_BLOWFISH_CallStream.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_CFB ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	for ( i = 0; i < StreamLength; i += 2 )
+	{
+		/* Encipher the previous block of ciphertext (or the initialisation vector) */ 
+
+		XLeft = IvHigh32;
+		XRight = IvLow32;
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR with the current block of ciphertext to yeild the plaintext, keeping a copy of the ciphertext to feed back into the next block */ 
+
+		IvHigh32 = _BLOWFISH_Load ( CipherTextStream + i, Swap );
+		IvLow32 = _BLOWFISH_Load ( CipherTextStream + i + 1, Swap );
+
+		_BLOWFISH_Store ( PlainTextStream + i, XRight ^ IvHigh32, Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 1, XLeft ^ IvLow32, Swap );
+	}
+
+	/* Preserve the last block of ciphertext as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 = IvHigh32;
+	Session->IvLow32 = IvLow32;
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_DecipherSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextStream, BLOWFISH_PUCHAR PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	/* Ensure the session record and stream buffer pointers are non null */ 
+
+	if ( Session == 0 || CipherTextStream == 0 || PlainTextStream == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ciphertext stealing needs the end of the message, and interleaved lanes the length of the message, so cannot be streamed */ 
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 || Session->Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+	/* Ensure the stream length is non-zero */ 
+
+	if ( StreamLength == 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the stream length is not negative */ 
+
+	if ( StreamLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	/* Decipher stream buffer based on block cipher mode */ 
+
+	_BLOWFISH_CipherStream ( Session, 1, CipherTextStream, PlainTextStream, StreamLength );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_DecipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextStream, BLOWFISH_PUCHAR PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_DecipherSessionStream ( &Context->Session, CipherTextStream, PlainTextStream, StreamLength );
+}
+
+BLOWFISH_RC BLOWFISH_DecipherSessionBuffer ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	/* Ensure the session record and buffer pointers are non null */ 
+
+	if ( Session == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ensure the buffer length is a non-zero multiple of 8 (or at least 8 when stealing ciphertext) */ 
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		if ( BufferLength < 8 )
+		{
+			return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		}
+	}
+	else if ( BufferLength == 0 || ( BufferLength & 0x07 ) != 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the buffer length is not negative */ 
+
+	if ( BufferLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	/* Decipher buffer as a stream based on the block cipher mode */ 
+
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		_BLOWFISH_DecipherBuffer_CBC_CS3 ( Session, CipherTextBuffer, PlainTextBuffer, BufferLength );
+	}
+	else if ( Session->Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		_BLOWFISH_CipherBuffer_CBC_LANES ( Session, 1, CipherTextBuffer, PlainTextBuffer, BufferLength );
+	}
+	else
+	{
+		_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)CipherTextBuffer, (BLOWFISH_PULONG)PlainTextBuffer, BufferLength >> 2 );
+	}
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_DecipherBuffer ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_DecipherSessionBuffer ( &Context->Session, CipherTextBuffer, PlainTextBuffer, BufferLength );
+}
+
+BLOWFISH_RC BLOWFISH_EncipherSessionBufferPadded ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T PlainTextLength )
+{
+	BLOWFISH_ULONG	FinalBlock [ 2 ];
+	BLOWFISH_SIZE_T	WholeLength;
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure the session record and buffer pointers are non null */ 
+
+	if ( Session == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Padding is only defined for the block modes */ 
+
+	if ( Session->Mode != BLOWFISH_MODE_ECB && Session->Mode != BLOWFISH_MODE_CBC )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the buffer length is not negative */ 
+
+	if ( PlainTextLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	WholeLength = PlainTextLength & ~(BLOWFISH_SIZE_T)0x07;
+
+	/* Build the final block from the bytes following the last whole block, followed by 1-8 bytes each holding the number of bytes of padding (this must be done first, as the final block may be overwritten if enciphering in place) */ 
+
+	for ( i = 0; i < 8; i++ )
+	{
+		( (BLOWFISH_PUCHAR)FinalBlock ) [ i ] = WholeLength + i < PlainTextLength ? PlainTextBuffer [ WholeLength + i ] : (BLOWFISH_UCHAR)( 8 - ( PlainTextLength - WholeLength ) );
+	}
+
+	/* Encipher the whole blocks directly from the plaintext, followed by the final block */ 
+
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	if ( WholeLength != 0 )
+	{
+		_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, (BLOWFISH_PCULONG)PlainTextBuffer, (BLOWFISH_PULONG)CipherTextBuffer, WholeLength >> 2 );
+	}
+
+	_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, FinalBlock, (BLOWFISH_PULONG)( CipherTextBuffer + WholeLength ), 2 );
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	_BLOWFISH_Wipe ( FinalBlock, (BLOWFISH_SIZE_T)sizeof ( FinalBlock ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherBufferPadded ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T PlainTextLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_EncipherSessionBufferPadded ( &Context->Session, PlainTextBuffer, CipherTextBuffer, PlainTextLength );
+}
+
+BLOWFISH_RC BLOWFISH_DecipherSessionBufferPadded ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength, BLOWFISH_SIZE_T * PlainTextLength )
+{
+	BLOWFISH_ULONG	FinalBlock [ 2 ];
+	BLOWFISH_ULONG	PadLength;
+	BLOWFISH_ULONG	BadPadding;
+	BLOWFISH_ULONG	i;
+
+	/* Ensure the session record, buffer and length pointers are non null */ 
+
+	if ( Session == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 || PlainTextLength == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Padding is only defined for the block modes */ 
+
+	if ( Session->Mode != BLOWFISH_MODE_ECB && Session->Mode != BLOWFISH_MODE_CBC )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+	/* Ensure the buffer length is a non-zero multiple of 8 */ 
+
+	if ( BufferLength == 0 || ( BufferLength & 0x07 ) != 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the buffer length is not negative */ 
+
+	if ( BufferLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	/* Decipher all but the final block directly into the plaintext, then the final block (chained from the last of the others) into registers */ 
+
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	if ( BufferLength > 8 )
+	{
+		_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)CipherTextBuffer, (BLOWFISH_PULONG)PlainTextBuffer, ( BufferLength - 8 ) >> 2 );
+	}
+
+	_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)( CipherTextBuffer + BufferLength - 8 ), FinalBlock, 2 );
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	/* Verify the padding, examining every byte of the final block so that the time taken does not depend on the padding length */ 
+
+	PadLength = ( (BLOWFISH_PUCHAR)FinalBlock ) [ 7 ];
+	BadPadding = PadLength == 0 || PadLength > 8;
+
+	for ( i = 0; i < 8; i++ )
+	{
+		BadPadding |= ( ( (BLOWFISH_PUCHAR)FinalBlock ) [ i ] ^ PadLength ) & ( 0 - (BLOWFISH_ULONG)( i + PadLength >= 8 ) );
+	}
+
+	if ( BadPadding != 0 )
+	{
+		_BLOWFISH_Wipe ( FinalBlock, (BLOWFISH_SIZE_T)sizeof ( FinalBlock ) );
+
+		return BLOWFISH_RC_BAD_PADDING;
+	}
+
+	/* Write only the bytes of the final block that precede the padding */ 
+
+	memcpy ( PlainTextBuffer + BufferLength - 8, FinalBlock, 8 - PadLength );
+
+	*PlainTextLength = BufferLength - (BLOWFISH_SIZE_T)PadLength;
+
+	_BLOWFISH_Wipe ( FinalBlock, (BLOWFISH_SIZE_T)sizeof ( FinalBlock ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_DecipherBufferPadded ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength, BLOWFISH_SIZE_T * PlainTextLength )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_DecipherSessionBufferPadded ( &Context->Session, CipherTextBuffer, PlainTextBuffer, BufferLength, PlainTextLength );
+}
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher on 2 independent blocks, interleaving the S-Box lookups to hide load latency.
+
+	See #_BLOWFISH_CIPHER for more information.
+
+	@remarks After each round the caller must swap xL and xR.
+
+	@param XLeft			Array of the high 32-bits of 2 messages to encipher.
+
+	@param XRight			Array of the low 32-bits of 2 messages to encipher.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+	@param Round			Current round to perform (0-15 to encipher, 17-2 to decipher).
+
+  */ 
+
+#define _BLOWFISH_CIPHER_X2( XLeft, XRight, P, S0, S1, S2, S3, Round )		\
+{																			\
+	_BLOWFISH_CIPHER ( XLeft [ 0 ], XRight [ 0 ], P, S0, S1, S2, S3, Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 1 ], XRight [ 1 ], P, S0, S1, S2, S3, Round );	\
+}
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher on 4 independent blocks. See #_BLOWFISH_CIPHER_X2 for more information.
+
+  */ 
+
+#define _BLOWFISH_CIPHER_X4( XLeft, XRight, P, S0, S1, S2, S3, Round )		\
+{																			\
+	_BLOWFISH_CIPHER ( XLeft [ 0 ], XRight [ 0 ], P, S0, S1, S2, S3, Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 1 ], XRight [ 1 ], P, S0, S1, S2, S3, Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 2 ], XRight [ 2 ], P, S0, S1, S2, S3, Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 3 ], XRight [ 3 ], P, S0, S1, S2, S3, Round );	\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round encipher on several independent blocks round by round, finalise round and unswap xL and xR.
+
+	See #_BLOWFISH_ENCIPHER for more information.
+
+	@param Cipher			Round macro, either #_BLOWFISH_CIPHER_X2 or #_BLOWFISH_CIPHER_X4.
+
+	@param Lanes			Number of blocks processed by the round macro.
+
+	@param XLeft			Array of the high 32-bits of the messages to encipher, which receives the high 32-bits of the output.
+
+	@param XRight			Array of the low 32-bits of the messages to encipher, which receives the low 32-bits of the output.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+  */ 
+
+#define _BLOWFISH_ENCIPHER_INTERLEAVED( Cipher, Lanes, XLeft, XRight, P, S0, S1, S2, S3 )		\
+{																								\
+	BLOWFISH_SIZE_T	_BLOWFISH_Lane;																\
+	BLOWFISH_ULONG	_BLOWFISH_Swap;																\
+																								\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 0 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 1 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 2 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 3 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 4 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 5 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 6 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 7 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 8 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 9 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 10 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 11 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 12 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 13 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 14 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 15 );											\
+																								\
+	for ( _BLOWFISH_Lane = 0; _BLOWFISH_Lane < Lanes; _BLOWFISH_Lane++ )						\
+	{																							\
+		_BLOWFISH_Swap = XLeft [ _BLOWFISH_Lane ] ^ P [ 16 ];									\
+		XLeft [ _BLOWFISH_Lane ] = XRight [ _BLOWFISH_Lane ] ^ P [ 17 ];						\
+		XRight [ _BLOWFISH_Lane ] = _BLOWFISH_Swap;												\
+	}																							\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round decipher on several independent blocks round by round, finalise round and unswap xL and xR.
+
+	See #_BLOWFISH_DECIPHER and #_BLOWFISH_ENCIPHER_INTERLEAVED for more information.
+
+  */ 
+
+#define _BLOWFISH_DECIPHER_INTERLEAVED( Cipher, Lanes, XLeft, XRight, P, S0, S1, S2, S3 )		\
+{																								\
+	BLOWFISH_SIZE_T	_BLOWFISH_Lane;																\
+	BLOWFISH_ULONG	_BLOWFISH_Swap;																\
+																								\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 17 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 16 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 15 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 14 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 13 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 12 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 11 );											\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 10 );											\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 9 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 8 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 7 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 6 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 5 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 4 );												\
+	Cipher ( XLeft, XRight, P, S0, S1, S2, S3, 3 );												\
+	Cipher ( XRight, XLeft, P, S0, S1, S2, S3, 2 );												\
+																								\
+	for ( _BLOWFISH_Lane = 0; _BLOWFISH_Lane < Lanes; _BLOWFISH_Lane++ )						\
+	{																							\
+		_BLOWFISH_Swap = XLeft [ _BLOWFISH_Lane ] ^ P [ 1 ];									\
+		XLeft [ _BLOWFISH_Lane ] = XRight [ _BLOWFISH_Lane ] ^ P [ 0 ];							\
+		XRight [ _BLOWFISH_Lane ] = _BLOWFISH_Swap;												\
+	}																							\
+}
+
+/**
+
+	@internal
+
+	Encipher a stream of data in electronic codebook mode, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_EncipherStream_ECB for more information.
+
+	@remarks Any blocks remaining after the last group of 4 are interleaved 2 at a time, then enciphered singly.
+
+  */ 
+
+static void _BLOWFISH_EncipherStream_ECB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft [ 2 ];
+	BLOWFISH_ULONG		XRight [ 2 ];
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher plaintext in 32-byte groups of 4 blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, GroupLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		BLOWFISH_ULONG	GroupLeft [ 4 ];
+		BLOWFISH_ULONG	GroupRight [ 4 ];
+		BLOWFISH_SIZE_T	j;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			GroupLeft [ j ] = _BLOWFISH_Load ( PlainTextStream + i + j * 2, Swap );
+			GroupRight [ j ] = _BLOWFISH_Load ( PlainTextStream + i + j * 2 + 1, Swap );
+		}
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, GroupLeft, GroupRight, P, S0, S1, S2, S3 );
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( CipherTextStream + i + j * 2, GroupLeft [ j ], Swap );
+			_BLOWFISH_Store ( CipherTextStream + i + j * 2 + 1, GroupRight [ j ], Swap );
+		}
+	}
+
+	/* Encipher any remaining pair of blocks */ 
+
+	i = GroupLength;
+
+	if ( StreamLength - i >= 4 )
+	{
+		XLeft [ 0 ] = _BLOWFISH_Load ( PlainTextStream + i, Swap );
+		XRight [ 0 ] = _BLOWFISH_Load ( PlainTextStream + i + 1, Swap );
+		XLeft [ 1 ] = _BLOWFISH_Load ( PlainTextStream + i + 2, Swap );
+		XRight [ 1 ] = _BLOWFISH_Load ( PlainTextStream + i + 3, Swap );
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X2, 2, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( CipherTextStream + i, XLeft [ 0 ], Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 1, XRight [ 0 ], Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 2, XLeft [ 1 ], Swap );
+		_BLOWFISH_Store ( CipherTextStream + i + 3, XRight [ 1 ], Swap );
+
+		i += 4;
+	}
+
+	/* Encipher any remaining block */ 
+
+	if ( i < StreamLength )
+	{
+		_BLOWFISH_EncipherStream_ECB ( Session, PlainTextStream + i, CipherTextStream + i, StreamLength - i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in electronic codebook mode, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_DecipherStream_ECB for more information.
+
+	@remarks Any blocks remaining after the last group of 4 are interleaved 2 at a time, then deciphered singly.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_ECB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft [ 2 ];
+	BLOWFISH_ULONG		XRight [ 2 ];
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Decipher ciphertext in 32-byte groups of 4 blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, GroupLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		BLOWFISH_ULONG	GroupLeft [ 4 ];
+		BLOWFISH_ULONG	GroupRight [ 4 ];
+		BLOWFISH_SIZE_T	j;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			GroupLeft [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2, Swap );
+			GroupRight [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2 + 1, Swap );
+		}
+
+		_BLOWFISH_DECIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, GroupLeft, GroupRight, P, S0, S1, S2, S3 );
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2, GroupLeft [ j ], Swap );
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2 + 1, GroupRight [ j ], Swap );
+		}
+	}
+
+	/* Decipher any remaining pair of blocks */ 
+
+	i = GroupLength;
+
+	if ( StreamLength - i >= 4 )
+	{
+		XLeft [ 0 ] = _BLOWFISH_Load ( CipherTextStream + i, Swap );
+		XRight [ 0 ] = _BLOWFISH_Load ( CipherTextStream + i + 1, Swap );
+		XLeft [ 1 ] = _BLOWFISH_Load ( CipherTextStream + i + 2, Swap );
+		XRight [ 1 ] = _BLOWFISH_Load ( CipherTextStream + i + 3, Swap );
+
+		_BLOWFISH_DECIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X2, 2, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( PlainTextStream + i, XLeft [ 0 ], Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 1, XRight [ 0 ], Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 2, XLeft [ 1 ], Swap );
+		_BLOWFISH_Store ( PlainTextStream + i + 3, XRight [ 1 ], Swap );
+
+		i += 4;
+	}
+
+	/* Decipher any remaining block */ 
+
+	if ( i < StreamLength )
+	{
+		_BLOWFISH_DecipherStream_ECB ( Session, CipherTextStream + i, PlainTextStream + i, StreamLength - i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in cipher block chaining mode, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_DecipherStream_CBC for more information.
+
+	@remarks Any blocks remaining after the last group of 4 are deciphered by #_BLOWFISH_DecipherStream_CBC.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_CBC_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft [ 4 ];
+	BLOWFISH_ULONG		XRight [ 4 ];
+	BLOWFISH_ULONG		CipherTextLeft [ 4 ];
+	BLOWFISH_ULONG		CipherTextRight [ 4 ];
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+	BLOWFISH_SIZE_T		j;
+
+	/* Decipher ciphertext in 32-byte groups of 4 blocks */ 
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		for ( j = 0; j < 4; j++ )
+		{
+			XLeft [ j ] = CipherTextLeft [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2, Swap );
+			XRight [ j ] = CipherTextRight [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2 + 1, Swap );
+		}
+
+		_BLOWFISH_DECIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR the deciphered blocks with the previous blocks of ciphertext (or the initialisation vector) to yeild the plaintext */ 
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2, XLeft [ j ] ^ IvHigh32, Swap );
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2 + 1, XRight [ j ] ^ IvLow32, Swap );
+
+			IvHigh32 = CipherTextLeft [ j ];
+			IvLow32 = CipherTextRight [ j ];
+		}
+	}
+
+	Session->IvHigh32 = IvHigh32;
+	Session->IvLow32 = IvLow32;
+
+	/* Decipher any remaining blocks singly */ 
+
+	if ( i < StreamLength )
+	{
+		_BLOWFISH_DecipherStream_CBC ( Session, CipherTextStream + i, PlainTextStream + i, StreamLength - i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher a stream of data in cipher feedback mode, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_DecipherStream_CFB for more information.
+
+	@remarks Any blocks remaining after the last group of 4 are deciphered by #_BLOWFISH_DecipherStream_CFB.
+
+  */ 
+
+static void _BLOWFISH_DecipherStream_CFB_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft [ 4 ];
+	BLOWFISH_ULONG		XRight [ 4 ];
+	BLOWFISH_ULONG		CipherTextLeft [ 4 ];
+	BLOWFISH_ULONG		CipherTextRight [ 4 ];
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+	BLOWFISH_SIZE_T		j;
+
+	/* Decipher ciphertext in 32-byte groups of 4 blocks */ 
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		/* Encipher the previous blocks of ciphertext (or the initialisation vector) */ 
+
+		for ( j = 0; j < 4; j++ )
+		{
+			XLeft [ j ] = IvHigh32;
+			XRight [ j ] = IvLow32;
+
+			IvHigh32 = CipherTextLeft [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2, Swap );
+			IvLow32 = CipherTextRight [ j ] = _BLOWFISH_Load ( CipherTextStream + i + j * 2 + 1, Swap );
+		}
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		/* XOR with the current blocks of ciphertext to yeild the plaintext */ 
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2, XLeft [ j ] ^ CipherTextLeft [ j ], Swap );
+			_BLOWFISH_Store ( PlainTextStream + i + j * 2 + 1, XRight [ j ] ^ CipherTextRight [ j ], Swap );
+		}
+	}
+
+	Session->IvHigh32 = IvHigh32;
+	Session->IvLow32 = IvLow32;
+
+	/* Decipher any remaining blocks singly */ 
+
+	if ( i < StreamLength )
+	{
+		_BLOWFISH_DecipherStream_CFB ( Session, CipherTextStream + i, PlainTextStream + i, StreamLength - i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in counter mode, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_EncipherDecipherStream_CTR for more information.
+
+	@remarks Produces exactly the same keystream as #_BLOWFISH_EncipherDecipherStream_CTR.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_CTR_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft [ 2 ];
+	BLOWFISH_ULONG		XRight [ 2 ];
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher the initialisation vector added with the counter in groups of 4 blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( InStream, OutStream, IvHigh32, IvLow32, P, S0, S1, S2, S3, GroupLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		BLOWFISH_ULONG	GroupLeft [ 4 ];
+		BLOWFISH_ULONG	GroupRight [ 4 ];
+		BLOWFISH_SIZE_T	j;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			GroupLeft [ j ] = IvHigh32 + (BLOWFISH_ULONG)( i + j * 2 );
+			GroupRight [ j ] = IvLow32 + (BLOWFISH_ULONG)( i + j * 2 + 1 );
+		}
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, GroupLeft, GroupRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered counters with the plaintext or ciphertext */ 
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( OutStream + i + j * 2, _BLOWFISH_Load ( InStream + i + j * 2, Swap ) ^ GroupLeft [ j ], Swap );
+			_BLOWFISH_Store ( OutStream + i + j * 2 + 1, _BLOWFISH_Load ( InStream + i + j * 2 + 1, Swap ) ^ GroupRight [ j ], Swap );
+		}
+	}
+
+	/* Process any remaining pair of blocks */ 
+
+	i = GroupLength;
+
+	if ( StreamLength - i >= 4 )
+	{
+		XLeft [ 0 ] = IvHigh32 + (BLOWFISH_ULONG)i;
+		XRight [ 0 ] = IvLow32 + (BLOWFISH_ULONG)( i + 1 );
+		XLeft [ 1 ] = IvHigh32 + (BLOWFISH_ULONG)( i + 2 );
+		XRight [ 1 ] = IvLow32 + (BLOWFISH_ULONG)( i + 3 );
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X2, 2, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( OutStream + i, _BLOWFISH_Load ( InStream + i, Swap ) ^ XLeft [ 0 ], Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, _BLOWFISH_Load ( InStream + i + 1, Swap ) ^ XRight [ 0 ], Swap );
+		_BLOWFISH_Store ( OutStream + i + 2, _BLOWFISH_Load ( InStream + i + 2, Swap ) ^ XLeft [ 1 ], Swap );
+		_BLOWFISH_Store ( OutStream + i + 3, _BLOWFISH_Load ( InStream + i + 3, Swap ) ^ XRight [ 1 ], Swap );
+
+		i += 4;
+	}
+
+	/* Process any remaining block */ 
+
+	if ( i < StreamLength )
+	{
+		XLeft [ 0 ] = IvHigh32 + (BLOWFISH_ULONG)i;
+		XRight [ 0 ] = IvLow32 + (BLOWFISH_ULONG)( i + 1 );
+
+		_BLOWFISH_ENCIPHER ( XRight [ 0 ], XLeft [ 0 ], XLeft [ 0 ], XRight [ 0 ], P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( OutStream + i, _BLOWFISH_Load ( InStream + i, Swap ) ^ XRight [ 0 ], Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, _BLOWFISH_Load ( InStream + i + 1, Swap ) ^ XLeft [ 0 ], Swap );
+	}
+
+	/* Preserve the initialisation vector added with the counter as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 += (BLOWFISH_ULONG)StreamLength;
+	Session->IvLow32 += (BLOWFISH_ULONG)( StreamLength + 1 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in counter mode with a 64-bit block counter, interleaving 4 blocks at a time.
+
+	See #_BLOWFISH_EncipherDecipherStream_CTR64 for more information.
+
+	@remarks Produces exactly the same keystream as #_BLOWFISH_EncipherDecipherStream_CTR64.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_CTR64_X4 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_ULONGLONG	Counter = (BLOWFISH_ULONGLONG)Session->IvHigh32 << 32 | Session->IvLow32;
+	BLOWFISH_ULONGLONG	Block;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		GroupLength = StreamLength & ~0x07;
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher the counters in groups of 4 blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( InStream, OutStream, Counter, P, S0, S1, S2, S3, GroupLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < GroupLength; i += 8 )
+	{
+		BLOWFISH_ULONG		GroupLeft [ 4 ];
+		BLOWFISH_ULONG		GroupRight [ 4 ];
+		BLOWFISH_ULONGLONG	GroupBlock;
+		BLOWFISH_SIZE_T		j;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			GroupBlock = Counter + (BLOWFISH_ULONGLONG)( ( i >> 1 ) + j );
+
+			GroupLeft [ j ] = (BLOWFISH_ULONG)( GroupBlock >> 32 );
+			GroupRight [ j ] = (BLOWFISH_ULONG)GroupBlock;
+		}
+
+		_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, GroupLeft, GroupRight, P, S0, S1, S2, S3 );
+
+		/* XOR the enciphered counters with the plaintext or ciphertext */ 
+
+		for ( j = 0; j < 4; j++ )
+		{
+			_BLOWFISH_Store ( OutStream + i + j * 2, _BLOWFISH_Load ( InStream + i + j * 2, Swap ) ^ GroupLeft [ j ], Swap );
+			_BLOWFISH_Store ( OutStream + i + j * 2 + 1, _BLOWFISH_Load ( InStream + i + j * 2 + 1, Swap ) ^ GroupRight [ j ], Swap );
+		}
+	}
+
+	/* Process any remaining blocks */ 
+
+	for ( i = GroupLength; i < StreamLength; i += 2 )
+	{
+		Block = Counter + (BLOWFISH_ULONGLONG)( i >> 1 );
+
+		XLeft = (BLOWFISH_ULONG)( Block >> 32 );
+		XRight = (BLOWFISH_ULONG)Block;
+
+		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+
+		_BLOWFISH_Store ( OutStream + i, _BLOWFISH_Load ( InStream + i, Swap ) ^ XRight, Swap );
+		_BLOWFISH_Store ( OutStream + i + 1, _BLOWFISH_Load ( InStream + i + 1, Swap ) ^ XLeft, Swap );
+	}
+
+	/* Preserve the counter of the next block as the new initialisation vector for stream based operations */ 
+
+	Counter += (BLOWFISH_ULONGLONG)( StreamLength >> 1 );
+
+	Session->IvHigh32 = (BLOWFISH_ULONG)( Counter >> 32 );
+	Session->IvLow32 = (BLOWFISH_ULONG)Counter;
+
+	return;
+}
+
+/** @internal Number of messages enciphered by each call to #_BLOWFISH_EncipherMulti_CBC_X4 (the unit of work shared between threads). */ 
+
+#define _BLOWFISH_MULTI_SLICE	64
+
+/**
+
+	@internal
+
+	Encipher several independent messages in cipher block chaining mode, advancing 4 chains at a time in lockstep.
+
+	See #_BLOWFISH_EncipherStream_CBC for more information.
+
+	@param KeySchedule			Pointer to an initialised key schedule.
+
+	@param BufferCount			Number of messages to encipher.
+
+	@param PlainTextBuffers		Array of pointers to the messages to encipher.
+
+	@param CipherTextBuffers	Array of pointers to buffers to receive the ciphertext.
+
+	@param BufferLengths		Array of lengths of each message in bytes.
+
+	@param IvHigh32				Array of the high 32-bits of the initialisation vector for each message.
+
+	@param IvLow32				Array of the low 32-bits of the initialisation vector for each message.
+
+	@param Swap					Non-zero to byte swap each 32-bit word as it is loaded and stored (see #BLOWFISH_SetByteOrder).
+
+	@remarks Each lane is refilled with the next message as soon as its current message is complete, so messages of different lengths keep all lanes busy.
+
+	@remarks It is an unchecked runtime error to supply either a null pointer, or a buffer length that is not a non-zero multiple of 8 to this function.
+
+  */ 
+
+static void _BLOWFISH_EncipherMulti_CBC_X4 ( BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_SIZE_T BufferCount, const BLOWFISH_PCUCHAR * PlainTextBuffers, BLOWFISH_PUCHAR * CipherTextBuffers, const BLOWFISH_SIZE_T * BufferLengths, BLOWFISH_PCULONG IvHigh32, BLOWFISH_PCULONG IvLow32, BLOWFISH_ULONG Swap )
+{
+	BLOWFISH_PCULONG	PlainText [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_PULONG		CipherText [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_SIZE_T		Remaining [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG		XLeft [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG		XRight [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_PCULONG	P = KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = KeySchedule->SBox [ 3 ];
+	BLOWFISH_SIZE_T		Next = 0;
+	BLOWFISH_SIZE_T		Active;
+	BLOWFISH_SIZE_T		j;
+
+	do
+	{
+		Active = 0;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			/* Assign the next message to an idle lane, starting its chain from the initialisation vector */ 
+
+			if ( Remaining [ j ] == 0 && Next < BufferCount )
+			{
+				PlainText [ j ] = (BLOWFISH_PCULONG)PlainTextBuffers [ Next ];
+				CipherText [ j ] = (BLOWFISH_PULONG)CipherTextBuffers [ Next ];
+				Remaining [ j ] = BufferLengths [ Next ] >> 3;
+				XLeft [ j ] = IvHigh32 [ Next ];
+				XRight [ j ] = IvLow32 [ Next ];
+
+				Next++;
+			}
+
+			/* XOR the plaintext block with the previous block of ciphertext (or initialisation vector) */ 
+
+			if ( Remaining [ j ] != 0 )
+			{
+				XLeft [ j ] ^= _BLOWFISH_Load ( PlainText [ j ], Swap );
+				XRight [ j ] ^= _BLOWFISH_Load ( PlainText [ j ] + 1, Swap );
+
+				Active++;
+			}
+		}
+
+		if ( Active != 0 )
+		{
+			/* Encipher one block from each lane (idle lanes encipher whatever they last held, which is discarded) */ 
+
+			_BLOWFISH_ENCIPHER_INTERLEAVED ( _BLOWFISH_CIPHER_X4, 4, XLeft, XRight, P, S0, S1, S2, S3 );
+
+			for ( j = 0; j < 4; j++ )
+			{
+				if ( Remaining [ j ] != 0 )
+				{
+					_BLOWFISH_Store ( CipherText [ j ], XLeft [ j ], Swap );
+					_BLOWFISH_Store ( CipherText [ j ] + 1, XRight [ j ], Swap );
+
+					PlainText [ j ] += 2;
+					CipherText [ j ] += 2;
+					Remaining [ j ]--;
+				}
+			}
+		}
+
+	} while ( Active != 0 );
+
+	return;
+}
+
+/** @internal Messages being enciphered by #BLOWFISH_EncipherBufferMulti. */ 
+
+typedef struct __BLOWFISH_MULTI
+{
+	BLOWFISH_PCKEY_SCHEDULE		KeySchedule;		/*!< Key schedule to encipher the messages with. */ 
+	BLOWFISH_SIZE_T				BufferCount;		/*!< Number of messages. */ 
+	const BLOWFISH_PCUCHAR *	PlainTextBuffers;	/*!< Array of plaintext buffers. */ 
+	BLOWFISH_PUCHAR *			CipherTextBuffers;	/*!< Array of ciphertext buffers. */ 
+	const BLOWFISH_SIZE_T *		BufferLengths;		/*!< Array of buffer lengths. */ 
+	BLOWFISH_PCULONG			IvHigh32;			/*!< Array of the high 32-bits of each initialisation vector. */ 
+	BLOWFISH_PCULONG			IvLow32;			/*!< Array of the low 32-bits of each initialisation vector. */ 
+	BLOWFISH_ULONG				Swap;				/*!< Non-zero to byte swap the messages (see #BLOWFISH_SetByteOrder). */ 
+
+} _BLOWFISH_MULTI;
+
+/**
+
+	@internal
+
+	Encipher a range of slices of the messages supplied to #BLOWFISH_EncipherBufferMulti.
+
+	@param BodyContext	Pointer to the messages (see #_BLOWFISH_MULTI).
+
+	@param Begin		Index of the first slice.
+
+	@param End			Index of the slice following the range.
+
+  */ 
+
+static void _BLOWFISH_EncipherMultiSlices ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_MULTI *	Multi = (const _BLOWFISH_MULTI *)BodyContext;
+	BLOWFISH_SIZE_T			i;
+
+	for ( i = Begin * _BLOWFISH_MULTI_SLICE; i < End * _BLOWFISH_MULTI_SLICE && i < Multi->BufferCount; i += _BLOWFISH_MULTI_SLICE )
+	{
+		_BLOWFISH_EncipherMulti_CBC_X4 ( Multi->KeySchedule, Multi->BufferCount - i < _BLOWFISH_MULTI_SLICE ? Multi->BufferCount - i : _BLOWFISH_MULTI_SLICE, Multi->PlainTextBuffers + i, Multi->CipherTextBuffers + i, Multi->BufferLengths + i, Multi->IvHigh32 + i, Multi->IvLow32 + i, Multi->Swap );
+	}
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherBufferMulti ( BLOWFISH_PCONTEXT Context, BLOWFISH_SIZE_T BufferCount, const BLOWFISH_PCUCHAR * PlainTextBuffers, BLOWFISH_PUCHAR * CipherTextBuffers, const BLOWFISH_SIZE_T * BufferLengths, BLOWFISH_PCULONG IvHigh32, BLOWFISH_PCULONG IvLow32 )
+{
+	_BLOWFISH_MULTI	Multi;
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure the context record and array pointers are non null */ 
+
+	if ( Context == 0 || PlainTextBuffers == 0 || CipherTextBuffers == 0 || BufferLengths == 0 || IvHigh32 == 0 || IvLow32 == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the message count is not negative */ 
+
+	if ( BufferCount < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	/* Validate every message before enciphering any of them */ 
+
+	for ( i = 0; i < BufferCount; i++ )
+	{
+		if ( PlainTextBuffers [ i ] == 0 || CipherTextBuffers [ i ] == 0 )
+		{
+			return BLOWFISH_RC_INVALID_PARAMETER;
+		}
+
+#ifdef _OPENMP
+
+		/* Ensure the buffer length is not negative */ 
+
+		if ( BufferLengths [ i ] < 0 )
+		{
+			return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		}
+
+#endif
+
+		if ( BufferLengths [ i ] == 0 || ( BufferLengths [ i ] & 0x07 ) != 0 )
+		{
+			return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		}
+	}
+
+	/* Encipher the messages in slices, each of which is advanced 4 messages at a time */ 
+
+	Multi.KeySchedule = &Context->KeySchedule;
+	Multi.BufferCount = BufferCount;
+	Multi.PlainTextBuffers = PlainTextBuffers;
+	Multi.CipherTextBuffers = CipherTextBuffers;
+	Multi.BufferLengths = BufferLengths;
+	Multi.IvHigh32 = IvHigh32;
+	Multi.IvLow32 = IvLow32;
+	Multi.Swap = Context->Session.SwapBytes;
+
+	_BLOWFISH_ParallelFor ( ( BufferCount + _BLOWFISH_MULTI_SLICE - 1 ) / _BLOWFISH_MULTI_SLICE, &_BLOWFISH_EncipherMultiSlices, &Multi );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher on 4 independent blocks, each with its own key schedule. See #_BLOWFISH_CIPHER_X2 for more information.
+
+	@param XLeft		Array of xL for each block.
+
+	@param XRight		Array of xR for each block.
+
+	@param KeySchedule	Array of pointers to the key schedule for each block.
+
+	@param Round		Round number.
+
+  */ 
+
+#define _BLOWFISH_CIPHER_KEYS_X4( XLeft, XRight, KeySchedule, Round )																									\
+{																																										\
+	_BLOWFISH_CIPHER ( XLeft [ 0 ], XRight [ 0 ], KeySchedule [ 0 ]->PArray, KeySchedule [ 0 ]->SBox [ 0 ], KeySchedule [ 0 ]->SBox [ 1 ], KeySchedule [ 0 ]->SBox [ 2 ], KeySchedule [ 0 ]->SBox [ 3 ], Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 1 ], XRight [ 1 ], KeySchedule [ 1 ]->PArray, KeySchedule [ 1 ]->SBox [ 0 ], KeySchedule [ 1 ]->SBox [ 1 ], KeySchedule [ 1 ]->SBox [ 2 ], KeySchedule [ 1 ]->SBox [ 3 ], Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 2 ], XRight [ 2 ], KeySchedule [ 2 ]->PArray, KeySchedule [ 2 ]->SBox [ 0 ], KeySchedule [ 2 ]->SBox [ 1 ], KeySchedule [ 2 ]->SBox [ 2 ], KeySchedule [ 2 ]->SBox [ 3 ], Round );	\
+	_BLOWFISH_CIPHER ( XLeft [ 3 ], XRight [ 3 ], KeySchedule [ 3 ]->PArray, KeySchedule [ 3 ]->SBox [ 0 ], KeySchedule [ 3 ]->SBox [ 1 ], KeySchedule [ 3 ]->SBox [ 2 ], KeySchedule [ 3 ]->SBox [ 3 ], Round );	\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round encipher on 4 independent blocks, each with its own key schedule, finalise round and unswap xL and xR.
+
+	See #_BLOWFISH_ENCIPHER_INTERLEAVED for more information.
+
+  */ 
+
+#define _BLOWFISH_ENCIPHER_KEYS_X4( XLeft, XRight, KeySchedule )												\
+{																												\
+	BLOWFISH_SIZE_T	_BLOWFISH_Lane;																				\
+	BLOWFISH_ULONG	_BLOWFISH_Swap;																				\
+																												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 0 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 1 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 2 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 3 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 4 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 5 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 6 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 7 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 8 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 9 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 10 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 11 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 12 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 13 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 14 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 15 );												\
+																												\
+	for ( _BLOWFISH_Lane = 0; _BLOWFISH_Lane < 4; _BLOWFISH_Lane++ )											\
+	{																											\
+		_BLOWFISH_Swap = XLeft [ _BLOWFISH_Lane ] ^ KeySchedule [ _BLOWFISH_Lane ]->PArray [ 16 ];				\
+		XLeft [ _BLOWFISH_Lane ] = XRight [ _BLOWFISH_Lane ] ^ KeySchedule [ _BLOWFISH_Lane ]->PArray [ 17 ];	\
+		XRight [ _BLOWFISH_Lane ] = _BLOWFISH_Swap;																\
+	}																											\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round decipher on 4 independent blocks, each with its own key schedule, finalise round and unswap xL and xR.
+
+	See #_BLOWFISH_DECIPHER for more information.
+
+  */ 
+
+#define _BLOWFISH_DECIPHER_KEYS_X4( XLeft, XRight, KeySchedule )												\
+{																												\
+	BLOWFISH_SIZE_T	_BLOWFISH_Lane;																				\
+	BLOWFISH_ULONG	_BLOWFISH_Swap;																				\
+																												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 17 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 16 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 15 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 14 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 13 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 12 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 11 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 10 );												\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 9 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 8 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 7 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 6 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 5 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 4 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule, 3 );													\
+	_BLOWFISH_CIPHER_KEYS_X4 ( XRight, XLeft, KeySchedule, 2 );													\
+																												\
+	for ( _BLOWFISH_Lane = 0; _BLOWFISH_Lane < 4; _BLOWFISH_Lane++ )											\
+	{																											\
+		_BLOWFISH_Swap = XLeft [ _BLOWFISH_Lane ] ^ KeySchedule [ _BLOWFISH_Lane ]->PArray [ 1 ];				\
+		XLeft [ _BLOWFISH_Lane ] = XRight [ _BLOWFISH_Lane ] ^ KeySchedule [ _BLOWFISH_Lane ]->PArray [ 0 ];	\
+		XRight [ _BLOWFISH_Lane ] = _BLOWFISH_Swap;																\
+	}																											\
+}
+
+/**
+
+	@internal
+
+	Expand 4 keys at once, interleaving their (otherwise strictly serial) chains of encipherments.
+
+	See #_BLOWFISH_SetKey for more information.
+
+	@param KeySchedule	Array of pointers to the key schedules to initialise.
+
+	@param Key			Array of pointers to the keys.
+
+	@param KeyLength	Array of the lengths of the keys.
+
+	@param ReturnCode	Array to receive the return code for each key (see #_BLOWFISH_SetKey).
+
+	@remarks Each chain continues in lockstep after its key is found to be weak or invalid, and the result is discarded.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+  */ 
+
+static void _BLOWFISH_SetKey_X4 ( BLOWFISH_PKEY_SCHEDULE * KeySchedule, const BLOWFISH_PCUCHAR * Key, const BLOWFISH_SIZE_T * KeyLength, BLOWFISH_RC * ReturnCode )
+{
+	BLOWFISH_ULONG	XLeft [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG	XRight [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_SIZE_T	k;
+
+	for ( k = 0; k < 4; k++ )
+	{
+		ReturnCode [ k ] = _BLOWFISH_SeedKey ( KeySchedule [ k ], Key [ k ], KeyLength [ k ] );
+	}
+
+	/* Update all entries in each P-Array with output from the continuously changing blowfish algorithm */ 
+
+	for ( i = 0; i < BLOWFISH_SUBKEYS; i += 2 )
+	{
+		_BLOWFISH_ENCIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule );
+
+		for ( k = 0; k < 4; k++ )
+		{
+			KeySchedule [ k ]->PArray [ i ] = XLeft [ k ];
+			KeySchedule [ k ]->PArray [ i + 1 ] = XRight [ k ];
+		}
+	}
+
+	/* Update all entries in each set of S-Boxes with output from the continuously changing blowfish algorithm */ 
+
+	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	{
+		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j += 2 )
+		{
+			_BLOWFISH_ENCIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule );
+
+			for ( k = 0; k < 4; k++ )
+			{
+				/* Test the strength of the key */ 
+
+				if ( XLeft [ k ] == XRight [ k ] && ReturnCode [ k ] == BLOWFISH_RC_SUCCESS )
+				{
+					ReturnCode [ k ] = BLOWFISH_RC_WEAK_KEY;
+				}
+
+				KeySchedule [ k ]->SBox [ i ] [ j ] = XLeft [ k ];
+				KeySchedule [ k ]->SBox [ i ] [ j + 1 ] = XRight [ k ];
+			}
+		}
+	}
+
+	return;
+}
+
+/** @internal Keys being expanded by #_BLOWFISH_SetKeyBatch. */ 
+
+typedef struct __BLOWFISH_KEY_BATCH
+{
+	BLOWFISH_PUCHAR				KeySchedules;	/*!< Pointer to the first key schedule. */ 
+	BLOWFISH_SIZE_T				Stride;			/*!< Distance in bytes between consecutive key schedules. */ 
+	const BLOWFISH_PCUCHAR *	Keys;			/*!< Array of keys. */ 
+	const BLOWFISH_SIZE_T *		KeyLengths;		/*!< Array of key lengths. */ 
+	BLOWFISH_RC *				ReturnCodes;	/*!< Array to receive the return code for each key. */ 
+
+} _BLOWFISH_KEY_BATCH;
+
+/**
+
+	@internal
+
+	Expand a range of groups of 4 keys supplied to #_BLOWFISH_SetKeyBatch.
+
+	@param BodyContext	Pointer to the keys (see #_BLOWFISH_KEY_BATCH).
+
+	@param Begin		Index of the first group.
+
+	@param End			Index of the group following the range.
+
+  */ 
+
+static void _BLOWFISH_SetKeyGroups ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_KEY_BATCH *	Batch = (const _BLOWFISH_KEY_BATCH *)BodyContext;
+	BLOWFISH_PKEY_SCHEDULE		KeySchedule [ 4 ];
+	BLOWFISH_SIZE_T				i;
+	BLOWFISH_SIZE_T				k;
+
+	for ( i = Begin * 4; i < End * 4; i += 4 )
+	{
+		for ( k = 0; k < 4; k++ )
+		{
+			KeySchedule [ k ] = (BLOWFISH_PKEY_SCHEDULE)( Batch->KeySchedules + ( i + k ) * Batch->Stride );
+		}
+
+		_BLOWFISH_SetKey_X4 ( KeySchedule, Batch->Keys + i, Batch->KeyLengths + i, Batch->ReturnCodes + i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Expand several keys, 4 at a time (the remaining keys are expanded singly).
+
+	@param KeySchedules	Array of key schedules to initialise.
+
+	@param Stride		Distance in bytes between consecutive key schedules (so that key schedules embedded in context records can be initialised in place).
+
+	@param Count		Number of keys.
+
+	@param Keys			Array of pointers to the keys.
+
+	@param KeyLengths	Array of the lengths of the keys.
+
+	@param ReturnCodes	Array to receive the return code for each key (see #_BLOWFISH_SetKey).
+
+	@remarks This function can be parallelised using OpenMP.
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+	@return #BLOWFISH_RC_SUCCESS if every key was expanded, otherwise the return code for the first key that was not.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_SetKeyBatch ( BLOWFISH_PUCHAR KeySchedules, BLOWFISH_SIZE_T Stride, BLOWFISH_SIZE_T Count, const BLOWFISH_PCUCHAR * Keys, const BLOWFISH_SIZE_T * KeyLengths, BLOWFISH_RC * ReturnCodes )
+{
+	_BLOWFISH_KEY_BATCH		Batch;
+	BLOWFISH_SIZE_T			Groups = Count & ~3;
+	BLOWFISH_SIZE_T			i;
+
+	/* Expand keys 4 at a time */ 
+
+	Batch.KeySchedules = KeySchedules;
+	Batch.Stride = Stride;
+	Batch.Keys = Keys;
+	Batch.KeyLengths = KeyLengths;
+	Batch.ReturnCodes = ReturnCodes;
+
+	_BLOWFISH_ParallelFor ( Groups / 4, &_BLOWFISH_SetKeyGroups, &Batch );
+
+	/* Expand the remaining keys singly */ 
+
+	for ( i = Groups; i < Count; i++ )
+	{
+		ReturnCodes [ i ] = _BLOWFISH_SetKey ( (BLOWFISH_PKEY_SCHEDULE)( KeySchedules + i * Stride ), Keys [ i ], KeyLengths [ i ] );
+	}
+
+	for ( i = 0; i < Count; i++ )
+	{
+		if ( ReturnCodes [ i ] != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCodes [ i ];
+		}
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_InitKeyScheduleBatch ( BLOWFISH_PKEY_SCHEDULE KeySchedules, BLOWFISH_SIZE_T Count, const BLOWFISH_PCUCHAR * Keys, const BLOWFISH_SIZE_T * KeyLengths, BLOWFISH_RC * ReturnCodes )
+{
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure the array pointers are non null */ 
+
+	if ( KeySchedules == 0 || Keys == 0 || KeyLengths == 0 || ReturnCodes == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the key count is not negative */ 
+
+	if ( Count < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	for ( i = 0; i < Count; i++ )
+	{
+		if ( Keys [ i ] == 0 )
+		{
+			return BLOWFISH_RC_INVALID_PARAMETER;
+		}
+	}
+
+	return _BLOWFISH_SetKeyBatch ( (BLOWFISH_PUCHAR)KeySchedules, (BLOWFISH_SIZE_T)sizeof ( *KeySchedules ), Count, Keys, KeyLengths, ReturnCodes );
+}
+
+BLOWFISH_RC BLOWFISH_InitBatch ( BLOWFISH_PCONTEXT Contexts, BLOWFISH_SIZE_T Count, const BLOWFISH_PCUCHAR * Keys, const BLOWFISH_SIZE_T * KeyLengths, BLOWFISH_MODE Mode, BLOWFISH_PCULONG IvHigh32, BLOWFISH_PCULONG IvLow32, BLOWFISH_RC * ReturnCodes )
+{
+	BLOWFISH_RC		ReturnCode;
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure the array pointers are non null (the initialisation vectors are optional) */ 
+
+	if ( Contexts == 0 || Keys == 0 || KeyLengths == 0 || ReturnCodes == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the key count is not negative */ 
+
+	if ( Count < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	/* Set the mode and initialisation vector of every context record before expanding any keys */ 
+
+	for ( i = 0; i < Count; i++ )
+	{
+		if ( Keys [ i ] == 0 )
+		{
+			return BLOWFISH_RC_INVALID_PARAMETER;
+		}
+
+		_BLOWFISH_BIND ( &Contexts [ i ] );
+
+		ReturnCode = _BLOWFISH_SetMode ( &Contexts [ i ].Session, Mode, IvHigh32 != 0 ? IvHigh32 [ i ] : 0, IvLow32 != 0 ? IvLow32 [ i ] : 0 );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	/* Expand the keys directly into the context records */ 
+
+	return _BLOWFISH_SetKeyBatch ( (BLOWFISH_PUCHAR)&Contexts [ 0 ].KeySchedule, (BLOWFISH_SIZE_T)sizeof ( *Contexts ), Count, Keys, KeyLengths, ReturnCodes );
+}
+
+/** @internal Alphabet used by bcrypt to encode the salt and hash (not the standard base64 alphabet). */ 
+
+static const char _BLOWFISH_BcryptAlphabet [ ] = "./ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+/** @internal Magic text ("OrpheanBeholderScryDoubt") enciphered 64 times by bcrypt, as 3 blocks. */ 
+
+static const BLOWFISH_ULONG _BLOWFISH_BcryptMagic [ 6 ] = { 0x4f727068, 0x65616e42, 0x65686f6c, 0x64657253, 0x63727944, 0x6f756274 };
+
+/** @internal Parameters of a single bcrypt hash. */ 
+
+typedef struct __BLOWFISH_BCRYPT
+{
+	BLOWFISH_UCHAR	Key [ BLOWFISH_BCRYPT_MAX_KEY_LENGTH ];		/*!< Password, including the terminating null if it fits. */ 
+	BLOWFISH_SIZE_T	KeyLength;									/*!< Length of the password as used by EksBlowfish. */ 
+	BLOWFISH_UCHAR	Salt [ BLOWFISH_BCRYPT_SALT_LENGTH ];		/*!< Salt. */ 
+	BLOWFISH_ULONG	SaltWords [ BLOWFISH_BCRYPT_SALT_LENGTH / 4 ];	/*!< Salt as big-endian words. */ 
+	BLOWFISH_ULONG	Cost;										/*!< Base 2 logarithm of the number of expensive key expansion rounds. */ 
+	char			Minor;										/*!< Version letter ('a', 'b' or 'y'). */ 
+
+} _BLOWFISH_BCRYPT;
+
+/**
+
+	@internal
+
+	Encode bytes with the bcrypt alphabet.
+
+	@param Output	Buffer to receive the encoded characters (4 for every 3 bytes, without padding).
+
+	@param Input	Bytes to encode.
+
+	@param Length	Number of bytes to encode.
+
+	@return Pointer to the character after the last encoded character.
+
+  */ 
+
+static char * _BLOWFISH_BcryptEncode ( char * Output, BLOWFISH_PCUCHAR Input, BLOWFISH_SIZE_T Length )
+{
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_ULONG	Bits;
+
+	for ( i = 0; i < Length; i += 3 )
+	{
+		Bits = (BLOWFISH_ULONG)Input [ i ] << 16;
+
+		if ( i + 1 < Length )
+		{
+			Bits |= (BLOWFISH_ULONG)Input [ i + 1 ] << 8;
+		}
+
+		if ( i + 2 < Length )
+		{
+			Bits |= Input [ i + 2 ];
+		}
+
+		*Output++ = _BLOWFISH_BcryptAlphabet [ ( Bits >> 18 ) & 0x3f ];
+		*Output++ = _BLOWFISH_BcryptAlphabet [ ( Bits >> 12 ) & 0x3f ];
+
+		if ( i + 1 < Length )
+		{
+			*Output++ = _BLOWFISH_BcryptAlphabet [ ( Bits >> 6 ) & 0x3f ];
+		}
+
+		if ( i + 2 < Length )
+		{
+			*Output++ = _BLOWFISH_BcryptAlphabet [ Bits & 0x3f ];
+		}
+	}
+
+	return Output;
+}
+
+/**
+
+	@internal
+
+	Decode characters encoded with the bcrypt alphabet.
+
+	@param Output	Buffer to receive the decoded bytes.
+
+	@param Length	Number of bytes to decode.
+
+	@param Input	Characters to decode.
+
+	@return #BLOWFISH_RC_SUCCESS		The characters were decoded successfully.
+
+	@return #BLOWFISH_RC_INVALID_HASH	One of the characters is not in the bcrypt alphabet.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_BcryptDecode ( BLOWFISH_PUCHAR Output, BLOWFISH_SIZE_T Length, const char * Input )
+{
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_ULONG	Bits = 0;
+	BLOWFISH_ULONG	BitCount = 0;
+	const char *	Character;
+
+	for ( i = 0, j = 0; i < Length; j++ )
+	{
+		Character = Input [ j ] != '\0' ? strchr ( _BLOWFISH_BcryptAlphabet, Input [ j ] ) : 0;
+
+		if ( Character == 0 )
+		{
+			return BLOWFISH_RC_INVALID_HASH;
+		}
+
+		Bits = ( Bits << 6 ) | (BLOWFISH_ULONG)( Character - _BLOWFISH_BcryptAlphabet );
+		BitCount += 6;
+
+		if ( BitCount >= 8 )
+		{
+			BitCount -= 8;
+
+			Output [ i++ ] = (BLOWFISH_UCHAR)( Bits >> BitCount );
+		}
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Set the parameters of a bcrypt hash.
+
+	@param Bcrypt	Pointer to the parameters to set.
+
+	@param Password	Null terminated password (only the first #BLOWFISH_BCRYPT_MAX_KEY_LENGTH bytes are used).
+
+	@param Cost		Base 2 logarithm of the number of expensive key expansion rounds.
+
+	@param Salt		Pointer to #BLOWFISH_BCRYPT_SALT_LENGTH bytes of salt.
+
+	@param Minor	Version letter.
+
+	@remarks As for $2b$, the terminating null is part of the key, and the length of the password is capped before adding it (so long passwords never wrap around).
+
+	@remarks It is an unchecked runtime error to supply a null pointer to this function.
+
+  */ 
+
+static void _BLOWFISH_BcryptSet ( _BLOWFISH_BCRYPT * Bcrypt, const char * Password, BLOWFISH_ULONG Cost, BLOWFISH_PCUCHAR Salt, char Minor )
+{
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < BLOWFISH_BCRYPT_MAX_KEY_LENGTH && Password [ i ] != '\0'; i++ )
+	{
+		Bcrypt->Key [ i ] = (BLOWFISH_UCHAR)Password [ i ];
+	}
+
+	/* Only the first 72 bytes of the key are ever read, so a key of 72 bytes plus the null behaves as 72 bytes */ 
+
+	if ( i < BLOWFISH_BCRYPT_MAX_KEY_LENGTH )
+	{
+		Bcrypt->Key [ i++ ] = 0x00;
+	}
+
+	Bcrypt->KeyLength = i;
+
+	for ( i = 0; i < BLOWFISH_BCRYPT_SALT_LENGTH; i++ )
+	{
+		Bcrypt->Salt [ i ] = Salt [ i ];
+	}
+
+	for ( i = 0; i < BLOWFISH_BCRYPT_SALT_LENGTH / 4; i++ )
+	{
+		Bcrypt->SaltWords [ i ] = (BLOWFISH_ULONG)Salt [ i * 4 ] << 24 | (BLOWFISH_ULONG)Salt [ i * 4 + 1 ] << 16 | (BLOWFISH_ULONG)Salt [ i * 4 + 2 ] << 8 | Salt [ i * 4 + 3 ];
+	}
+
+	Bcrypt->Cost = Cost;
+	Bcrypt->Minor = Minor;
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Parse a bcrypt hash string ("$2b$" followed by a 2 digit cost, "$", 22 characters of salt and 31 characters of hash).
+
+	@param Bcrypt	Pointer to receive the parameters of the hash.
+
+	@param Password	Null terminated password.
+
+	@param Hash		Null terminated hash string.
+
+	@return #BLOWFISH_RC_SUCCESS		The hash string was parsed successfully.
+
+	@return #BLOWFISH_RC_INVALID_HASH	The hash string is malformed, or the version or cost is not supported.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_BcryptParse ( _BLOWFISH_BCRYPT * Bcrypt, const char * Password, const char * Hash )
+{
+	BLOWFISH_UCHAR	Salt [ BLOWFISH_BCRYPT_SALT_LENGTH ];
+	BLOWFISH_ULONG	Cost;
+	BLOWFISH_RC		ReturnCode;
+
+	if ( strlen ( Hash ) != BLOWFISH_BCRYPT_HASH_LENGTH - 1 || Hash [ 0 ] != '$' || Hash [ 1 ] != '2' || ( Hash [ 2 ] != 'a' && Hash [ 2 ] != 'b' && Hash [ 2 ] != 'y' ) ||
+		Hash [ 3 ] != '$' || Hash [ 4 ] < '0' || Hash [ 4 ] > '9' || Hash [ 5 ] < '0' || Hash [ 5 ] > '9' || Hash [ 6 ] != '$' )
+	{
+		return BLOWFISH_RC_INVALID_HASH;
+	}
+
+	Cost = (BLOWFISH_ULONG)( Hash [ 4 ] - '0' ) * 10 + (BLOWFISH_ULONG)( Hash [ 5 ] - '0' );
+
+	if ( Cost < BLOWFISH_BCRYPT_MIN_COST || Cost > BLOWFISH_BCRYPT_MAX_COST )
+	{
+		return BLOWFISH_RC_INVALID_HASH;
+	}
+
+	ReturnCode = _BLOWFISH_BcryptDecode ( Salt, sizeof ( Salt ), Hash + 7 );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		_BLOWFISH_BcryptSet ( Bcrypt, Password, Cost, Salt, Hash [ 2 ] );
+	}
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Format a bcrypt hash string.
+
+	@param Bcrypt		Pointer to the parameters of the hash.
+
+	@param CipherText	The magic text after being enciphered 64 times.
+
+	@param Hash			Buffer of #BLOWFISH_BCRYPT_HASH_LENGTH characters to receive the null terminated hash string.
+
+  */ 
+
+static void _BLOWFISH_BcryptFormat ( const _BLOWFISH_BCRYPT * Bcrypt, BLOWFISH_PCULONG CipherText, char * Hash )
+{
+	BLOWFISH_UCHAR	Bytes [ sizeof ( _BLOWFISH_BcryptMagic ) ];
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < (BLOWFISH_SIZE_T)sizeof ( Bytes ); i++ )
+	{
+		Bytes [ i ] = (BLOWFISH_UCHAR)( CipherText [ i >> 2 ] >> ( 24 - ( i & 3 ) * 8 ) );
+	}
+
+	Hash [ 0 ] = '$';
+	Hash [ 1 ] = '2';
+	Hash [ 2 ] = Bcrypt->Minor;
+	Hash [ 3 ] = '$';
+	Hash [ 4 ] = (char)( '0' + Bcrypt->Cost / 10 );
+	Hash [ 5 ] = (char)( '0' + Bcrypt->Cost % 10 );
+	Hash [ 6 ] = '$';
+
+	/* The last byte of the hash is not encoded */ 
+
+	Hash = _BLOWFISH_BcryptEncode ( Hash + 7, Bcrypt->Salt, sizeof ( Bcrypt->Salt ) );
+	Hash = _BLOWFISH_BcryptEncode ( Hash, Bytes, sizeof ( Bytes ) - 1 );
+
+	*Hash = '\0';
+
+	_BLOWFISH_Wipe ( Bytes, (BLOWFISH_SIZE_T)sizeof ( Bytes ) );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Expand a key (and optionally a salt) into an existing key schedule, as EksBlowfish's ExpandKey.
+
+	@param KeySchedule	Pointer to the key schedule.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key.
+
+	@param Salt			Salt as 4 big-endian words, XOR'd into the data before each encipher (may be null for no salt).
+
+	@remarks Unlike #_BLOWFISH_SetKey, the P-Array and S-Boxes are not reset first, and no keys are rejected as weak.
+
+  */ 
+
+static void _BLOWFISH_EksExpandKey ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_PCULONG Salt )
+{
+	BLOWFISH_ULONG	XLeft = 0;
+	BLOWFISH_ULONG	XRight = 0;
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_SIZE_T	n = 0;
+
+	_BLOWFISH_MixKey ( KeySchedule, Key, KeyLength );
+
+	for ( i = 0; i < BLOWFISH_SUBKEYS; i += 2, n += 2 )
+	{
+		if ( Salt != 0 )
+		{
+			XLeft ^= Salt [ n & 3 ];
+			XRight ^= Salt [ ( n + 1 ) & 3 ];
+		}
+
+		_BLOWFISH_EncipherBlock ( KeySchedule, &XLeft, &XRight );
+
+		KeySchedule->PArray [ i ] = XLeft;
+		KeySchedule->PArray [ i + 1 ] = XRight;
+	}
+
+	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	{
+		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j += 2, n += 2 )
+		{
+			if ( Salt != 0 )
+			{
+				XLeft ^= Salt [ n & 3 ];
+				XRight ^= Salt [ ( n + 1 ) & 3 ];
+			}
+
+			_BLOWFISH_EncipherBlock ( KeySchedule, &XLeft, &XRight );
+
+			KeySchedule->SBox [ i ] [ j ] = XLeft;
+			KeySchedule->SBox [ i ] [ j + 1 ] = XRight;
+		}
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Expand 4 keys (and optionally salts) into 4 existing key schedules, interleaving their chains of encipherments.
+
+	See #_BLOWFISH_EksExpandKey for more information.
+
+  */ 
+
+static void _BLOWFISH_EksExpandKey_X4 ( BLOWFISH_PKEY_SCHEDULE * KeySchedule, const BLOWFISH_PCUCHAR * Key, const BLOWFISH_SIZE_T * KeyLength, const BLOWFISH_PCULONG * Salt )
+{
+	BLOWFISH_ULONG	XLeft [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG	XRight [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_SIZE_T	i;
+	BLOWFISH_SIZE_T	j;
+	BLOWFISH_SIZE_T	k;
+	BLOWFISH_SIZE_T	n = 0;
+
+	for ( k = 0; k < 4; k++ )
+	{
+		_BLOWFISH_MixKey ( KeySchedule [ k ], Key [ k ], KeyLength [ k ] );
+	}
+
+	for ( i = 0; i < BLOWFISH_SUBKEYS; i += 2, n += 2 )
+	{
+		for ( k = 0; k < 4 && Salt != 0; k++ )
+		{
+			XLeft [ k ] ^= Salt [ k ] [ n & 3 ];
+			XRight [ k ] ^= Salt [ k ] [ ( n + 1 ) & 3 ];
+		}
+
+		_BLOWFISH_ENCIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule );
+
+		for ( k = 0; k < 4; k++ )
+		{
+			KeySchedule [ k ]->PArray [ i ] = XLeft [ k ];
+			KeySchedule [ k ]->PArray [ i + 1 ] = XRight [ k ];
+		}
+	}
+
+	for ( i = 0; i < BLOWFISH_SBOXES; i++ )
+	{
+		for ( j = 0; j < BLOWFISH_SBOX_ENTRIES; j += 2, n += 2 )
+		{
+			for ( k = 0; k < 4 && Salt != 0; k++ )
+			{
+				XLeft [ k ] ^= Salt [ k ] [ n & 3 ];
+				XRight [ k ] ^= Salt [ k ] [ ( n + 1 ) & 3 ];
+			}
+
+			_BLOWFISH_ENCIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule );
+
+			for ( k = 0; k < 4; k++ )
+			{
+				KeySchedule [ k ]->SBox [ i ] [ j ] = XLeft [ k ];
+				KeySchedule [ k ]->SBox [ i ] [ j + 1 ] = XRight [ k ];
+			}
+		}
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Compute a bcrypt hash string.
+
+	@param Bcrypt		Pointer to the parameters of the hash.
+
+	@param KeySchedule	Pointer to a key schedule to use for EksBlowfish (overwritten before returning).
+
+	@param Hash			Buffer of #BLOWFISH_BCRYPT_HASH_LENGTH characters to receive the null terminated hash string.
+
+  */ 
+
+static void _BLOWFISH_Bcrypt ( const _BLOWFISH_BCRYPT * Bcrypt, BLOWFISH_PKEY_SCHEDULE KeySchedule, char * Hash )
+{
+	BLOWFISH_ULONG	CipherText [ 6 ];
+	BLOWFISH_ULONG	Rounds = (BLOWFISH_ULONG)1 << Bcrypt->Cost;
+	BLOWFISH_ULONG	r;
+	BLOWFISH_SIZE_T	i;
+
+	/* EksBlowfishSetup */ 
+
+	_BLOWFISH_CopyOriginal ( KeySchedule );
+
+	_BLOWFISH_EksExpandKey ( KeySchedule, Bcrypt->Key, Bcrypt->KeyLength, Bcrypt->SaltWords );
+
+	for ( r = 0; r < Rounds; r++ )
+	{
+		_BLOWFISH_EksExpandKey ( KeySchedule, Bcrypt->Key, Bcrypt->KeyLength, 0 );
+		_BLOWFISH_EksExpandKey ( KeySchedule, Bcrypt->Salt, sizeof ( Bcrypt->Salt ), 0 );
+	}
+
+	/* Encipher the magic text 64 times */ 
+
+	for ( i = 0; i < 6; i++ )
+	{
+		CipherText [ i ] = _BLOWFISH_BcryptMagic [ i ];
+	}
+
+	for ( r = 0; r < 64; r++ )
+	{
+		for ( i = 0; i < 6; i += 2 )
+		{
+			_BLOWFISH_EncipherBlock ( KeySchedule, &CipherText [ i ], &CipherText [ i + 1 ] );
+		}
+	}
+
+	_BLOWFISH_BcryptFormat ( Bcrypt, CipherText, Hash );
+
+	_BLOWFISH_Wipe ( CipherText, (BLOWFISH_SIZE_T)sizeof ( CipherText ) );
+	_BLOWFISH_Wipe ( KeySchedule, (BLOWFISH_SIZE_T)sizeof ( *KeySchedule ) );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Compute 4 bcrypt hash strings with the same cost, interleaving the 4 EksBlowfish computations.
+
+	See #_BLOWFISH_Bcrypt for more information.
+
+	@param Bcrypt	Array of pointers to the parameters of each hash (all with the same cost).
+
+	@param Hash		Array of buffers to receive the hash strings.
+
+  */ 
+
+static void _BLOWFISH_Bcrypt_X4 ( const _BLOWFISH_BCRYPT * const * Bcrypt, char ( * Hash ) [ BLOWFISH_BCRYPT_HASH_LENGTH ] )
+{
+	BLOWFISH_KEY_SCHEDULE	KeySchedules [ 4 ];
+	BLOWFISH_PKEY_SCHEDULE	KeySchedule [ 4 ];
+	BLOWFISH_PCUCHAR		Key [ 4 ];
+	BLOWFISH_SIZE_T			KeyLength [ 4 ];
+	BLOWFISH_PCUCHAR		Salt [ 4 ];
+	BLOWFISH_SIZE_T			SaltLength [ 4 ];
+	BLOWFISH_PCULONG		SaltWords [ 4 ];
+	BLOWFISH_ULONG			CipherText [ 6 ] [ 4 ];
+	BLOWFISH_ULONG			Rounds = (BLOWFISH_ULONG)1 << Bcrypt [ 0 ]->Cost;
+	BLOWFISH_ULONG			r;
+	BLOWFISH_ULONG			Lane [ 6 ];
+	BLOWFISH_SIZE_T			i;
+	BLOWFISH_SIZE_T			k;
+
+	for ( k = 0; k < 4; k++ )
+	{
+		KeySchedule [ k ] = &KeySchedules [ k ];
+		Key [ k ] = Bcrypt [ k ]->Key;
+		KeyLength [ k ] = Bcrypt [ k ]->KeyLength;
+		Salt [ k ] = Bcrypt [ k ]->Salt;
+		SaltLength [ k ] = sizeof ( Bcrypt [ k ]->Salt );
+		SaltWords [ k ] = Bcrypt [ k ]->SaltWords;
+
+		_BLOWFISH_CopyOriginal ( KeySchedule [ k ] );
+
+		for ( i = 0; i < 6; i++ )
+		{
+			CipherText [ i ] [ k ] = _BLOWFISH_BcryptMagic [ i ];
+		}
+	}
+
+	/* EksBlowfishSetup */ 
+
+	_BLOWFISH_EksExpandKey_X4 ( KeySchedule, Key, KeyLength, SaltWords );
+
+	for ( r = 0; r < Rounds; r++ )
+	{
+		_BLOWFISH_EksExpandKey_X4 ( KeySchedule, Key, KeyLength, 0 );
+		_BLOWFISH_EksExpandKey_X4 ( KeySchedule, Salt, SaltLength, 0 );
+	}
+
+	/* Encipher the magic text 64 times */ 
+
+	for ( r = 0; r < 64; r++ )
+	{
+		for ( i = 0; i < 6; i += 2 )
+		{
+			_BLOWFISH_ENCIPHER_KEYS_X4 ( CipherText [ i ], CipherText [ i + 1 ], KeySchedule );
+		}
+	}
+
+	for ( k = 0; k < 4; k++ )
+	{
+		for ( i = 0; i < 6; i++ )
+		{
+			Lane [ i ] = CipherText [ i ] [ k ];
+		}
+
+		_BLOWFISH_BcryptFormat ( Bcrypt [ k ], Lane, Hash [ k ] );
+	}
+
+	_BLOWFISH_Wipe ( Lane, (BLOWFISH_SIZE_T)sizeof ( Lane ) );
+	_BLOWFISH_Wipe ( CipherText, (BLOWFISH_SIZE_T)sizeof ( CipherText ) );
+	_BLOWFISH_Wipe ( KeySchedules, (BLOWFISH_SIZE_T)sizeof ( KeySchedules ) );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Compare two null terminated strings of the same length without an early exit.
+
+	@return Non-zero if the strings are equal.
+
+  */ 
+
+static int _BLOWFISH_BcryptEqual ( const char * Left, const char * Right )
+{
+	BLOWFISH_SIZE_T	i;
+	int				Difference = 0;
+
+	for ( i = 0; Left [ i ] != '\0' && Right [ i ] != '\0'; i++ )
+	{
+		Difference |= Left [ i ] ^ Right [ i ];
+	}
+
+	return Difference == 0 && Left [ i ] == Right [ i ];
+}
+
+BLOWFISH_RC BLOWFISH_EksBlowfishSetup ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_ULONG Cost, BLOWFISH_PCUCHAR Salt, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength )
+{
+	BLOWFISH_ULONG	SaltWords [ BLOWFISH_BCRYPT_SALT_LENGTH / 4 ];
+	BLOWFISH_ULONG	Rounds;
+	BLOWFISH_ULONG	r;
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure pointers are valid */ 
+
+	if ( KeySchedule == 0 || Salt == 0 || Key == 0 || Cost < BLOWFISH_BCRYPT_MIN_COST || Cost > BLOWFISH_BCRYPT_MAX_COST )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ensure the key length is valid (bytes beyond the first 72 are never read) */ 
+
+	if ( KeyLength < 1 )
+	{
+		return BLOWFISH_RC_INVALID_KEY;
+	}
+
+	KeyLength = KeyLength > BLOWFISH_BCRYPT_MAX_KEY_LENGTH ? BLOWFISH_BCRYPT_MAX_KEY_LENGTH : KeyLength;
+
+	for ( i = 0; i < BLOWFISH_BCRYPT_SALT_LENGTH / 4; i++ )
+	{
+		SaltWords [ i ] = (BLOWFISH_ULONG)Salt [ i * 4 ] << 24 | (BLOWFISH_ULONG)Salt [ i * 4 + 1 ] << 16 | (BLOWFISH_ULONG)Salt [ i * 4 + 2 ] << 8 | Salt [ i * 4 + 3 ];
+	}
+
+	_BLOWFISH_CopyOriginal ( KeySchedule );
+
+	_BLOWFISH_EksExpandKey ( KeySchedule, Key, KeyLength, SaltWords );
+
+	for ( r = 0, Rounds = (BLOWFISH_ULONG)1 << Cost; r < Rounds; r++ )
+	{
+		_BLOWFISH_EksExpandKey ( KeySchedule, Key, KeyLength, 0 );
+		_BLOWFISH_EksExpandKey ( KeySchedule, Salt, BLOWFISH_BCRYPT_SALT_LENGTH, 0 );
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_BcryptHash ( const char * Password, BLOWFISH_ULONG Cost, BLOWFISH_PCUCHAR Salt, char * Hash )
+{
+	_BLOWFISH_BCRYPT		Bcrypt;
+	BLOWFISH_KEY_SCHEDULE	KeySchedule;
+
+	/* Ensure pointers and the cost are valid */ 
+
+	if ( Password == 0 || Salt == 0 || Hash == 0 || Cost < BLOWFISH_BCRYPT_MIN_COST || Cost > BLOWFISH_BCRYPT_MAX_COST )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BcryptSet ( &Bcrypt, Password, Cost, Salt, 'b' );
+
+	_BLOWFISH_Bcrypt ( &Bcrypt, &KeySchedule, Hash );
+
+	_BLOWFISH_Wipe ( &Bcrypt, (BLOWFISH_SIZE_T)sizeof ( Bcrypt ) );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_BcryptVerify ( const char * Password, const char * Hash )
+{
+	BLOWFISH_RC				ReturnCode;
+	_BLOWFISH_BCRYPT		Bcrypt;
+	BLOWFISH_KEY_SCHEDULE	KeySchedule;
+	char					Computed [ BLOWFISH_BCRYPT_HASH_LENGTH ];
+
+	/* Ensure pointers are valid */ 
+
+	if ( Password == 0 || Hash == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	ReturnCode = _BLOWFISH_BcryptParse ( &Bcrypt, Password, Hash );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		_BLOWFISH_Bcrypt ( &Bcrypt, &KeySchedule, Computed );
+
+		ReturnCode = _BLOWFISH_BcryptEqual ( Computed, Hash ) ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_HASH_MISMATCH;
+
+		_BLOWFISH_Wipe ( &Bcrypt, (BLOWFISH_SIZE_T)sizeof ( Bcrypt ) );
+	}
+
+	return ReturnCode;
+}
+
+/** @internal Hashes being verified by #BLOWFISH_BcryptVerifyBatch. */ 
+
+typedef struct __BLOWFISH_BCRYPT_BATCH
+{
+	BLOWFISH_SIZE_T			Count;			/*!< Number of passwords. */ 
+	const char * const *	Passwords;		/*!< Array of passwords. */ 
+	const char * const *	Hashes;			/*!< Array of hashes. */ 
+	BLOWFISH_RC *			ReturnCodes;	/*!< Array to receive the return code for each password. */ 
+
+} _BLOWFISH_BCRYPT_BATCH;
+
+/**
+
+	@internal
+
+	Verify a range of groups of 4 passwords supplied to #BLOWFISH_BcryptVerifyBatch, interleaving each group if every hash in it is valid and has the same cost.
+
+	@param BodyContext	Pointer to the passwords (see #_BLOWFISH_BCRYPT_BATCH).
+
+	@param Begin		Index of the first group.
+
+	@param End			Index of the group following the range.
+
+  */ 
+
+static void _BLOWFISH_BcryptVerifyGroups ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_BCRYPT_BATCH *	Batch = (const _BLOWFISH_BCRYPT_BATCH *)BodyContext;
+	_BLOWFISH_BCRYPT				Bcrypt [ 4 ];
+	const _BLOWFISH_BCRYPT *		Lanes [ 4 ];
+	BLOWFISH_KEY_SCHEDULE			KeySchedule;
+	char							Computed [ 4 ] [ BLOWFISH_BCRYPT_HASH_LENGTH ];
+	BLOWFISH_SIZE_T					i;
+	BLOWFISH_SIZE_T					k;
+	BLOWFISH_SIZE_T					Lanes4;
+
+	for ( i = Begin * 4; i < End * 4 && i < Batch->Count; i += 4 )
+	{
+		for ( k = 0, Lanes4 = Batch->Count - i >= 4; k < 4 && i + k < Batch->Count; k++ )
+		{
+			Batch->ReturnCodes [ i + k ] = Batch->Passwords [ i + k ] == 0 || Batch->Hashes [ i + k ] == 0 ? BLOWFISH_RC_INVALID_PARAMETER : _BLOWFISH_BcryptParse ( &Bcrypt [ k ], Batch->Passwords [ i + k ], Batch->Hashes [ i + k ] );
+
+			Lanes [ k ] = &Bcrypt [ k ];
+
+			Lanes4 = Lanes4 && Batch->ReturnCodes [ i + k ] == BLOWFISH_RC_SUCCESS && Bcrypt [ k ].Cost == Bcrypt [ 0 ].Cost;
+		}
+
+		if ( Lanes4 )
+		{
+			_BLOWFISH_Bcrypt_X4 ( Lanes, Computed );
+		}
+
+		for ( k = 0; k < 4 && i + k < Batch->Count; k++ )
+		{
+			if ( Batch->ReturnCodes [ i + k ] == BLOWFISH_RC_SUCCESS )
+			{
+				if ( !Lanes4 )
+				{
+					_BLOWFISH_Bcrypt ( &Bcrypt [ k ], &KeySchedule, Computed [ k ] );
+				}
+
+				Batch->ReturnCodes [ i + k ] = _BLOWFISH_BcryptEqual ( Computed [ k ], Batch->Hashes [ i + k ] ) ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_HASH_MISMATCH;
+			}
+		}
+
+		_BLOWFISH_Wipe ( Bcrypt, (BLOWFISH_SIZE_T)sizeof ( Bcrypt ) );
+	}
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_BcryptVerifyBatch ( BLOWFISH_SIZE_T Count, const char * const * Passwords, const char * const * Hashes, BLOWFISH_RC * ReturnCodes )
+{
+	_BLOWFISH_BCRYPT_BATCH	Batch;
+	BLOWFISH_SIZE_T			i;
+
+	/* Ensure the array pointers are non null */ 
+
+	if ( Passwords == 0 || Hashes == 0 || ReturnCodes == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the password count is not negative */ 
+
+	if ( Count < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	/* Verify hashes in groups of 4 */ 
+
+	Batch.Count = Count;
+	Batch.Passwords = Passwords;
+	Batch.Hashes = Hashes;
+	Batch.ReturnCodes = ReturnCodes;
+
+	_BLOWFISH_ParallelFor ( ( Count + 3 ) / 4, &_BLOWFISH_BcryptVerifyGroups, &Batch );
+
+	for ( i = 0; i < Count; i++ )
+	{
+		if ( ReturnCodes [ i ] != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCodes [ i ];
+		}
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Validate a job, and retrieve the session record it is processed with.
+
+	@param Job		Pointer to a job record.
+
+	@param Session	Pointer to a variable to receive the session record (bound to the job's context record, if any).
+
+	@return #BLOWFISH_RC_SUCCESS if the job can be processed, otherwise the return code the equivalent buffer function would return.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_CheckJob ( BLOWFISH_PJOB Job, BLOWFISH_PSESSION * Session )
+{
+	/* Ensure the context or session record and buffer pointers are non null */ 
+
+	if ( Job->Session != 0 )
+	{
+		*Session = Job->Session;
+	}
+	else if ( Job->Context != 0 )
+	{
+		_BLOWFISH_BIND ( Job->Context );
+
+		*Session = &Job->Context->Session;
+	}
+	else
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	if ( Job->InBuffer == 0 || Job->OutBuffer == 0 || ( Job->Operation != BLOWFISH_OPERATION_ENCIPHER && Job->Operation != BLOWFISH_OPERATION_DECIPHER ) )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Ensure the buffer length is a non-zero multiple of 8 (or at least 8 when stealing ciphertext) */ 
+
+	if ( ( *Session )->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		if ( Job->BufferLength < 8 )
+		{
+			return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		}
+	}
+	else if ( Job->BufferLength == 0 || ( Job->BufferLength & 0x07 ) != 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#ifdef _OPENMP
+
+	if ( Job->BufferLength < 0 )
+	{
+		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	}
+
+#endif
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Encipher/decipher the buffer of a validated job as #BLOWFISH_EncipherSessionBuffer/#BLOWFISH_DecipherSessionBuffer would.
+
+	@param Job		Pointer to a job record validated by #_BLOWFISH_CheckJob.
+
+	@param Session	Pointer to the session record returned by #_BLOWFISH_CheckJob.
+
+  */ 
+
+static void _BLOWFISH_RunJob ( BLOWFISH_PJOB Job, BLOWFISH_PSESSION Session )
+{
+	_BLOWFISH_BEGINSTREAM ( Session );
+
+	if ( Session->Mode == BLOWFISH_MODE_CBC_CS3 )
+	{
+		if ( Job->Operation == BLOWFISH_OPERATION_ENCIPHER )
+		{
+			_BLOWFISH_EncipherBuffer_CBC_CS3 ( Session, Job->InBuffer, Job->OutBuffer, Job->BufferLength );
+		}
+		else
+		{
+			_BLOWFISH_DecipherBuffer_CBC_CS3 ( Session, Job->InBuffer, Job->OutBuffer, Job->BufferLength );
+		}
+	}
+	else if ( Session->Mode == BLOWFISH_MODE_CBC_LANES )
+	{
+		_BLOWFISH_CipherBuffer_CBC_LANES ( Session, Job->Operation == BLOWFISH_OPERATION_DECIPHER, Job->InBuffer, Job->OutBuffer, Job->BufferLength );
+	}
+	else if ( Job->Operation == BLOWFISH_OPERATION_ENCIPHER )
+	{
+		_BLOWFISH_CallStream ( Session, Session->EncipherStream, 0, (BLOWFISH_PCULONG)Job->InBuffer, (BLOWFISH_PULONG)Job->OutBuffer, Job->BufferLength >> 2 );
+	}
+	else
+	{
+		_BLOWFISH_CallStream ( Session, Session->DecipherStream, 1, (BLOWFISH_PCULONG)Job->InBuffer, (BLOWFISH_PULONG)Job->OutBuffer, Job->BufferLength >> 2 );
+	}
+
+	_BLOWFISH_ENDSTREAM ( Session );
+
+	return;
+}
+
+/** @internal Number of jobs in each unit of work shared between threads by #BLOWFISH_ProcessBatch, and taken from a job queue at a time by #BLOWFISH_ServiceJobQueue. */ 
+
+#define _BLOWFISH_BATCH_SLICE	32
+
+/**
+
+	@internal
+
+	Encipher the buffers of several jobs in cipher block chaining mode, advancing 4 chains at a time in lockstep, each with its own key schedule.
+
+	See #_BLOWFISH_EncipherMulti_CBC_X4 for more information.
+
+	@param Jobs		Array of pointers to the jobs, validated by #_BLOWFISH_CheckJob.
+
+	@param Sessions	Array of pointers to the session record of each job.
+
+	@param JobCount	Number of jobs.
+
+  */ 
+
+static void _BLOWFISH_EncipherJobs_CBC_X4 ( const BLOWFISH_PJOB * Jobs, const BLOWFISH_PSESSION * Sessions, BLOWFISH_SIZE_T JobCount )
+{
+	BLOWFISH_PCKEY_SCHEDULE	KeySchedule [ 4 ];
+	BLOWFISH_PCULONG		PlainText [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_PULONG			CipherText [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_SIZE_T			Remaining [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG			XLeft [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG			XRight [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_ULONG			Swap [ 4 ] = { 0, 0, 0, 0 };
+	BLOWFISH_SIZE_T			Next = 0;
+	BLOWFISH_SIZE_T			Active;
+	BLOWFISH_SIZE_T			j;
+
+	/* Idle lanes encipher with the first job's key schedule (their output is discarded) */ 
+
+	for ( j = 0; j < 4; j++ )
+	{
+		KeySchedule [ j ] = Sessions [ 0 ]->KeySchedule;
+	}
+
+	do
+	{
+		Active = 0;
+
+		for ( j = 0; j < 4; j++ )
+		{
+			/* Assign the next job to an idle lane, starting its chain from the original initialisation vector */ 
+
+			if ( Remaining [ j ] == 0 && Next < JobCount )
+			{
+				KeySchedule [ j ] = Sessions [ Next ]->KeySchedule;
+				PlainText [ j ] = (BLOWFISH_PCULONG)Jobs [ Next ]->InBuffer;
+				CipherText [ j ] = (BLOWFISH_PULONG)Jobs [ Next ]->OutBuffer;
+				Remaining [ j ] = Jobs [ Next ]->BufferLength >> 3;
+				XLeft [ j ] = Sessions [ Next ]->OriginalIvHigh32;
+				XRight [ j ] = Sessions [ Next ]->OriginalIvLow32;
+				Swap [ j ] = Sessions [ Next ]->SwapBytes;
+
+				Next++;
+			}
+
+			if ( Remaining [ j ] != 0 )
+			{
+				XLeft [ j ] ^= _BLOWFISH_Load ( PlainText [ j ], Swap [ j ] );
+				XRight [ j ] ^= _BLOWFISH_Load ( PlainText [ j ] + 1, Swap [ j ] );
+
+				Active++;
+			}
+		}
+
+		if ( Active != 0 )
+		{
+			_BLOWFISH_ENCIPHER_KEYS_X4 ( XLeft, XRight, KeySchedule );
+
+			for ( j = 0; j < 4; j++ )
+			{
+				if ( Remaining [ j ] != 0 )
+				{
+					_BLOWFISH_Store ( CipherText [ j ], XLeft [ j ], Swap [ j ] );
+					_BLOWFISH_Store ( CipherText [ j ] + 1, XRight [ j ], Swap [ j ] );
+
+					PlainText [ j ] += 2;
+					CipherText [ j ] += 2;
+					Remaining [ j ]--;
+				}
+			}
+		}
+
+	} while ( Active != 0 );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Process several validated jobs, enciphering those in cipher block chaining mode together.
+
+	@param Jobs			Array of pointers to the jobs.
+
+	@param ReturnCodes	Array to receive the return code for each job (the return code of the job records is not written).
+
+	@param JobCount		Number of jobs (at most #_BLOWFISH_BATCH_SLICE).
+
+  */ 
+
+static void _BLOWFISH_ProcessJobs ( const BLOWFISH_PJOB * Jobs, BLOWFISH_RC * ReturnCodes, BLOWFISH_SIZE_T JobCount )
+{
+	BLOWFISH_PJOB		Chained [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_PSESSION	Sessions [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_PSESSION	Session = 0;
+	BLOWFISH_SIZE_T		Count = 0;
+	BLOWFISH_SIZE_T		j;
+
+	/* Process each job, setting aside those enciphered in cipher block chaining mode */ 
+
+	for ( j = 0; j < JobCount; j++ )
+	{
+		ReturnCodes [ j ] = _BLOWFISH_CheckJob ( Jobs [ j ], &Session );
+
+		if ( ReturnCodes [ j ] != BLOWFISH_RC_SUCCESS )
+		{
+			continue;
+		}
+
+		if ( Jobs [ j ]->Operation == BLOWFISH_OPERATION_ENCIPHER && Session->Mode == BLOWFISH_MODE_CBC )
+		{
+			Chained [ Count ] = Jobs [ j ];
+			Sessions [ Count ] = Session;
+			Count++;
+		}
+		else
+		{
+			_BLOWFISH_RunJob ( Jobs [ j ], Session );
+		}
+	}
+
+	/* Encipher the chained jobs together */ 
+
+	if ( Count != 0 )
+	{
+		_BLOWFISH_EncipherJobs_CBC_X4 ( Chained, Sessions, Count );
+
+		for ( j = 0; j < Count; j++ )
+		{
+			Sessions [ j ]->Threads = 1;
+
+			_BLOWFISH_ENDSTREAM ( Sessions [ j ] );
+		}
+	}
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_InitJobQueue ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_PJOB_QUEUE_SLOT Slots, BLOWFISH_SIZE_T SlotCount )
+{
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure pointers are valid, and the slot count is a power of 2 that positions can wrap around */ 
+
+	if ( Queue == 0 || Slots == 0 || SlotCount <= 0 || ( SlotCount & ( SlotCount - 1 ) ) != 0 || ( ( SlotCount - 1 ) >> 31 ) != 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_Wipe ( Queue, (BLOWFISH_SIZE_T)sizeof ( *Queue ) );
+
+	/* Each slot is first written at its own index */ 
+
+	for ( i = 0; i < SlotCount; i++ )
+	{
+		Slots [ i ].Sequence = (BLOWFISH_ULONG)i;
+		Slots [ i ].Job = 0;
+	}
+
+	Queue->Slots = Slots;
+	Queue->SlotMask = (BLOWFISH_ULONG)( SlotCount - 1 );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_SubmitJob ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_PJOB Job )
+{
+	BLOWFISH_PJOB_QUEUE_SLOT	Slot;
+	BLOWFISH_ULONG				Position;
+	int							Distance;
+
+	/* Ensure the job queue and job pointers are valid */ 
+
+	if ( Queue == 0 || Job == 0 || ( Job->Operation != BLOWFISH_OPERATION_ENCIPHER && Job->Operation != BLOWFISH_OPERATION_DECIPHER ) )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Claim the slot at the head, unless the worker that last read it has not yet released it */ 
+
+	Position = _BLOWFISH_ATOMIC_LOAD ( Queue->Head );
+
+	for ( ;; )
+	{
+		Slot = &Queue->Slots [ Position & Queue->SlotMask ];
+		Distance = (int)( _BLOWFISH_ATOMIC_LOAD ( Slot->Sequence ) - Position );
+
+		if ( Distance == 0 )
+		{
+			if ( _BLOWFISH_ATOMIC_CAS ( Queue->Head, Position, Position + 1 ) )
+			{
+				break;
+			}
+		}
+		else if ( Distance < 0 )
+		{
+			return BLOWFISH_RC_QUEUE_FULL;
+		}
+
+		Position = _BLOWFISH_ATOMIC_LOAD ( Queue->Head );
+	}
+
+	/* Publish the job to workers (it is only marked pending once a slot has been claimed, so a job rejected as the queue is full is never left pending) */ 
+
+	Job->ReturnCode = BLOWFISH_RC_PENDING;
+
+	Slot->Job = Job;
+
+	_BLOWFISH_ATOMIC_STORE ( Slot->Sequence, Position + 1 );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Take the job at the tail of a job queue.
+
+	@param Queue	Pointer to an initialised job queue record.
+
+	@return Pointer to the job record, or null if the queue is empty.
+
+  */ 
+
+static BLOWFISH_PJOB _BLOWFISH_TakeJob ( BLOWFISH_PJOB_QUEUE Queue )
+{
+	BLOWFISH_PJOB_QUEUE_SLOT	Slot;
+	BLOWFISH_PJOB				Job;
+	BLOWFISH_ULONG				Position = _BLOWFISH_ATOMIC_LOAD ( Queue->Tail );
+	int							Distance;
+
+	for ( ;; )
+	{
+		Slot = &Queue->Slots [ Position & Queue->SlotMask ];
+		Distance = (int)( _BLOWFISH_ATOMIC_LOAD ( Slot->Sequence ) - ( Position + 1 ) );
+
+		if ( Distance == 0 )
+		{
+			if ( _BLOWFISH_ATOMIC_CAS ( Queue->Tail, Position, Position + 1 ) )
+			{
+				break;
+			}
+		}
+		else if ( Distance < 0 )
+		{
+			return 0;
+		}
+
+		Position = _BLOWFISH_ATOMIC_LOAD ( Queue->Tail );
+	}
+
+	/* Release the slot to be written again once the queue has wrapped around */ 
+
+	Job = Slot->Job;
+
+	_BLOWFISH_ATOMIC_STORE ( Slot->Sequence, Position + Queue->SlotMask + 1 );
+
+	return Job;
+}
+
+BLOWFISH_SIZE_T BLOWFISH_ServiceJobQueue ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_SIZE_T MaxJobs )
+{
+	BLOWFISH_PJOB		Taken [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_RC			ReturnCodes [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_SIZE_T		Count;
+	BLOWFISH_SIZE_T		Jobs = 0;
+	BLOWFISH_SIZE_T		j;
+
+	if ( Queue == 0 )
+	{
+		return 0;
+	}
+
+	do
+	{
+		/* Take the jobs that are ready, up to a slice at a time, so that those enciphered in cipher block chaining mode are processed together */ 
+
+		for ( Count = 0; Count < _BLOWFISH_BATCH_SLICE && ( MaxJobs == 0 || Jobs + Count < MaxJobs ) && ( Taken [ Count ] = _BLOWFISH_TakeJob ( Queue ) ) != 0; Count++ )
+		{
+		}
+
+		_BLOWFISH_ProcessJobs ( Taken, ReturnCodes, Count );
+
+		/* Complete the jobs (the submitting thread may reuse a job record as soon as this is visible) */ 
+
+		for ( j = 0; j < Count; j++ )
+		{
+			_BLOWFISH_ATOMIC_STORE ( Taken [ j ]->ReturnCode, ReturnCodes [ j ] );
+		}
+
+		Jobs += Count;
+
+	} while ( Count == _BLOWFISH_BATCH_SLICE );
+
+	return Jobs;
+}
+
+BLOWFISH_RC BLOWFISH_PollJob ( const BLOWFISH_JOB * Job )
+{
+	if ( Job == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	return _BLOWFISH_ATOMIC_LOAD ( Job->ReturnCode );
+}
+
+BLOWFISH_RC BLOWFISH_WaitJob ( BLOWFISH_PJOB_QUEUE Queue, const BLOWFISH_JOB * Job )
+{
+	BLOWFISH_RC	ReturnCode;
+
+	if ( Queue == 0 || Job == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	/* Help process the queue until the job completes, pausing while another thread finishes it */ 
+
+	while ( ( ReturnCode = _BLOWFISH_ATOMIC_LOAD ( Job->ReturnCode ) ) == BLOWFISH_RC_PENDING )
+	{
+		if ( BLOWFISH_ServiceJobQueue ( Queue, 1 ) == 0 )
+		{
+			_BLOWFISH_SPIN_PAUSE ( );
+		}
+	}
+
+	return ReturnCode;
+}
+
+/** @internal Jobs being processed by #BLOWFISH_ProcessBatch. */ 
+
+typedef struct __BLOWFISH_BATCH
+{
+	BLOWFISH_PJOB	Jobs;		/*!< Array of jobs. */ 
+	BLOWFISH_SIZE_T	JobCount;	/*!< Number of jobs. */ 
+
+} _BLOWFISH_BATCH;
+
+/**
+
+	@internal
+
+	Process a range of slices of the jobs supplied to #BLOWFISH_ProcessBatch.
+
+	@param BodyContext	Pointer to the jobs (see #_BLOWFISH_BATCH).
+
+	@param Begin		Index of the first slice.
+
+	@param End			Index of the slice following the range.
+
+  */ 
+
+static void _BLOWFISH_ProcessSlices ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_BATCH *	Batch = (const _BLOWFISH_BATCH *)BodyContext;
+	BLOWFISH_PJOB			Jobs [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_RC				ReturnCodes [ _BLOWFISH_BATCH_SLICE ];
+	BLOWFISH_SIZE_T			Count;
+	BLOWFISH_SIZE_T			i;
+	BLOWFISH_SIZE_T			j;
+
+	for ( i = Begin * _BLOWFISH_BATCH_SLICE; i < End * _BLOWFISH_BATCH_SLICE && i < Batch->JobCount; i += _BLOWFISH_BATCH_SLICE )
+	{
+		for ( Count = 0; Count < _BLOWFISH_BATCH_SLICE && i + Count < Batch->JobCount; Count++ )
+		{
+			Jobs [ Count ] = &Batch->Jobs [ i + Count ];
+		}
+
+		_BLOWFISH_ProcessJobs ( Jobs, ReturnCodes, Count );
+
+		for ( j = 0; j < Count; j++ )
+		{
+			Jobs [ j ]->ReturnCode = ReturnCodes [ j ];
+		}
+	}
+
+	return;
+}
+
+BLOWFISH_RC BLOWFISH_ProcessBatch ( BLOWFISH_SIZE_T JobCount, BLOWFISH_PJOB Jobs )
+{
+	_BLOWFISH_BATCH	Batch;
+	BLOWFISH_SIZE_T	i;
+
+	/* Ensure the jobs pointer is valid */ 
+
+	if ( Jobs == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the job count is not negative */ 
+
+	if ( JobCount < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	Batch.Jobs = Jobs;
+	Batch.JobCount = JobCount;
+
+	_BLOWFISH_ParallelFor ( ( JobCount + _BLOWFISH_BATCH_SLICE - 1 ) / _BLOWFISH_BATCH_SLICE, &_BLOWFISH_ProcessSlices, &Batch );
+
+	for ( i = 0; i < JobCount; i++ )
+	{
+		if ( Jobs [ i ].ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return Jobs [ i ].ReturnCode;
+		}
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+/**
+
+	@internal
+
+	Encipher several blocks, each with its own key schedule, one at a time.
+
+	@param KeySchedules	Array of pointers to the key schedule for each block.
+
+	@param High32		Array of the high 32-bits of each block, which receives the high 32-bits of each enciphered block.
+
+	@param Low32		Array of the low 32-bits of each block, which receives the low 32-bits of each enciphered block.
+
+	@param Count		Number of blocks.
+
+  */ 
+
+static void _BLOWFISH_EncipherKeys ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < Count; i++ )
+	{
+		_BLOWFISH_EncipherBlock ( KeySchedules [ i ], &High32 [ i ], &Low32 [ i ] );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher several blocks, each with its own key schedule, one at a time.
+
+	See #_BLOWFISH_EncipherKeys for more information.
+
+  */ 
+
+static void _BLOWFISH_DecipherKeys ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	BLOWFISH_ULONG		XLeft;
+	BLOWFISH_ULONG		XRight;
+	BLOWFISH_PCULONG	P;
+	BLOWFISH_PCULONG	S0;
+	BLOWFISH_PCULONG	S1;
+	BLOWFISH_PCULONG	S2;
+	BLOWFISH_PCULONG	S3;
+	BLOWFISH_SIZE_T		i;
+
+	for ( i = 0; i < Count; i++ )
+	{
+		XLeft = High32 [ i ];
+		XRight = Low32 [ i ];
+		P = KeySchedules [ i ]->PArray;
+		S0 = KeySchedules [ i ]->SBox [ 0 ];
+		S1 = KeySchedules [ i ]->SBox [ 1 ];
+		S2 = KeySchedules [ i ]->SBox [ 2 ];
+		S3 = KeySchedules [ i ]->SBox [ 3 ];
+
+		_BLOWFISH_DECIPHER ( High32 [ i ], Low32 [ i ], XLeft, XRight, P, S0, S1, S2, S3 );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher several blocks, each with its own key schedule, 4 at a time (the remaining blocks are enciphered singly).
+
+	See #_BLOWFISH_EncipherKeys for more information.
+
+  */ 
+
+static void _BLOWFISH_EncipherKeys_X4 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	BLOWFISH_SIZE_T	Groups = Count & ~3;
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < Groups; i += 4 )
+	{
+		_BLOWFISH_ENCIPHER_KEYS_X4 ( ( High32 + i ), ( Low32 + i ), ( KeySchedules + i ) );
+	}
+
+	_BLOWFISH_EncipherKeys ( KeySchedules + Groups, High32 + Groups, Low32 + Groups, Count - Groups );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Decipher several blocks, each with its own key schedule, 4 at a time (the remaining blocks are deciphered singly).
+
+	See #_BLOWFISH_EncipherKeys for more information.
+
+  */ 
+
+static void _BLOWFISH_DecipherKeys_X4 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	BLOWFISH_SIZE_T	Groups = Count & ~3;
+	BLOWFISH_SIZE_T	i;
+
+	for ( i = 0; i < Groups; i += 4 )
+	{
+		_BLOWFISH_DECIPHER_KEYS_X4 ( ( High32 + i ), ( Low32 + i ), ( KeySchedules + i ) );
+	}
+
+	_BLOWFISH_DecipherKeys ( KeySchedules + Groups, High32 + Groups, Low32 + Groups, Count - Groups );
+
+	return;
+}
+
+/** @internal Number of blocks grouped by key schedule at a time by #_BLOWFISH_CipherKeyWindows. */ 
+
+#define _BLOWFISH_KEYS_WINDOW	256
+
+/** @internal Number of buckets blocks are grouped into by #_BLOWFISH_CipherKeyWindows (must be a power of 2). */ 
+
+#define _BLOWFISH_KEYS_BUCKETS	64
+
+/** @internal Blocks being enciphered/deciphered by #BLOWFISH_EncipherMultiKey/#BLOWFISH_DecipherMultiKey. */ 
+
+typedef struct __BLOWFISH_MULTI_KEY
+{
+	const BLOWFISH_PCKEY_SCHEDULE *	KeySchedules;	/*!< Array of pointers to the key schedule for each block. */ 
+	BLOWFISH_PULONG					High32;			/*!< Array of the high 32-bits of each block. */ 
+	BLOWFISH_PULONG					Low32;			/*!< Array of the low 32-bits of each block. */ 
+	BLOWFISH_SIZE_T					Count;			/*!< Number of blocks. */ 
+	void							( *Cipher ) ( );	/*!< Multi-key encipher or decipher callback from the kernel table. */ 
+
+} _BLOWFISH_MULTI_KEY;
+
+/**
+
+	@internal
+
+	Encipher/decipher a range of windows of blocks supplied to #BLOWFISH_EncipherMultiKey/#BLOWFISH_DecipherMultiKey.
+
+	@param BodyContext	Pointer to the blocks (see #_BLOWFISH_MULTI_KEY).
+
+	@param Begin		Index of the first window.
+
+	@param End			Index of the window following the range.
+
+	@remarks The blocks in each window are distributed into buckets by a hash of their key schedule pointer (a counting sort), so blocks sharing a key schedule become adjacent. They are gathered in that order into contiguous arrays for the kernel, then scattered back.
+
+  */ 
+
+static void _BLOWFISH_CipherKeyWindows ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_MULTI_KEY *	Blocks = (const _BLOWFISH_MULTI_KEY *)BodyContext;
+	BLOWFISH_PCKEY_SCHEDULE		KeySchedules [ _BLOWFISH_KEYS_WINDOW ];
+	BLOWFISH_ULONG				High32 [ _BLOWFISH_KEYS_WINDOW ];
+	BLOWFISH_ULONG				Low32 [ _BLOWFISH_KEYS_WINDOW ];
+	BLOWFISH_SIZE_T				Order [ _BLOWFISH_KEYS_WINDOW ];
+	BLOWFISH_UCHAR				Bucket [ _BLOWFISH_KEYS_WINDOW ];
+	BLOWFISH_SIZE_T				Offset [ _BLOWFISH_KEYS_BUCKETS ];
+	BLOWFISH_SIZE_T				Window;
+	BLOWFISH_SIZE_T				First;
+	BLOWFISH_SIZE_T				Count;
+	BLOWFISH_SIZE_T				Total;
+	BLOWFISH_SIZE_T				Size;
+	BLOWFISH_SIZE_T				i;
+	BLOWFISH_SIZE_T				j;
+
+	for ( Window = Begin; Window < End; Window++ )
+	{
+		First = Window * _BLOWFISH_KEYS_WINDOW;
+		Count = Blocks->Count - First < _BLOWFISH_KEYS_WINDOW ? Blocks->Count - First : _BLOWFISH_KEYS_WINDOW;
+
+		/* Count the blocks in each bucket, hashing the key schedule address (which is at least 64-byte aligned) */ 
+
+		memset ( Offset, 0, sizeof ( Offset ) );
+
+		for ( i = 0; i < Count; i++ )
+		{
+			Bucket [ i ] = (BLOWFISH_UCHAR)( ( ( (BLOWFISH_ULONG)( (size_t)Blocks->KeySchedules [ First + i ] >> 6 ) * 0x9e3779b1UL ) >> 26 ) & ( _BLOWFISH_KEYS_BUCKETS - 1 ) );
+			Offset [ Bucket [ i ] ]++;
+		}
+
+		/* Convert the counts to the offset of each bucket, then place each block in its bucket */ 
+
+		for ( i = 0, Total = 0; i < _BLOWFISH_KEYS_BUCKETS; i++ )
+		{
+			Size = Offset [ i ];
+			Offset [ i ] = Total;
+			Total += Size;
+		}
+
+		for ( i = 0; i < Count; i++ )
+		{
+			Order [ Offset [ Bucket [ i ] ]++ ] = First + i;
+		}
+
+		/* Gather the blocks in bucket order, encipher/decipher them together and scatter the results */ 
+
+		for ( i = 0; i < Count; i++ )
+		{
+			j = Order [ i ];
+
+			KeySchedules [ i ] = Blocks->KeySchedules [ j ];
+			High32 [ i ] = Blocks->High32 [ j ];
+			Low32 [ i ] = Blocks->Low32 [ j ];
+		}
+
+		Blocks->Cipher ( KeySchedules, High32, Low32, Count );
+
+		for ( i = 0; i < Count; i++ )
+		{
+			j = Order [ i ];
+
+			Blocks->High32 [ j ] = High32 [ i ];
+			Blocks->Low32 [ j ] = Low32 [ i ];
+		}
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/decipher many blocks, each with its own key schedule.
+
+	@param Count		Number of blocks.
+
+	@param KeySchedules	Array of pointers to the key schedule for each block.
+
+	@param High32		Array of the high 32-bits of each block.
+
+	@param Low32		Array of the low 32-bits of each block.
+
+	@param Decipher		Non-zero to decipher the blocks, otherwise they are enciphered.
+
+	@remarks This function can be parallelised using OpenMP or an executor (see #BLOWFISH_SetExecutor).
+
+	@return See #BLOWFISH_EncipherMultiKey.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_CipherMultiKey ( BLOWFISH_SIZE_T Count, const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, int Decipher )
+{
+	const _BLOWFISH_KERNEL_TABLE *	Table;
+	_BLOWFISH_MULTI_KEY				Blocks;
+	BLOWFISH_SIZE_T					i;
+
+	/* Ensure the array pointers and every key schedule pointer are valid */ 
+
+	if ( KeySchedules == 0 || High32 == 0 || Low32 == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the block count is not negative */ 
+
+	if ( Count < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	for ( i = 0; i < Count; i++ )
+	{
+		if ( KeySchedules [ i ] == 0 )
+		{
+			return BLOWFISH_RC_INVALID_PARAMETER;
+		}
+	}
+
+	Table = _BLOWFISH_GetKernelTable ( );
+
+	Blocks.KeySchedules = KeySchedules;
+	Blocks.High32 = High32;
+	Blocks.Low32 = Low32;
+	Blocks.Count = Count;
+	Blocks.Cipher = Decipher ? Table->DecipherKeys : Table->EncipherKeys;
+
+	_BLOWFISH_ParallelFor ( ( Count + _BLOWFISH_KEYS_WINDOW - 1 ) / _BLOWFISH_KEYS_WINDOW, &_BLOWFISH_CipherKeyWindows, &Blocks );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherMultiKey ( BLOWFISH_SIZE_T Count, const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
+{
+	return _BLOWFISH_CipherMultiKey ( Count, KeySchedules, High32, Low32, 0 );
+}
+
+BLOWFISH_RC BLOWFISH_DecipherMultiKey ( BLOWFISH_SIZE_T Count, const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
+{
+	return _BLOWFISH_CipherMultiKey ( Count, KeySchedules, High32, Low32, 1 );
+}
+
+/** @internal Number of 64-bit values converted at a time by #_BLOWFISH_CipherU64Chunks. */ 
+
+#define _BLOWFISH_U64_CHUNK	512
+
+/** @internal Values being enciphered/deciphered by #BLOWFISH_EncipherU64Array/#BLOWFISH_DecipherU64Array. */ 
+
+typedef struct __BLOWFISH_U64_ARRAY
+{
+	BLOWFISH_SESSION			Session;		/*!< Electronic codebook session record referencing the context's key schedule, limited to 1 thread per chunk. */ 
+	void						( *Cipher ) ( );	/*!< Encipher or decipher stream callback of the session record. */ 
+	const BLOWFISH_ULONGLONG *	InArray;		/*!< Array of values to encipher/decipher. */ 
+	BLOWFISH_ULONGLONG *		OutArray;		/*!< Array to receive the enciphered/deciphered values. */ 
+	BLOWFISH_SIZE_T				Count;			/*!< Number of values. */ 
+
+} _BLOWFISH_U64_ARRAY;
+
+/**
+
+	@internal
+
+	Encipher/decipher a range of chunks of values supplied to #BLOWFISH_EncipherU64Array/#BLOWFISH_DecipherU64Array.
+
+	@param BodyContext	Pointer to the values (see #_BLOWFISH_U64_ARRAY).
+
+	@param Begin		Index of the first chunk.
+
+	@param End			Index of the chunk following the range.
+
+	@remarks Each chunk is split into a stream of high and low 32-bit halves using shifts rather than by reinterpreting memory, so the result does not depend on the host byte order.
+
+  */ 
+
+static void _BLOWFISH_CipherU64Chunks ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End )
+{
+	const _BLOWFISH_U64_ARRAY *	Array = (const _BLOWFISH_U64_ARRAY *)BodyContext;
+	BLOWFISH_SESSION			Session = Array->Session;
+	BLOWFISH_ULONG				Stream [ _BLOWFISH_U64_CHUNK * 2 ];
+	BLOWFISH_SIZE_T				Chunk;
+	BLOWFISH_SIZE_T				First;
+	BLOWFISH_SIZE_T				Count;
+	BLOWFISH_SIZE_T				i;
+
+	for ( Chunk = Begin; Chunk < End; Chunk++ )
+	{
+		First = Chunk * _BLOWFISH_U64_CHUNK;
+		Count = Array->Count - First < _BLOWFISH_U64_CHUNK ? Array->Count - First : _BLOWFISH_U64_CHUNK;
+
+		for ( i = 0; i < Count; i++ )
+		{
+			Stream [ i * 2 ] = (BLOWFISH_ULONG)( Array->InArray [ First + i ] >> 32 );
+			Stream [ i * 2 + 1 ] = (BLOWFISH_ULONG)Array->InArray [ First + i ];
+		}
+
+		Array->Cipher ( &Session, Stream, Stream, Count * 2 );
+
+		for ( i = 0; i < Count; i++ )
+		{
+			Array->OutArray [ First + i ] = ( (BLOWFISH_ULONGLONG)Stream [ i * 2 ] << 32 ) | Stream [ i * 2 + 1 ];
+		}
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher/decipher an array of 64-bit values in electronic codebook mode.
+
+	@param Context	Pointer to an initialised context record.
+
+	@param InArray	Array of values to encipher/decipher.
+
+	@param OutArray	Array to receive the enciphered/deciphered values.
+
+	@param Count	Number of values.
+
+	@param Decipher	Non-zero to decipher the values, otherwise they are enciphered.
+
+	@remarks This function can be parallelised using OpenMP or an executor (see #BLOWFISH_SetExecutor).
+
+	@return See #BLOWFISH_EncipherU64Array.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_CipherU64Array ( BLOWFISH_PCONTEXT Context, const BLOWFISH_ULONGLONG * InArray, BLOWFISH_ULONGLONG * OutArray, BLOWFISH_SIZE_T Count, int Decipher )
+{
+	_BLOWFISH_U64_ARRAY	Array;
+	BLOWFISH_RC			ReturnCode;
+
+	/* Ensure the context and array pointers are valid */ 
+
+	if ( Context == 0 || InArray == 0 || OutArray == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#ifdef _OPENMP
+
+	/* Ensure the block count is not negative */ 
+
+	if ( Count < 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+#endif
+
+	/* Use the context's key schedule in electronic codebook mode, whatever the context's own mode */ 
+
+	ReturnCode = BLOWFISH_InitSession ( &Array.Session, &Context->KeySchedule, BLOWFISH_MODE_ECB, 0, 0 );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	Array.Session.MaxThreads = 1;
+	Array.Cipher = Decipher ? Array.Session.DecipherStream : Array.Session.EncipherStream;
+	Array.InArray = InArray;
+	Array.OutArray = OutArray;
+	Array.Count = Count;
+
+	_BLOWFISH_ParallelFor ( ( Count + _BLOWFISH_U64_CHUNK - 1 ) / _BLOWFISH_U64_CHUNK, &_BLOWFISH_CipherU64Chunks, &Array );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_EncipherU64Array ( BLOWFISH_PCONTEXT Context, const BLOWFISH_ULONGLONG * PlainTextArray, BLOWFISH_ULONGLONG * CipherTextArray, BLOWFISH_SIZE_T Count )
+{
+	return _BLOWFISH_CipherU64Array ( Context, PlainTextArray, CipherTextArray, Count, 0 );
+}
+
+BLOWFISH_RC BLOWFISH_DecipherU64Array ( BLOWFISH_PCONTEXT Context, const BLOWFISH_ULONGLONG * CipherTextArray, BLOWFISH_ULONGLONG * PlainTextArray, BLOWFISH_SIZE_T Count )
+{
+	return _BLOWFISH_CipherU64Array ( Context, CipherTextArray, PlainTextArray, Count, 1 );
+}
+
+/**
+
+	@internal
+
+	Encipher/Decipher a stream of data in output feedback mode, taking the keystream from the session's keystream record where it can.
+
+	@param Session		Pointer to an initialised session record, with a keystream record attached.
+
+	@param InStream		Pointer to either a buffer of plaintext to encipher, or a buffer of ciphertext to decipher.
+
+	@param OutStream	Pointer to a buffer to receive either the ciphertext or plaintext output.
+
+	@param StreamLength	Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+
+	@remarks The ring holds the keystream following the last block taken from it, so is used while the initialisation vector (the last block of keystream) is that block. Otherwise the stream has moved on without the ring, and the ring is searched for the initialisation vector, discarding the blocks up to it (or every block, if it is not found). Keystream the ring cannot supply is generated by #_BLOWFISH_EncipherDecipherStream_OFB.
+
+  */ 
+
+static void _BLOWFISH_EncipherDecipherStream_OFB_Keystream ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_PKEYSTREAM	Keystream = Session->Keystream;
+	BLOWFISH_PCULONG	Block;
+	BLOWFISH_ULONG		Consumed = Keystream->Consumed;
+	BLOWFISH_ULONG		Produced = _BLOWFISH_ATOMIC_LOAD ( Keystream->Produced );
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		Count;
+	BLOWFISH_SIZE_T		i = 0;
+	BLOWFISH_SIZE_T		j;
+
+	/* Catch up with the stream */ 
+
+	while ( ( Session->IvHigh32 != Keystream->ConsumedHigh32 || Session->IvLow32 != Keystream->ConsumedLow32 ) && Consumed != Produced )
+	{
+		Block = Keystream->Blocks + ( ( Consumed++ & Keystream->BlockMask ) << 1 );
+
+		Keystream->ConsumedHigh32 = Block [ 0 ];
+		Keystream->ConsumedLow32 = Block [ 1 ];
 	}
 
-	/* Preserve the initialisation vector added with the counter as the new initialisation vector for stream based operations */ 
+	if ( Session->IvHigh32 == Keystream->ConsumedHigh32 && Session->IvLow32 == Keystream->ConsumedLow32 )
+	{
+		/* XOR the data with each run of blocks that are adjacent in the ring, in a loop the compiler can vectorise */ 
+
+		while ( i < StreamLength && Consumed != Produced )
+		{
+			Block = Keystream->Blocks + ( ( Consumed & Keystream->BlockMask ) << 1 );
+			Count = (BLOWFISH_SIZE_T)( Keystream->BlockMask + 1 - ( Consumed & Keystream->BlockMask ) );
+
+			if ( Count > (BLOWFISH_SIZE_T)( Produced - Consumed ) )
+			{
+				Count = (BLOWFISH_SIZE_T)( Produced - Consumed );
+			}
+
+			if ( Count > ( StreamLength - i ) >> 1 )
+			{
+				Count = ( StreamLength - i ) >> 1;
+			}
+
+			for ( j = 0; j < Count * 2; j++ )
+			{
+				_BLOWFISH_Store ( OutStream + i + j, _BLOWFISH_Load ( InStream + i + j, Swap ) ^ Block [ j ], Swap );
+			}
+
+			Keystream->ConsumedHigh32 = Block [ Count * 2 - 2 ];
+			Keystream->ConsumedLow32 = Block [ Count * 2 - 1 ];
+
+			Consumed += (BLOWFISH_ULONG)Count;
+			i += Count * 2;
+		}
+
+		Session->IvHigh32 = Keystream->ConsumedHigh32;
+		Session->IvLow32 = Keystream->ConsumedLow32;
+	}
+
+	/* Hand the blocks taken back to the producer */ 
+
+	_BLOWFISH_ATOMIC_STORE ( Keystream->Consumed, Consumed );
+
+	/* Generate the keystream the ring could not supply on this thread */ 
+
+	if ( i < StreamLength )
+	{
+		_BLOWFISH_EncipherDecipherStream_OFB ( Session, InStream + i, OutStream + i, StreamLength - i );
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Attach a keystream record to a session record, or detach it, and select the stream callbacks to suit.
+
+	@param Session		Pointer to a session record initialised with #BLOWFISH_MODE_OFB.
+
+	@param Keystream	Pointer to the keystream record, or null to detach it.
+
+  */ 
+
+static void _BLOWFISH_SetKeystream ( BLOWFISH_PSESSION Session, BLOWFISH_PKEYSTREAM Keystream )
+{
+	const _BLOWFISH_KERNEL_TABLE *	Table = _BLOWFISH_GetKernelTable ( );
+
+	Session->Keystream = Keystream;
+
+	if ( Keystream != 0 )
+	{
+		Session->EncipherStream = &_BLOWFISH_EncipherDecipherStream_OFB_Keystream;
+		Session->DecipherStream = &_BLOWFISH_EncipherDecipherStream_OFB_Keystream;
+	}
+	else
+	{
+		Session->EncipherStream = Table->EncipherStream [ BLOWFISH_MODE_OFB ];
+		Session->DecipherStream = Table->DecipherStream [ BLOWFISH_MODE_OFB ];
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Detach the keystream record attached to a session record, wiping its ring and positions.
+
+	@param Session	Pointer to a session record with a keystream record attached.
+
+	@remarks It is an unchecked runtime error to supply a session record without a keystream record attached.
+
+  */ 
+
+static void _BLOWFISH_DetachKeystream ( BLOWFISH_PSESSION Session )
+{
+	BLOWFISH_PKEYSTREAM	Attached = Session->Keystream;
+
+	_BLOWFISH_SetKeystream ( Session, 0 );
+
+	_BLOWFISH_Wipe ( Attached->Blocks, (BLOWFISH_SIZE_T)( Attached->BlockMask + 1 ) * 8 );
 
-	Context->IvHigh32 += (BLOWFISH_ULONG)StreamLength;
-	Context->IvLow32 += (BLOWFISH_ULONG)( StreamLength + 1 );
+	Attached->Produced = 0;
+	Attached->Consumed = 0;
+	Attached->KeySchedule = 0;
+	Attached->ProducedHigh32 = 0;
+	Attached->ProducedLow32 = 0;
+	Attached->ConsumedHigh32 = 0;
+	Attached->ConsumedLow32 = 0;
 
 	return;
 }
 
-BLOWFISH_RC BLOWFISH_EncipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextStream, BLOWFISH_PUCHAR CipherTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	/* Ensure the context and stream buffer pointers are non null */ 
+BLOWFISH_RC BLOWFISH_InitKeystream ( BLOWFISH_PKEYSTREAM Keystream, BLOWFISH_PULONG Blocks, BLOWFISH_SIZE_T BlockCount )
+{
+	/* Ensure pointers are valid, and the block count is a power of 2 that positions can wrap around */ 
+
+	if ( Keystream == 0 || Blocks == 0 || BlockCount <= 0 || ( BlockCount & ( BlockCount - 1 ) ) != 0 || ( ( BlockCount - 1 ) >> 31 ) != 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_Wipe ( Keystream, (BLOWFISH_SIZE_T)sizeof ( *Keystream ) );
+
+	Keystream->Blocks = Blocks;
+	Keystream->BlockMask = (BLOWFISH_ULONG)( BlockCount - 1 );
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_AttachSessionKeystream ( BLOWFISH_PSESSION Session, BLOWFISH_PKEYSTREAM Keystream )
+{
+	/* Ensure the session pointer is valid */ 
+
+	if ( Session == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	if ( Session->Mode != BLOWFISH_MODE_OFB )
+	{
+		return BLOWFISH_RC_INVALID_MODE;
+	}
+
+	/* Detach any keystream record already attached, wiping its ring */ 
+
+	if ( Session->Keystream != 0 )
+	{
+		_BLOWFISH_DetachKeystream ( Session );
+	}
+
+	/* Empty the ring, which both the producer and the session start from the original initialisation vector */ 
+
+	if ( Keystream != 0 )
+	{
+		Keystream->Produced = 0;
+		Keystream->Consumed = 0;
+		Keystream->KeySchedule = Session->KeySchedule;
+		Keystream->ProducedHigh32 = Session->OriginalIvHigh32;
+		Keystream->ProducedLow32 = Session->OriginalIvLow32;
+		Keystream->ConsumedHigh32 = Session->OriginalIvHigh32;
+		Keystream->ConsumedLow32 = Session->OriginalIvLow32;
+
+		_BLOWFISH_SetKeystream ( Session, Keystream );
+	}
+
+	return BLOWFISH_RC_SUCCESS;
+}
+
+BLOWFISH_RC BLOWFISH_AttachKeystream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PKEYSTREAM Keystream )
+{
+	/* Ensure the context pointer is valid */ 
+
+	if ( Context == 0 )
+	{
+		return BLOWFISH_RC_INVALID_PARAMETER;
+	}
+
+	_BLOWFISH_BIND ( Context );
+
+	return BLOWFISH_AttachSessionKeystream ( &Context->Session, Keystream );
+}
+
+BLOWFISH_SIZE_T BLOWFISH_FillKeystream ( BLOWFISH_PKEYSTREAM Keystream, BLOWFISH_SIZE_T MaxBlocks )
+{
+	BLOWFISH_PULONG	Block;
+	BLOWFISH_ULONG	Produced;
+	BLOWFISH_ULONG	High32;
+	BLOWFISH_ULONG	Low32;
+	BLOWFISH_SIZE_T	Blocks = 0;
+
+	if ( Keystream == 0 || Keystream->KeySchedule == 0 )
+	{
+		return 0;
+	}
+
+	Produced = Keystream->Produced;
+	High32 = Keystream->ProducedHigh32;
+	Low32 = Keystream->ProducedLow32;
+
+	/* Generate blocks until the ring holds every block the session has yet to take, publishing each as it is written */ 
+
+	while ( ( MaxBlocks == 0 || Blocks < MaxBlocks ) && Produced - _BLOWFISH_ATOMIC_LOAD ( Keystream->Consumed ) <= Keystream->BlockMask )
+	{
+		_BLOWFISH_EncipherBlock ( Keystream->KeySchedule, &High32, &Low32 );
+
+		Block = Keystream->Blocks + ( ( Produced & Keystream->BlockMask ) << 1 );
+
+		Block [ 0 ] = High32;
+		Block [ 1 ] = Low32;
+
+		Produced++;
+
+		_BLOWFISH_ATOMIC_STORE ( Keystream->Produced, Produced );
+
+		Blocks++;
+	}
+
+	Keystream->ProducedHigh32 = High32;
+	Keystream->ProducedLow32 = Low32;
+
+	return Blocks;
+}
+
+#ifdef _BLOWFISH_SIMD
+
+/**
+
+	@internal
+
+	Create a mask with the lowest Count bits set.
+
+	@param Count	Number of bits to set (0-16).
+
+  */ 
+
+#define _BLOWFISH_MASK_AVX512( Count )	( (__mmask16)( ( 1u << ( Count ) ) - 1 ) )
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher on up to 16 independent blocks, using masked gathers for the S-Box lookups.
+
+	See #_BLOWFISH_CIPHER for more information.
+
+	@remarks After each round the caller must swap xL and xR.
+
+	@param XLeft			Vector of the high 32-bits of 16 messages to encipher.
+
+	@param XRight			Vector of the low 32-bits of 16 messages to encipher.
+
+	@param P				Pointer to the P-Array.
+
+	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+
+	@param ByteMask			Vector with each element set to 0xff.
+
+	@param LaneMask			Mask of the messages to encipher (inactive lanes are set to zero).
+
+	@param Round			Current round to perform (0-15 to encipher, 17-2 to decipher).
+
+  */ 
+
+#define _BLOWFISH_CIPHER_AVX512( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, Round )											\
+{																																		\
+	XLeft = _mm512_xor_si512 ( XLeft, _mm512_set1_epi32 ( (int)P [ Round ] ) );															\
+	XRight = _mm512_xor_si512 ( XRight, _mm512_add_epi32 ( _mm512_xor_si512 ( _mm512_add_epi32 (										\
+		_mm512_mask_i32gather_epi32 ( _mm512_setzero_si512 ( ), LaneMask, _mm512_srli_epi32 ( XLeft, 24 ), S0, 4 ),						\
+		_mm512_mask_i32gather_epi32 ( _mm512_setzero_si512 ( ), LaneMask, _mm512_and_si512 ( _mm512_srli_epi32 ( XLeft, 16 ), ByteMask ), S1, 4 ) ),	\
+		_mm512_mask_i32gather_epi32 ( _mm512_setzero_si512 ( ), LaneMask, _mm512_and_si512 ( _mm512_srli_epi32 ( XLeft, 8 ), ByteMask ), S2, 4 ) ),	\
+		_mm512_mask_i32gather_epi32 ( _mm512_setzero_si512 ( ), LaneMask, _mm512_and_si512 ( XLeft, ByteMask ), S3, 4 ) ) );			\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round encipher on up to 16 independent blocks. See #_BLOWFISH_ENCIPHER for more information.
+
+	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+
+  */ 
+
+#define _BLOWFISH_ENCIPHER_AVX512( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask )						\
+{																																		\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 0 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 1 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 2 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 3 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 4 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 5 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 6 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 7 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 8 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 9 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 10 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 11 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 12 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 13 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 14 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 15 );												\
+	BufferLow = _mm512_xor_si512 ( XLeft, _mm512_set1_epi32 ( (int)P [ 16 ] ) );														\
+	BufferHigh = _mm512_xor_si512 ( XRight, _mm512_set1_epi32 ( (int)P [ 17 ] ) );														\
+}
+
+/**
+
+	@internal
+
+	Perform 16-round decipher on up to 16 independent blocks. See #_BLOWFISH_DECIPHER for more information.
+
+	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+
+  */ 
+
+#define _BLOWFISH_DECIPHER_AVX512( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask )						\
+{																																		\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 17 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 16 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 15 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 14 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 13 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 12 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 11 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 10 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 9 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 8 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 7 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 6 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 5 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 4 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask, 3 );												\
+	_BLOWFISH_CIPHER_AVX512 ( XRight, XLeft, P, S0, S1, S2, S3, ByteMask, LaneMask, 2 );												\
+	BufferHigh = _mm512_xor_si512 ( XRight, _mm512_set1_epi32 ( (int)P [ 0 ] ) );														\
+	BufferLow = _mm512_xor_si512 ( XLeft, _mm512_set1_epi32 ( (int)P [ 1 ] ) );															\
+}
+
+/**
+
+	@internal
+
+	Split 16 consecutive 8-byte blocks into a vector of high 32-bit halves, and a vector of low 32-bit halves.
+
+	@param High		Vector to receive the high 32-bits of each block.
+
+	@param Low		Vector to receive the low 32-bits of each block.
+
+	@param First	Vector containing blocks 0-7.
+
+	@param Second	Vector containing blocks 8-15.
+
+  */ 
+
+#define _BLOWFISH_DEINTERLEAVE_AVX512( High, Low, First, Second )																		\
+{																																		\
+	High = _mm512_permutex2var_epi32 ( First, _mm512_setr_epi32 ( 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 ), Second );	\
+	Low = _mm512_permutex2var_epi32 ( First, _mm512_setr_epi32 ( 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31 ), Second );	\
+}
+
+/**
+
+	@internal
+
+	Merge a vector of high 32-bit halves and a vector of low 32-bit halves back into 16 consecutive 8-byte blocks.
+
+	@param First	Vector to receive blocks 0-7.
+
+	@param Second	Vector to receive blocks 8-15.
+
+	@param High		Vector containing the high 32-bits of each block.
+
+	@param Low		Vector containing the low 32-bits of each block.
+
+  */ 
+
+#define _BLOWFISH_INTERLEAVE_AVX512( First, Second, High, Low )																			\
+{																																		\
+	First = _mm512_permutex2var_epi32 ( High, _mm512_setr_epi32 ( 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 ), Low );		\
+	Second = _mm512_permutex2var_epi32 ( High, _mm512_setr_epi32 ( 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 ), Low );	\
+}
+
+/**
+
+	@internal
+
+	Byte swap each 32-bit word of two vectors (see #BLOWFISH_SetByteOrder).
+
+	@param First	First vector to swap.
+
+	@param Second	Second vector to swap.
+
+	@remarks AVX-512F has no byte shuffle, so each word is rotated left and right by 8 bits and alternate bytes selected from each.
+
+  */ 
+
+#define _BLOWFISH_BSWAP_AVX512( First, Second )																						\
+{																																	\
+	__m512i	_BLOWFISH_Select = _mm512_set1_epi32 ( (int)0xff00ff00 );																\
+																																	\
+	First = _mm512_ternarylogic_epi32 ( _mm512_ror_epi32 ( First, 8 ), _mm512_rol_epi32 ( First, 8 ), _BLOWFISH_Select, 0xe4 );		\
+	Second = _mm512_ternarylogic_epi32 ( _mm512_ror_epi32 ( Second, 8 ), _mm512_rol_epi32 ( Second, 8 ), _BLOWFISH_Select, 0xe4 );	\
+}
+
+/**
+
+	@internal
+
+	Compute the masks for the next group of up to 16 blocks in a stream.
+
+	@param Remaining	Number of 4-byte blocks remaining in the stream.
+
+	@param LaneMask		Mask to receive the active lanes (one per 8-byte block).
+
+	@param FirstMask	Mask to receive the active elements of the vector containing blocks 0-7.
+
+	@param SecondMask	Mask to receive the active elements of the vector containing blocks 8-15.
+
+  */ 
+
+#define _BLOWFISH_GROUP_MASKS_AVX512( Remaining, LaneMask, FirstMask, SecondMask )				\
+{																								\
+	BLOWFISH_ULONG	_BLOWFISH_Words = Remaining < 32 ? (BLOWFISH_ULONG)Remaining : 32;			\
+																								\
+	LaneMask = _BLOWFISH_MASK_AVX512 ( _BLOWFISH_Words >> 1 );									\
+	FirstMask = _BLOWFISH_MASK_AVX512 ( _BLOWFISH_Words < 16 ? _BLOWFISH_Words : 16 );			\
+	SecondMask = _BLOWFISH_MASK_AVX512 ( _BLOWFISH_Words < 16 ? 0 : _BLOWFISH_Words - 16 );		\
+}
+
+/**
+
+	@internal
+
+	Encipher a stream of data in electronic codebook mode, 16 blocks at a time using AVX-512.
+
+	See #_BLOWFISH_EncipherStream_ECB for more information.
+
+	@remarks The final group of fewer than 16 blocks is enciphered using masked loads, gathers and stores.
+
+  */ 
+
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherStream_ECB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG PlainTextStream, BLOWFISH_PULONG CipherTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher plaintext in 128-byte groups of 16 blocks */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
+
+#endif
+
+	for ( i = 0; i < StreamLength; i += 32 )
+	{
+		__m512i		ByteMask = _mm512_set1_epi32 ( 0xff );
+		__m512i		First;
+		__m512i		Second;
+		__m512i		XLeft;
+		__m512i		XRight;
+		__mmask16	LaneMask;
+		__mmask16	FirstMask;
+		__mmask16	SecondMask;
+
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
+
+		First = _mm512_maskz_loadu_epi32 ( FirstMask, PlainTextStream + i );
+		Second = _mm512_maskz_loadu_epi32 ( SecondMask, PlainTextStream + i + 16 );
+
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
+
+		_BLOWFISH_DEINTERLEAVE_AVX512 ( XLeft, XRight, First, Second );
+
+		_BLOWFISH_ENCIPHER_AVX512 ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
+
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, XRight, XLeft );
+
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-	if ( Context == 0 || PlainTextStream == 0 || CipherTextStream == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
+		_mm512_mask_storeu_epi32 ( CipherTextStream + i, FirstMask, First );
+		_mm512_mask_storeu_epi32 ( CipherTextStream + i + 16, SecondMask, Second );
 	}
 
-	/* Ensure the stream length is a multiple of 8 */ 
+	return;
+}
 
-	if ( ( StreamLength & ~0x07 ) == 0 )
-	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	} 
+/**
 
-#ifdef _OPENMP
+	@internal
 
-	/* Ensure the stream length is not negative */ 
+	Decipher a stream of data in electronic codebook mode, 16 blocks at a time using AVX-512.
 
-	if ( StreamLength < 0 )
-	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+	See #_BLOWFISH_DecipherStream_ECB for more information.
 
-#endif
+	@remarks The final group of fewer than 16 blocks is deciphered using masked loads, gathers and stores.
 
-	/* Encipher stream based on block cipher mode */ 
+  */ 
 
-	Context->EncipherStream ( Context, (BLOWFISH_PCULONG)PlainTextStream, (BLOWFISH_PULONG)CipherTextStream, StreamLength >> 2 );
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_ECB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
 
-	return BLOWFISH_RC_SUCCESS;
-}
+	/* Decipher ciphertext in 128-byte groups of 16 blocks */ 
 
-BLOWFISH_RC BLOWFISH_EncipherBuffer ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T BufferLength )
-{
-	/* Ensure the context and buffer pointers are non null */ 
+#ifdef _OPENMP
 
-	if ( Context == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
-	}
+	#pragma omp parallel for default ( none ) private ( i ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
 
-	/* Ensure the buffer length is a multiple of 8 */ 
+#endif
 
-	if ( ( BufferLength & ~0x07 ) == 0 )
+	for ( i = 0; i < StreamLength; i += 32 )
 	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	} 
+		__m512i		ByteMask = _mm512_set1_epi32 ( 0xff );
+		__m512i		First;
+		__m512i		Second;
+		__m512i		XLeft;
+		__m512i		XRight;
+		__mmask16	LaneMask;
+		__mmask16	FirstMask;
+		__mmask16	SecondMask;
 
-#ifdef _OPENMP
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
 
-	/* Ensure the buffer length is not negative */ 
+		First = _mm512_maskz_loadu_epi32 ( FirstMask, CipherTextStream + i );
+		Second = _mm512_maskz_loadu_epi32 ( SecondMask, CipherTextStream + i + 16 );
 
-	if ( BufferLength < 0 )
-	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-#endif
+		_BLOWFISH_DEINTERLEAVE_AVX512 ( XLeft, XRight, First, Second );
 
-	/* Encipher buffer as a stream based on the block cipher mode */ 
+		_BLOWFISH_DECIPHER_AVX512 ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
 
-	_BLOWFISH_BEGINSTREAM ( Context );
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, XRight, XLeft );
 
-	Context->EncipherStream ( Context, (BLOWFISH_PCULONG)PlainTextBuffer, (BLOWFISH_PULONG)CipherTextBuffer, BufferLength >> 2 );
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-	_BLOWFISH_ENDSTREAM ( Context );
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i, FirstMask, First );
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i + 16, SecondMask, Second );
+	}
 
-	return BLOWFISH_RC_SUCCESS;
+	return;
 }
 
 /**
 
 	@internal
 
-	Perform 16-round decipher, finalise round and unswap xL and xR:
+	Decipher a stream of data in cipher block chaining mode, 16 blocks at a time using AVX-512.
 
-	xR = xR XOR P0
+	See #_BLOWFISH_DecipherStream_CBC for more information.
 
-	xL = xL XOR P1
+	@remarks The final group of fewer than 16 blocks is deciphered using masked loads, gathers and stores.
 
-	See @link glossary @endlink for more information.
+  */ 
 
-	@param BufferHigh		Pointer to the high 32-bits of the output buffer.
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_CBC_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	__m512i				ByteMask = _mm512_set1_epi32 ( 0xff );
+	__m512i				PreviousLeft = _mm512_set1_epi32 ( (int)Session->IvHigh32 );
+	__m512i				PreviousRight = _mm512_set1_epi32 ( (int)Session->IvLow32 );
+	__m512i				CipherTextLeft;
+	__m512i				CipherTextRight;
+	__m512i				First;
+	__m512i				Second;
+	__m512i				XLeft;
+	__m512i				XRight;
+	__mmask16			LaneMask;
+	__mmask16			FirstMask;
+	__mmask16			SecondMask;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Preserve the last block of ciphertext as the new initialisation vector for stream based operations, before the plaintext can overwrite it */ 
+
+	Session->IvHigh32 = _BLOWFISH_Load ( CipherTextStream + StreamLength - 2, Swap );
+	Session->IvLow32 = _BLOWFISH_Load ( CipherTextStream + StreamLength - 1, Swap );
+
+	/* Decipher ciphertext in 128-byte groups of 16 blocks */ 
+
+	for ( i = 0; i < StreamLength; i += 32 )
+	{
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
 
-	@param BufferLow		Pointer to the low 32-bits of the output buffer.
+		First = _mm512_maskz_loadu_epi32 ( FirstMask, CipherTextStream + i );
+		Second = _mm512_maskz_loadu_epi32 ( SecondMask, CipherTextStream + i + 16 );
 
-	@param XLeft			High 32-bits of the message to decipher.
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-	@param XRight			Low 32-bits of the message to decipher.
+		_BLOWFISH_DEINTERLEAVE_AVX512 ( CipherTextLeft, CipherTextRight, First, Second );
 
-	@param P				Pointer to the P-Array.
+		/* Shift the last block of ciphertext of the previous group (or the initialisation vector) into the first lane, and each block of ciphertext into the next lane */ 
 
-	@param S0, S1, S2, S3	Pointers to each element of the S-Box array.
+		PreviousLeft = _mm512_alignr_epi32 ( CipherTextLeft, PreviousLeft, 15 );
+		PreviousRight = _mm512_alignr_epi32 ( CipherTextRight, PreviousRight, 15 );
 
-	@remarks If BufferHigh and BufferLow are the same variables as XLeft and XRight then the result will not be swapped!
+		XLeft = CipherTextLeft;
+		XRight = CipherTextRight;
 
-  */ 
+		_BLOWFISH_DECIPHER_AVX512 ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
 
-#define _BLOWFISH_DECIPHER( BufferHigh, BufferLow, XLeft, XRight, P, S0, S1, S2, S3 )	\
-{																						\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 17 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 16 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 15 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 14 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 13 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 12 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 11 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 10 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 9 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 8 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 7 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 6 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 5 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 4 );							\
-	_BLOWFISH_CIPHER ( XLeft, XRight, P, S0, S1, S2, S3, 3 );							\
-	_BLOWFISH_CIPHER ( XRight, XLeft, P, S0, S1, S2, S3, 2 );							\
-	BufferHigh = XRight ^ P [ 0 ];														\
-	BufferLow = XLeft ^ P [ 1 ];														\
-}
+		/* XOR the deciphered blocks with the previous blocks of ciphertext to yeild the plaintext */ 
 
-void BLOWFISH_Decipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 )
-{
-	BLOWFISH_ULONG	XLeft = *High32;
-	BLOWFISH_ULONG	XRight = *Low32;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
+		XRight = _mm512_xor_si512 ( XRight, PreviousLeft );
+		XLeft = _mm512_xor_si512 ( XLeft, PreviousRight );
 
-	/* Decipher 8-byte plaintext block */ 
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, XRight, XLeft );
 
-	_BLOWFISH_DECIPHER ( *High32, *Low32, XLeft, XRight, P, S0, S1, S2, S3 );
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
+
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i, FirstMask, First );
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i + 16, SecondMask, Second );
+
+		PreviousLeft = CipherTextLeft;
+		PreviousRight = CipherTextRight;
+	}
 
 	return;
 }
@@ -1303,51 +8021,83 @@ void BLOWFISH_Decipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOW
 
 	@internal
 
-	Decipher a stream of data in electronic codebook mode.
+	Decipher a stream of data in cipher feedback mode, 16 blocks at a time using AVX-512.
 
-	Pn = Ek ( Cn )
+	See #_BLOWFISH_DecipherStream_CFB for more information.
 
-	See @link glossary @endlink for more information.
+	@remarks The final group of fewer than 16 blocks is deciphered using masked loads, gathers and stores.
 
-	@param Context			Pointer to an initialised context record.
+  */ 
 
-	@param CipherTextStream	Buffer of ciphertext to decipher.
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherStream_CFB_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
+{
+	__m512i				ByteMask = _mm512_set1_epi32 ( 0xff );
+	__m512i				PreviousLeft = _mm512_set1_epi32 ( (int)Session->IvHigh32 );
+	__m512i				PreviousRight = _mm512_set1_epi32 ( (int)Session->IvLow32 );
+	__m512i				CipherTextLeft;
+	__m512i				CipherTextRight;
+	__m512i				First;
+	__m512i				Second;
+	__m512i				XLeft;
+	__m512i				XRight;
+	__mmask16			LaneMask;
+	__mmask16			FirstMask;
+	__mmask16			SecondMask;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Preserve the last block of ciphertext as the new initialisation vector for stream based operations, before the plaintext can overwrite it */ 
+
+	Session->IvHigh32 = _BLOWFISH_Load ( CipherTextStream + StreamLength - 2, Swap );
+	Session->IvLow32 = _BLOWFISH_Load ( CipherTextStream + StreamLength - 1, Swap );
+
+	/* Decipher ciphertext in 128-byte groups of 16 blocks */ 
+
+	for ( i = 0; i < StreamLength; i += 32 )
+	{
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
 
-	@param CipherTextStream	Buffer to receive the plaintext.
+		First = _mm512_maskz_loadu_epi32 ( FirstMask, CipherTextStream + i );
+		Second = _mm512_maskz_loadu_epi32 ( SecondMask, CipherTextStream + i + 16 );
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+		_BLOWFISH_DEINTERLEAVE_AVX512 ( CipherTextLeft, CipherTextRight, First, Second );
 
-	@remarks This function can be parallelised using OpenMP.
+		/* Shift the last block of ciphertext of the previous group (or the initialisation vector) into the first lane, and each block of ciphertext into the next lane */ 
 
-  */ 
+		XLeft = _mm512_alignr_epi32 ( CipherTextLeft, PreviousLeft, 15 );
+		XRight = _mm512_alignr_epi32 ( CipherTextRight, PreviousRight, 15 );
 
-static void _BLOWFISH_DecipherStream_ECB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+		/* Encipher the previous blocks of ciphertext */ 
 
-	/* Decipher ciphertext in 8-byte blocks */ 
+		_BLOWFISH_ENCIPHER_AVX512 ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
 
-#ifdef _OPENMP
+		/* XOR the enciphered previous blocks of ciphertext with the current blocks of ciphertext to yeild the plaintext */ 
 
-	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength ) schedule ( static )
+		XRight = _mm512_xor_si512 ( XRight, CipherTextLeft );
+		XLeft = _mm512_xor_si512 ( XLeft, CipherTextRight );
 
-#endif
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, XRight, XLeft );
 
-	for ( i = 0; i < StreamLength; i += 2 )
-	{
-		XLeft = CipherTextStream [ i ];
-		XRight = CipherTextStream [ i + 1 ];
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
+
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i, FirstMask, First );
+		_mm512_mask_storeu_epi32 ( PlainTextStream + i + 16, SecondMask, Second );
 
-		_BLOWFISH_DECIPHER ( PlainTextStream [ i ], PlainTextStream [ i + 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
+		PreviousLeft = CipherTextLeft;
+		PreviousRight = CipherTextRight;
 	}
 
 	return;
@@ -1357,82 +8107,147 @@ static void _BLOWFISH_DecipherStream_ECB ( BLOWFISH_PCONTEXT Context, BLOWFISH_P
 
 	@internal
 
-	Decipher a stream of data in cipher block chaining mode.
+	Encipher/Decipher a stream of data in counter mode, 16 blocks at a time using AVX-512.
 
-	Round 1:
+	See #_BLOWFISH_EncipherDecipherStream_CTR for more information.
 
-	P0 = Dk ( C0 ) XOR ( Iv )
+	@remarks Produces exactly the same keystream as #_BLOWFISH_EncipherDecipherStream_CTR. The final group of fewer than 16 blocks is processed using masked loads, gathers and stores.
 
-	Round n:
+  */ 
 
-	Pn = Dk ( Cn ) XOR ( Cn - 1 )
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherDecipherStream_CTR_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONG		IvHigh32 = Session->IvHigh32;
+	BLOWFISH_ULONG		IvLow32 = Session->IvLow32;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher the initialisation vector added with the counter in groups of 16 blocks */ 
 
-	See @link glossary @endlink for more information.
+#ifdef _OPENMP
 
-	@param Context			Pointer to an initialised context record.
+	#pragma omp parallel for default ( none ) private ( i ) shared ( InStream, OutStream, IvHigh32, IvLow32, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
 
-	@param CipherTextStream	Buffer of ciphertext to decipher.
+#endif
 
-	@param CipherTextStream	Buffer to receive the plaintext.
+	for ( i = 0; i < StreamLength; i += 32 )
+	{
+		__m512i		ByteMask = _mm512_set1_epi32 ( 0xff );
+		__m512i		Counter = _mm512_setr_epi32 ( 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 );
+		__m512i		CounterLeft = _mm512_add_epi32 ( _mm512_set1_epi32 ( (int)( IvHigh32 + (BLOWFISH_ULONG)i ) ), Counter );
+		__m512i		CounterRight = _mm512_add_epi32 ( _mm512_set1_epi32 ( (int)( IvLow32 + (BLOWFISH_ULONG)( i + 1 ) ) ), Counter );
+		__m512i		First;
+		__m512i		Second;
+		__mmask16	LaneMask;
+		__mmask16	FirstMask;
+		__mmask16	SecondMask;
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+		_BLOWFISH_ENCIPHER_AVX512 ( CounterRight, CounterLeft, CounterLeft, CounterRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
 
-	@remarks This function can be parallelised using OpenMP.
+		/* XOR the enciphered counters with the plaintext or ciphertext */ 
 
-  */ 
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, CounterRight, CounterLeft );
 
-static void _BLOWFISH_DecipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
+
+		_mm512_mask_storeu_epi32 ( OutStream + i, FirstMask, _mm512_xor_si512 ( First, _mm512_maskz_loadu_epi32 ( FirstMask, InStream + i ) ) );
+		_mm512_mask_storeu_epi32 ( OutStream + i + 16, SecondMask, _mm512_xor_si512 ( Second, _mm512_maskz_loadu_epi32 ( SecondMask, InStream + i + 16 ) ) );
+	}
+
+	/* Preserve the initialisation vector added with the counter as the new initialisation vector for stream based operations */ 
+
+	Session->IvHigh32 += (BLOWFISH_ULONG)StreamLength;
+	Session->IvLow32 += (BLOWFISH_ULONG)( StreamLength + 1 );
+
+	return;
+}
+
+/**
 
-	/* Decipher the first block of ciphertext */ 
+	@internal
 
-	XLeft = CipherTextStream [ 0 ];
-	XRight = CipherTextStream [ 1 ];
+	Encipher/Decipher a stream of data in counter mode with a 64-bit block counter, 16 blocks at a time using AVX-512.
 
-	_BLOWFISH_DECIPHER ( PlainTextStream [ 0 ], PlainTextStream [ 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
+	See #_BLOWFISH_EncipherDecipherStream_CTR64 for more information.
 
-	/* XOR the deciphered first block with the initialisation vector to yeild the plaintext */ 
+	@remarks Produces exactly the same keystream as #_BLOWFISH_EncipherDecipherStream_CTR64. The final group of fewer than 16 blocks is processed using masked loads, gathers and stores.
 
-	PlainTextStream [ 0 ] ^= Context->IvHigh32;
-	PlainTextStream [ 1 ] ^= Context->IvLow32;
+  */ 
 
-	/* Decrypt any remaining blocks */ 
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherDecipherStream_CTR64_AVX512 ( BLOWFISH_PSESSION Session, BLOWFISH_PCULONG InStream, BLOWFISH_PULONG OutStream, BLOWFISH_SIZE_T StreamLength )
+{
+	BLOWFISH_ULONGLONG	Counter = (BLOWFISH_ULONGLONG)Session->IvHigh32 << 32 | Session->IvLow32;
+	BLOWFISH_ULONGLONG	Block;
+	BLOWFISH_PCULONG	P = Session->KeySchedule->PArray;
+	BLOWFISH_PCULONG	S0 = Session->KeySchedule->SBox [ 0 ];
+	BLOWFISH_PCULONG	S1 = Session->KeySchedule->SBox [ 1 ];
+	BLOWFISH_PCULONG	S2 = Session->KeySchedule->SBox [ 2 ];
+	BLOWFISH_PCULONG	S3 = Session->KeySchedule->SBox [ 3 ];
+	BLOWFISH_ULONG		Swap = Session->SwapBytes;
+	BLOWFISH_SIZE_T		i;
+
+	/* Encipher the counters in groups of 16 blocks */ 
 
 #ifdef _OPENMP
 
-	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength ) schedule ( static )
+	#pragma omp parallel for default ( none ) private ( i, Block ) shared ( InStream, OutStream, Counter, P, S0, S1, S2, S3, StreamLength, Swap ) schedule ( static ) num_threads ( _BLOWFISH_StreamThreads ( Session, StreamLength ) )
 
 #endif
 
-	for ( i = 2; i < StreamLength; i += 2 )
+	for ( i = 0; i < StreamLength; i += 32 )
 	{
-		/* Decipher block of ciphertext */ 
+		__m512i		ByteMask = _mm512_set1_epi32 ( 0xff );
+		__m512i		Base;
+		__m512i		High;
+		__m512i		CounterLeft;
+		__m512i		CounterRight;
+		__m512i		First;
+		__m512i		Second;
+		__mmask16	LaneMask;
+		__mmask16	FirstMask;
+		__mmask16	SecondMask;
+
+		_BLOWFISH_GROUP_MASKS_AVX512 ( StreamLength - i, LaneMask, FirstMask, SecondMask );
 
-		XLeft = CipherTextStream [ i ];
-		XRight = CipherTextStream [ i + 1 ];
+		/* Add the lane index to the low half of the counter, carrying into the high half where it wraps */ 
 
-		_BLOWFISH_DECIPHER ( PlainTextStream [ i ], PlainTextStream [ i + 1 ], XLeft, XRight, P, S0, S1, S2, S3 );
+		Block = Counter + (BLOWFISH_ULONGLONG)( i >> 1 );
+		Base = _mm512_set1_epi32 ( (int)(BLOWFISH_ULONG)Block );
+		High = _mm512_set1_epi32 ( (int)(BLOWFISH_ULONG)( Block >> 32 ) );
+		CounterRight = _mm512_add_epi32 ( Base, _mm512_setr_epi32 ( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+		CounterLeft = _mm512_mask_add_epi32 ( High, _mm512_cmplt_epu32_mask ( CounterRight, Base ), High, _mm512_set1_epi32 ( 1 ) );
 
-		/* XOR the deciphered block with the previous block of ciphertext to yeild the plaintext */ 
+		_BLOWFISH_ENCIPHER_AVX512 ( CounterRight, CounterLeft, CounterLeft, CounterRight, P, S0, S1, S2, S3, ByteMask, LaneMask );
+
+		/* XOR the enciphered counters with the plaintext or ciphertext */ 
+
+		_BLOWFISH_INTERLEAVE_AVX512 ( First, Second, CounterRight, CounterLeft );
+
+		if ( Swap )
+		{
+			_BLOWFISH_BSWAP_AVX512 ( First, Second );
+		}
 
-		PlainTextStream [ i ] ^= CipherTextStream [ i - 2 ];
-		PlainTextStream [ i + 1 ] ^= CipherTextStream [ i - 1 ];
+		_mm512_mask_storeu_epi32 ( OutStream + i, FirstMask, _mm512_xor_si512 ( First, _mm512_maskz_loadu_epi32 ( FirstMask, InStream + i ) ) );
+		_mm512_mask_storeu_epi32 ( OutStream + i + 16, SecondMask, _mm512_xor_si512 ( Second, _mm512_maskz_loadu_epi32 ( SecondMask, InStream + i + 16 ) ) );
 	}
 
-	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
+	/* Preserve the counter of the next block as the new initialisation vector for stream based operations */ 
 
-	Context->IvHigh32 = CipherTextStream [ StreamLength - 2 ];
-	Context->IvLow32 = CipherTextStream [ StreamLength - 1 ];
+	Counter += (BLOWFISH_ULONGLONG)( StreamLength >> 1 );
+
+	Session->IvHigh32 = (BLOWFISH_ULONG)( Counter >> 32 );
+	Session->IvLow32 = (BLOWFISH_ULONG)Counter;
 
 	return;
 }
@@ -1441,156 +8256,215 @@ static void _BLOWFISH_DecipherStream_CBC ( BLOWFISH_PCONTEXT Context, BLOWFISH_P
 
 	@internal
 
-	Decipher a stream of data in cipher feedback mode.
-
-	Round 1:
+	Gather a 32-bit element for each of 16 independent blocks, from a table belonging to each block.
 
-	P0 = C0 XOR Ek ( Iv )
+	@param Result	Vector to receive the element for each block.
 
-	Round n:
+	@param First	Vector of the 64-bit addresses of the tables for blocks 0-7.
 
-	Pn = Cn XOR Ek ( ( Cn - 1 ) )
+	@param Second	Vector of the 64-bit addresses of the tables for blocks 8-15.
 
-	See @link glossary @endlink for more information.
+	@param Index	Vector of the index of the element to gather for each block.
 
-	@param Context			Pointer to an initialised context record.
+  */ 
 
-	@param CipherTextStream	Buffer of ciphertext to decipher.
+#define _BLOWFISH_GATHER_KEYS_AVX512( Result, First, Second, Index )																	\
+{																																		\
+	__m512i	_BLOWFISH_Index = Index;																									\
+																																		\
+	Result = _mm512_inserti64x4 ( _mm512_castsi256_si512 ( _mm512_i64gather_epi32 (													\
+		_mm512_add_epi64 ( First, _mm512_slli_epi64 ( _mm512_cvtepu32_epi64 ( _mm512_castsi512_si256 ( _BLOWFISH_Index ) ), 2 ) ), (void *)0, 1 ) ),	\
+		_mm512_i64gather_epi32 (																										\
+		_mm512_add_epi64 ( Second, _mm512_slli_epi64 ( _mm512_cvtepu32_epi64 ( _mm512_extracti64x4_epi64 ( _BLOWFISH_Index, 1 ) ), 2 ) ), (void *)0, 1 ), 1 );	\
+}
 
-	@param CipherTextStream	Buffer to receive the plaintext.
+/**
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers in 4-byte blocks.
+	@internal
 
-	@remarks It is an unchecked runtime error to supply either a null pointer, or a stream buffer length that is not a multiple of 4 to this function.
+	Perform a single round of the cipher on 16 independent blocks, each with its own key schedule, gathering from the P-Array and S-Boxes of each block's key schedule.
 
-	@remarks This function can be parallelised using OpenMP.
+	See #_BLOWFISH_CIPHER for more information.
 
-  */ 
+	@remarks After each round the caller must swap xL and xR.
 
-static void _BLOWFISH_DecipherStream_CFB ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCULONG CipherTextStream, BLOWFISH_PULONG PlainTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	BLOWFISH_ULONG	XLeft;
-	BLOWFISH_ULONG	XRight;
-	BLOWFISH_PULONG	P = Context->PArray;
-	BLOWFISH_PULONG	S0 = Context->SBox [ 0 ];
-	BLOWFISH_PULONG	S1 = Context->SBox [ 1 ];
-	BLOWFISH_PULONG	S2 = Context->SBox [ 2 ];
-	BLOWFISH_PULONG	S3 = Context->SBox [ 3 ];
-	BLOWFISH_SIZE_T	i;
+	@param XLeft		Vector of the high 32-bits of 16 messages to encipher.
 
-	/* Encipher the initialisation vector */ 
+	@param XRight		Vector of the low 32-bits of 16 messages to encipher.
 
-	XLeft = Context->IvHigh32;
-	XRight = Context->IvLow32;
+	@param PFirst		Vector of the addresses of the P-Arrays for blocks 0-7.
 
-	_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+	@param PSecond		Vector of the addresses of the P-Arrays for blocks 8-15.
 
-	/* XOR enciphered initialisation vector with the ciphertext to yeild the plaintext */ 
+	@param SFirst		Vector of the addresses of the S-Box arrays for blocks 0-7.
 
-	PlainTextStream [ 0 ] = XRight ^ CipherTextStream [ 0 ];
-	PlainTextStream [ 1 ] = XLeft ^ CipherTextStream [ 1 ];
+	@param SSecond		Vector of the addresses of the S-Box arrays for blocks 8-15.
 
-	/* Decrypt any remaining blocks */ 
+	@param ByteMask		Vector with each element set to 0xff.
 
-#ifdef _OPENMP
+	@param Round		Current round to perform (0-15 to encipher, 17-2 to decipher).
 
-	#pragma omp parallel for default ( none ) private ( i, XLeft, XRight ) shared ( PlainTextStream, CipherTextStream, P, S0, S1, S2, S3, StreamLength ) schedule ( static )
+  */ 
 
-#endif
+#define _BLOWFISH_CIPHER_KEYS_AVX512( XLeft, XRight, PFirst, PSecond, SFirst, SSecond, ByteMask, Round )								\
+{																																		\
+	__m512i	_BLOWFISH_P;																												\
+	__m512i	_BLOWFISH_S0;																												\
+	__m512i	_BLOWFISH_S1;																												\
+	__m512i	_BLOWFISH_S2;																												\
+	__m512i	_BLOWFISH_S3;																												\
+																																		\
+	_BLOWFISH_GATHER_KEYS_AVX512 ( _BLOWFISH_P, PFirst, PSecond, _mm512_set1_epi32 ( Round ) );										\
+	XLeft = _mm512_xor_si512 ( XLeft, _BLOWFISH_P );																					\
+	_BLOWFISH_GATHER_KEYS_AVX512 ( _BLOWFISH_S0, SFirst, SSecond, _mm512_srli_epi32 ( XLeft, 24 ) );									\
+	_BLOWFISH_GATHER_KEYS_AVX512 ( _BLOWFISH_S1, SFirst, SSecond, _mm512_add_epi32 ( _mm512_and_si512 ( _mm512_srli_epi32 ( XLeft, 16 ), ByteMask ), _mm512_set1_epi32 ( BLOWFISH_SBOX_ENTRIES ) ) );	\
+	_BLOWFISH_GATHER_KEYS_AVX512 ( _BLOWFISH_S2, SFirst, SSecond, _mm512_add_epi32 ( _mm512_and_si512 ( _mm512_srli_epi32 ( XLeft, 8 ), ByteMask ), _mm512_set1_epi32 ( 2 * BLOWFISH_SBOX_ENTRIES ) ) );	\
+	_BLOWFISH_GATHER_KEYS_AVX512 ( _BLOWFISH_S3, SFirst, SSecond, _mm512_add_epi32 ( _mm512_and_si512 ( XLeft, ByteMask ), _mm512_set1_epi32 ( 3 * BLOWFISH_SBOX_ENTRIES ) ) );	\
+	XRight = _mm512_xor_si512 ( XRight, _mm512_add_epi32 ( _mm512_xor_si512 ( _mm512_add_epi32 ( _BLOWFISH_S0, _BLOWFISH_S1 ), _BLOWFISH_S2 ), _BLOWFISH_S3 ) );	\
+}
 
-	for ( i = 2; i < StreamLength; i += 2 )
-	{
-		/* Encipher the previous block of ciphertext */ 
+/**
 
-		XLeft = CipherTextStream [ i - 2 ];
-		XRight = CipherTextStream [ i - 1 ];
+	@internal
 
-		_BLOWFISH_ENCIPHER ( XRight, XLeft, XLeft, XRight, P, S0, S1, S2, S3 );
+	Load the addresses of the P-Array and S-Box array of each key schedule, for the next group of up to 16 blocks.
 
-		/* XOR the enciphered previous block of ciphertext with the current block ciphertext to yeild the plaintext */ 
+	@param KeySchedules	Array of pointers to the key schedule for each block in the group.
 
-		PlainTextStream [ i ] = XRight ^ CipherTextStream [ i ];
-		PlainTextStream [ i + 1 ] = XLeft ^ CipherTextStream [ i + 1 ];
-	}
+	@param Lanes		Number of blocks in the group (1-16). Inactive lanes use the key schedule of the first block.
 
-	/* Preserve the previous block of ciphertext as the new initialisation vector for stream based operations */ 
+	@param PFirst, PSecond, SFirst, SSecond	Vectors to receive the addresses (see #_BLOWFISH_CIPHER_KEYS_AVX512).
 
-	Context->IvHigh32 = CipherTextStream [ StreamLength - 2 ];
-	Context->IvLow32 = CipherTextStream [ StreamLength - 1 ];
+  */ 
 
-	return;
+#define _BLOWFISH_LOAD_KEYS_AVX512( KeySchedules, Lanes, PFirst, PSecond, SFirst, SSecond )												\
+{																																		\
+	BLOWFISH_ULONGLONG	_BLOWFISH_P [ 16 ];																								\
+	BLOWFISH_ULONGLONG	_BLOWFISH_S [ 16 ];																								\
+	BLOWFISH_SIZE_T		_BLOWFISH_Lane;																									\
+																																		\
+	for ( _BLOWFISH_Lane = 0; _BLOWFISH_Lane < 16; _BLOWFISH_Lane++ )																	\
+	{																																	\
+		BLOWFISH_PCKEY_SCHEDULE	_BLOWFISH_KeySchedule = KeySchedules [ _BLOWFISH_Lane < Lanes ? _BLOWFISH_Lane : 0 ];				\
+																																		\
+		_BLOWFISH_P [ _BLOWFISH_Lane ] = (BLOWFISH_ULONGLONG)(size_t)_BLOWFISH_KeySchedule->PArray;									\
+		_BLOWFISH_S [ _BLOWFISH_Lane ] = (BLOWFISH_ULONGLONG)(size_t)_BLOWFISH_KeySchedule->SBox [ 0 ];								\
+	}																																	\
+																																		\
+	PFirst = _mm512_loadu_si512 ( _BLOWFISH_P );																						\
+	PSecond = _mm512_loadu_si512 ( _BLOWFISH_P + 8 );																					\
+	SFirst = _mm512_loadu_si512 ( _BLOWFISH_S );																						\
+	SSecond = _mm512_loadu_si512 ( _BLOWFISH_S + 8 );																					\
 }
 
-BLOWFISH_RC BLOWFISH_DecipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextStream, BLOWFISH_PUCHAR PlainTextStream, BLOWFISH_SIZE_T StreamLength )
-{
-	/* Ensure the context and stream buffer pointers are non null */ 
+/**
 
-	if ( Context == 0 || CipherTextStream == 0 || PlainTextStream == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
-	}
+	@internal
 
-	/* Ensure the stream length is a multiple of 8 */ 
+	Encipher several blocks, each with its own key schedule, 16 at a time using AVX-512.
 
-	if ( ( StreamLength & ~0x07 ) == 0 )
-	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+	See #_BLOWFISH_EncipherKeys for more information.
 
-#ifdef _OPENMP
+	@remarks Each gather uses a separate 64-bit base address for every lane, so the blocks in a group may use any mix of key schedules. The final group of fewer than 16 blocks is loaded and stored with masks.
 
-	/* Ensure the stream length is not negative */ 
+  */ 
 
-	if ( StreamLength < 0 )
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_EncipherKeys_AVX512 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	__m512i			ByteMask = _mm512_set1_epi32 ( 0xff );
+	__m512i			PFirst;
+	__m512i			PSecond;
+	__m512i			SFirst;
+	__m512i			SSecond;
+	__m512i			XLeft;
+	__m512i			XRight;
+	__m512i			XFinal;
+	__mmask16		LaneMask;
+	BLOWFISH_SIZE_T	Lanes;
+	BLOWFISH_SIZE_T	i;
+	int				Round;
+
+	for ( i = 0; i < Count; i += 16 )
 	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+		Lanes = Count - i < 16 ? Count - i : 16;
+		LaneMask = _BLOWFISH_MASK_AVX512 ( Lanes );
 
-#endif
+		_BLOWFISH_LOAD_KEYS_AVX512 ( ( KeySchedules + i ), Lanes, PFirst, PSecond, SFirst, SSecond );
 
-	/* Decipher stream buffer based on block cipher mode */ 
+		XLeft = _mm512_maskz_loadu_epi32 ( LaneMask, High32 + i );
+		XRight = _mm512_maskz_loadu_epi32 ( LaneMask, Low32 + i );
 
-	Context->DecipherStream ( Context, (BLOWFISH_PCULONG)CipherTextStream, (BLOWFISH_PULONG)PlainTextStream, StreamLength >> 2 );
+		for ( Round = 0; Round < 16; Round += 2 )
+		{
+			_BLOWFISH_CIPHER_KEYS_AVX512 ( XLeft, XRight, PFirst, PSecond, SFirst, SSecond, ByteMask, Round );
+			_BLOWFISH_CIPHER_KEYS_AVX512 ( XRight, XLeft, PFirst, PSecond, SFirst, SSecond, ByteMask, Round + 1 );
+		}
 
-	return BLOWFISH_RC_SUCCESS;
-}
+		/* Finalise round and unswap xL and xR: xR = xR XOR P18, xL = xL XOR P17 */ 
 
-BLOWFISH_RC BLOWFISH_DecipherBuffer ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength )
-{
-	/* Ensure the context and buffer pointers are non null */ 
+		_BLOWFISH_GATHER_KEYS_AVX512 ( XFinal, PFirst, PSecond, _mm512_set1_epi32 ( 16 ) );
+		_mm512_mask_storeu_epi32 ( Low32 + i, LaneMask, _mm512_xor_si512 ( XLeft, XFinal ) );
 
-	if ( Context == 0 || CipherTextBuffer == 0 || PlainTextBuffer == 0 )
-	{
-		return BLOWFISH_RC_INVALID_PARAMETER;
+		_BLOWFISH_GATHER_KEYS_AVX512 ( XFinal, PFirst, PSecond, _mm512_set1_epi32 ( 17 ) );
+		_mm512_mask_storeu_epi32 ( High32 + i, LaneMask, _mm512_xor_si512 ( XRight, XFinal ) );
 	}
 
-	/* Ensure the buffer length is a multiple of 8 */ 
+	return;
+}
 
-	if ( ( BufferLength & ~0x07 ) == 0 )
-	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+/**
 
-#ifdef _OPENMP
+	@internal
 
-	/* Ensure the buffer length is not negative */ 
+	Decipher several blocks, each with its own key schedule, 16 at a time using AVX-512.
 
-	if ( BufferLength < 0 )
+	See #_BLOWFISH_EncipherKeys_AVX512 for more information.
+
+  */ 
+
+static _BLOWFISH_TARGET_AVX512 void _BLOWFISH_DecipherKeys_AVX512 ( const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32, BLOWFISH_SIZE_T Count )
+{
+	__m512i			ByteMask = _mm512_set1_epi32 ( 0xff );
+	__m512i			PFirst;
+	__m512i			PSecond;
+	__m512i			SFirst;
+	__m512i			SSecond;
+	__m512i			XLeft;
+	__m512i			XRight;
+	__m512i			XFinal;
+	__mmask16		LaneMask;
+	BLOWFISH_SIZE_T	Lanes;
+	BLOWFISH_SIZE_T	i;
+	int				Round;
+
+	for ( i = 0; i < Count; i += 16 )
 	{
-		return BLOWFISH_RC_BAD_BUFFER_LENGTH;
-	}
+		Lanes = Count - i < 16 ? Count - i : 16;
+		LaneMask = _BLOWFISH_MASK_AVX512 ( Lanes );
 
-#endif
+		_BLOWFISH_LOAD_KEYS_AVX512 ( ( KeySchedules + i ), Lanes, PFirst, PSecond, SFirst, SSecond );
 
-	/* Decipher buffer as a stream based on the block cipher mode */ 
+		XLeft = _mm512_maskz_loadu_epi32 ( LaneMask, High32 + i );
+		XRight = _mm512_maskz_loadu_epi32 ( LaneMask, Low32 + i );
 
-	_BLOWFISH_BEGINSTREAM ( Context );
+		for ( Round = 17; Round > 1; Round -= 2 )
+		{
+			_BLOWFISH_CIPHER_KEYS_AVX512 ( XLeft, XRight, PFirst, PSecond, SFirst, SSecond, ByteMask, Round );
+			_BLOWFISH_CIPHER_KEYS_AVX512 ( XRight, XLeft, PFirst, PSecond, SFirst, SSecond, ByteMask, Round - 1 );
+		}
 
-	Context->DecipherStream ( Context, (BLOWFISH_PCULONG)CipherTextBuffer, (BLOWFISH_PULONG)PlainTextBuffer, BufferLength >> 2 );
+		/* Finalise round and unswap xL and xR: xR = xR XOR P1, xL = xL XOR P2 */ 
 
-	_BLOWFISH_ENDSTREAM ( Context );
+		_BLOWFISH_GATHER_KEYS_AVX512 ( XFinal, PFirst, PSecond, _mm512_set1_epi32 ( 0 ) );
+		_mm512_mask_storeu_epi32 ( High32 + i, LaneMask, _mm512_xor_si512 ( XRight, XFinal ) );
 
-	return BLOWFISH_RC_SUCCESS;
+		_BLOWFISH_GATHER_KEYS_AVX512 ( XFinal, PFirst, PSecond, _mm512_set1_epi32 ( 1 ) );
+		_mm512_mask_storeu_epi32 ( Low32 + i, LaneMask, _mm512_xor_si512 ( XLeft, XFinal ) );
+	}
+
+	return;
 }
 
+#endif
+
 /** @} */ 
@@ -61,6 +61,8 @@ typedef unsigned int BLOWFISH_ULONG;				/*!< Must be a 32-bit unsigned type. */
 typedef BLOWFISH_ULONG * BLOWFISH_PULONG;			/*!< Must be a pointer to a 32-bit unsigned type. */ 
 typedef const BLOWFISH_ULONG * BLOWFISH_PCULONG;	/*!< Must be a pointer to a constant 32-bit unsigned type. */ 
 
+typedef unsigned long long BLOWFISH_ULONGLONG;		/*!< Must be a 64-bit unsigned type. */ 
+
 /* Note! Altering the size and/or signedness of BLOWFISH_SIZE_T will affect the amount of data that can be enciphed/deciphered! */ 
 
 #ifdef _OPENMP
@@ -82,10 +84,42 @@ typedef enum _BLOWFISH_MODE
 	BLOWFISH_MODE_CBC,								/*!< Cipher block chaining mode (recommended). XOR plaintext block with previous cipher text block before encrypting. This mode cannot be parallelised for encryption. */ 
 	BLOWFISH_MODE_CFB,								/*!< Cipher feedback mode. Plaintext is XOR encrypted with previous block of ciphertext. This mode cannot be parallelised for encryption. */ 
 	BLOWFISH_MODE_OFB,								/*!< Ouput feedback mode. Plaintext is XOR encrypted with enciphered initialisation vector. This mode cannot be parallelised. */ 
-	BLOWFISH_MODE_CTR								/*!< Counter mode. Plaintext is XOR encrypted with enciphered initialisation vector added with a counter. This mode can be parallelised for encryption/decryption. */ 
+	BLOWFISH_MODE_CTR,								/*!< Counter mode. Plaintext is XOR encrypted with enciphered initialisation vector added with a counter. This mode can be parallelised for encryption/decryption. */ 
+	BLOWFISH_MODE_CTR64,							/*!< Counter mode with a 64-bit big-endian block counter (the initialisation vector is the initial counter). Like #BLOWFISH_MODE_CTR this mode can be parallelised, and streams can be positioned with #BLOWFISH_SeekStream. */ 
+	BLOWFISH_MODE_CBC_CS3,							/*!< Cipher block chaining mode with ciphertext stealing (NIST SP 800-38A addendum, variant CS3). Buffers of any length of at least 8 bytes are enciphered without padding or expansion, by swapping the last two blocks of ciphertext and truncating the final block. Only whole buffers can be enciphered/deciphered, not streams. Like #BLOWFISH_MODE_CBC, this mode can be parallelised for decryption. */ 
+	BLOWFISH_MODE_CBC_LANES							/*!< Interleaved cipher block chaining mode. Block n of a buffer is chained from block n - #BLOWFISH_CBC_LANES (each of the #BLOWFISH_CBC_LANES lanes is a separate CBC chain), and the first block of lane j from Ek ( Ek ( Iv ) XOR j ), where j is XORed into the low 32-bits. The lanes allow this mode to be parallelised for encryption as well as decryption. Buffers must be a multiple of 8 bytes, and cannot be streamed. */ 
 
 } BLOWFISH_MODE;
 
+/** Blowfish stream kernels (instruction sets used to implement the encipher/decipher stream callbacks). */ 
+
+typedef enum _BLOWFISH_KERNEL
+{
+	BLOWFISH_KERNEL_AUTO = 0,						/*!< For use only with #BLOWFISH_SetKernel to select the fastest kernel supported by the processor, unless overridden by the BLOWFISH_KERNEL environment variable ("scalar", "interleaved" or "avx512"). */ 
+	BLOWFISH_KERNEL_SCALAR,							/*!< Portable C implementation, processing one block at a time. */ 
+	BLOWFISH_KERNEL_INTERLEAVED,					/*!< Portable C implementation, interleaving the rounds of 4 blocks at a time to hide S-Box load latency (ECB and CTR modes, and CBC and CFB deciphering). */ 
+	BLOWFISH_KERNEL_AVX512							/*!< AVX-512 implementation, processing 16 blocks at a time (ECB and CTR modes, and CBC and CFB deciphering). */ 
+
+} BLOWFISH_KERNEL;
+
+/** Byte orders of the 32-bit halves of each block in stream and buffer data (see #BLOWFISH_SetByteOrder). */ 
+
+typedef enum _BLOWFISH_BYTE_ORDER
+{
+	BLOWFISH_BYTE_ORDER_HOST = 0,					/*!< The byte order of the host (the default). Each half of a block is read from the data as a native 32-bit integer. */ 
+	BLOWFISH_BYTE_ORDER_BIG_ENDIAN					/*!< Big-endian, the standard byte order of Blowfish used by other implementations. Each half of a block is read from the data most significant byte first. */ 
+
+} BLOWFISH_BYTE_ORDER;
+
+/** Blowfish job operations (see #BLOWFISH_JOB). */ 
+
+typedef enum _BLOWFISH_OPERATION
+{
+	BLOWFISH_OPERATION_ENCIPHER = 0,				/*!< Encipher the buffer with #BLOWFISH_EncipherBuffer. */ 
+	BLOWFISH_OPERATION_DECIPHER						/*!< Decipher the buffer with #BLOWFISH_DecipherBuffer. */ 
+
+} BLOWFISH_OPERATION;
+
 /** Blowfish return codes. */ 
 
 typedef enum _BLOWFISH_RC
@@ -98,6 +132,13 @@ typedef enum _BLOWFISH_RC
 	BLOWFISH_RC_INVALID_MODE,						/*!< The mode specified to the #BLOWFISH_Init/#BLOWFISH_Reset function is not supported. */ 
 	BLOWFISH_RC_TEST_FAILED,						/*!< Self test failed. For more information see stdout (only used by test applications). */ 
 	BLOWFISH_RC_ERROR,								/*!< Generic error (only used by test applications). */ 
+	BLOWFISH_RC_KERNEL_NOT_SUPPORTED,				/*!< The kernel specified to the #BLOWFISH_SetKernel function was not compiled in, or is not supported by the processor. */ 
+	BLOWFISH_RC_CACHE_FULL,							/*!< Every entry in the key cache supplied to #BLOWFISH_AcquireKeySchedule is in use, so the key schedule could not be cached. */ 
+	BLOWFISH_RC_INVALID_HASH,						/*!< The hash string supplied to #BLOWFISH_BcryptVerify is malformed, or its version or cost is not supported. */ 
+	BLOWFISH_RC_HASH_MISMATCH,						/*!< The password supplied to #BLOWFISH_BcryptVerify does not match the hash. */ 
+	BLOWFISH_RC_QUEUE_FULL,							/*!< Every slot in the job queue supplied to #BLOWFISH_SubmitJob is in use, so the job could not be queued. */ 
+	BLOWFISH_RC_PENDING,							/*!< The job supplied to #BLOWFISH_PollJob has not completed yet. */ 
+	BLOWFISH_RC_BAD_PADDING,						/*!< The final block deciphered by #BLOWFISH_DecipherBufferPadded does not end with valid PKCS#7 padding. */ 
 
 } BLOWFISH_RC;
 
@@ -110,21 +151,189 @@ typedef enum _BLOWFISH_RC
 #define BLOWFISH_MIN_KEY_LENGTH			4			/*!< Maximum length of a key (4-bytes, or 32-bits). */ 
 #define BLOWFISH_MAX_KEY_LENGTH			56			/*!< Maximum length of a key (56-bytes, or 448-bits). */ 
 
-/** Blowfish context record. */ 
+#define BLOWFISH_DEFAULT_PARALLEL_THRESHOLD	16384	/*!< Default minimum number of bytes processed by each thread of a parallelised stream function (see #BLOWFISH_SetParallelThreshold). */ 
 
-typedef struct _BLOWFISH_CONTEXT
+#define BLOWFISH_CBC_LANES				64			/*!< Number of interleaved chains of #BLOWFISH_MODE_CBC_LANES. */ 
+
+#define BLOWFISH_BCRYPT_MAX_KEY_LENGTH	72			/*!< Maximum length of a bcrypt password (longer passwords are truncated). */ 
+#define BLOWFISH_BCRYPT_SALT_LENGTH		16			/*!< Length of a bcrypt salt. */ 
+#define BLOWFISH_BCRYPT_HASH_LENGTH		61			/*!< Length of a bcrypt hash string, including the terminating null. */ 
+#define BLOWFISH_BCRYPT_MIN_COST		4			/*!< Minimum bcrypt cost. */ 
+#define BLOWFISH_BCRYPT_MAX_COST		31			/*!< Maximum bcrypt cost. */ 
+
+#define BLOWFISH_PADDED_LENGTH( Length )	( ( ( Length ) & ~(BLOWFISH_SIZE_T)0x07 ) + 8 )	/*!< Length of the ciphertext produced by #BLOWFISH_EncipherBufferPadded from Length bytes of plaintext. */ 
+
+/* Alignment of the key schedule, so that it starts on a cache line and is never shared with per-stream state. */ 
+
+#if defined ( _MSC_VER )
+
+#define BLOWFISH_ALIGN( Bytes )	__declspec ( align ( Bytes ) )
+
+#elif defined ( __GNUC__ )
+
+#define BLOWFISH_ALIGN( Bytes )	__attribute__ ( ( aligned ( Bytes ) ) )
+
+#else
+
+#define BLOWFISH_ALIGN( Bytes )
+
+#endif
+
+/** Blowfish key schedule (expanded key). Once initialised it is only read, and may be shared by any number of sessions and threads. */ 
+
+typedef struct BLOWFISH_ALIGN ( 64 ) _BLOWFISH_KEY_SCHEDULE
 {
 	BLOWFISH_ULONG	PArray [ BLOWFISH_SUBKEYS ];						/*!< Original P-Array which has been XOR'd with the key, and overwritten with output from #BLOWFISH_Encipher. */ 
 	BLOWFISH_ULONG	SBox [ BLOWFISH_SBOXES ] [ BLOWFISH_SBOX_ENTRIES ];	/*!< Original S-Boxes which have been overwritten with output from #BLOWFISH_Encipher. */ 
-	BLOWFISH_ULONG	OriginalIvHigh32;									/*!< Original high 32-bytes of the initialisation vector. */ 
-	BLOWFISH_ULONG	OriginalIvLow32;									/*!< Original low 32-bytes of the initialisation vector. */ 
-	BLOWFISH_ULONG	IvHigh32;											/*!< Current high 32-bytes of the initialisation vector (used for stream operations). */ 
-	BLOWFISH_ULONG	IvLow32;											/*!< Current low 32-bytes of the initialisation vector (used for stream operations). */ 
-	void			( *EncipherStream ) ( );							/*!< Pointer to a callback function to perform the encipher based on the block cipher mode */ 
-	void			( *DecipherStream ) ( );							/*!< Pointer to a callback function to perform the decipher based on the block cipher mode */ 
+ 
+} BLOWFISH_KEY_SCHEDULE, *BLOWFISH_PKEY_SCHEDULE;
+
+typedef const BLOWFISH_KEY_SCHEDULE * BLOWFISH_PCKEY_SCHEDULE;			/*!< Pointer to a constant key schedule. */ 
+
+/** Blowfish keystream record (a ring of #BLOWFISH_MODE_OFB keystream, generated ahead of use by a producer thread for the session it is attached to). Treat as opaque. */ 
+
+typedef struct BLOWFISH_ALIGN ( 64 ) _BLOWFISH_KEYSTREAM
+{
+	volatile BLOWFISH_ULONG		Produced;								/*!< Number of blocks of keystream generated. */ 
+	BLOWFISH_UCHAR				ProducedPadding [ 60 ];					/*!< Keeps the producer and consumer on separate cache lines. */ 
+	volatile BLOWFISH_ULONG		Consumed;								/*!< Number of blocks of keystream taken (or discarded) by the session. */ 
+	BLOWFISH_UCHAR				ConsumedPadding [ 60 ];					/*!< Keeps the producer and consumer on separate cache lines. */ 
+	BLOWFISH_PULONG				Blocks;									/*!< Caller supplied array of blocks (the high then low 32-bits of each). */ 
+	BLOWFISH_ULONG				BlockMask;								/*!< Number of blocks - 1. */ 
+	BLOWFISH_PCKEY_SCHEDULE		KeySchedule;							/*!< Key schedule of the attached session, or null if not attached. */ 
+	BLOWFISH_ULONG				ProducedHigh32;							/*!< High 32-bits of the last block generated. */ 
+	BLOWFISH_ULONG				ProducedLow32;							/*!< Low 32-bits of the last block generated. */ 
+	BLOWFISH_ULONG				ConsumedHigh32;							/*!< High 32-bits of the last block taken. */ 
+	BLOWFISH_ULONG				ConsumedLow32;							/*!< Low 32-bits of the last block taken. */ 
+ 
+} BLOWFISH_KEYSTREAM, *BLOWFISH_PKEYSTREAM;
+
+/** Blowfish session record (per-stream state, referencing a shared key schedule). */ 
+
+typedef struct _BLOWFISH_SESSION
+{
+	BLOWFISH_PCKEY_SCHEDULE	KeySchedule;								/*!< Key schedule used to encipher/decipher data. Must remain valid for the lifetime of the session. */ 
+	BLOWFISH_ULONG			OriginalIvHigh32;							/*!< Original high 32-bytes of the initialisation vector. */ 
+	BLOWFISH_ULONG			OriginalIvLow32;							/*!< Original low 32-bytes of the initialisation vector. */ 
+	BLOWFISH_ULONG			IvHigh32;									/*!< Current high 32-bytes of the initialisation vector (used for stream operations). */ 
+	BLOWFISH_ULONG			IvLow32;									/*!< Current low 32-bytes of the initialisation vector (used for stream operations). */ 
+	BLOWFISH_MODE			Mode;										/*!< Block cipher mode. */ 
+	BLOWFISH_ULONG			MaxThreads;									/*!< Maximum number of threads used by each stream/buffer call (0 for no limit other than the library's budget). */ 
+	BLOWFISH_ULONG			Threads;									/*!< Number of threads used by the last stream/buffer call. */ 
+	void					( *EncipherStream ) ( );					/*!< Pointer to a callback function to perform the encipher based on the block cipher mode */ 
+	void					( *DecipherStream ) ( );					/*!< Pointer to a callback function to perform the decipher based on the block cipher mode */ 
+	BLOWFISH_ULONG			PendingBlock [ 2 ];							/*!< Partial block carried between stream calls (buffered data for #BLOWFISH_MODE_ECB/#BLOWFISH_MODE_CBC, otherwise keystream whose used bytes hold the ciphertext). */ 
+	BLOWFISH_ULONG			PendingLength;								/*!< Number of bytes of PendingBlock buffered or used (0-7). */ 
+	BLOWFISH_ULONG			SwapBytes;									/*!< Non-zero if stream data is byte swapped as it is loaded and stored (see #BLOWFISH_SetByteOrder). */ 
+	BLOWFISH_PKEYSTREAM		Keystream;									/*!< Keystream record attached by #BLOWFISH_AttachKeystream, or null. */ 
+ 
+} BLOWFISH_SESSION, *BLOWFISH_PSESSION;
+
+/** Blowfish context record (a key schedule and a session bound to it). */ 
+
+typedef struct _BLOWFISH_CONTEXT
+{
+	BLOWFISH_KEY_SCHEDULE	KeySchedule;								/*!< Key schedule initialised by #BLOWFISH_Init/#BLOWFISH_Reset. */ 
+	BLOWFISH_SESSION		Session;									/*!< Session bound to KeySchedule (on its own cache line, as the key schedule is padded to a multiple of 64 bytes). */ 
  
 } BLOWFISH_CONTEXT, *BLOWFISH_PCONTEXT;
 
+/** Blowfish key cache entry (an expanded key schedule, and the key it was expanded from). Treat as opaque. */ 
+
+typedef struct _BLOWFISH_KEY_CACHE_ENTRY
+{
+	BLOWFISH_KEY_SCHEDULE	KeySchedule;								/*!< Expanded key schedule (must be the first member). */ 
+	BLOWFISH_UCHAR			Key [ BLOWFISH_MAX_KEY_LENGTH ];			/*!< Key that the key schedule was expanded from. */ 
+	BLOWFISH_SIZE_T			KeyLength;									/*!< Length of the key, or 0 if the entry is unused. */ 
+	BLOWFISH_ULONG			Hash;										/*!< Hash of the key. */ 
+	BLOWFISH_SIZE_T			References;									/*!< Number of outstanding #BLOWFISH_AcquireKeySchedule calls (the entry cannot be evicted while non-zero). */ 
+	BLOWFISH_SIZE_T			Bucket;										/*!< Index + 1 of the first entry in the hash bucket with the same index as this entry, or 0 if the bucket is empty. */ 
+	BLOWFISH_SIZE_T			NextInBucket;								/*!< Index + 1 of the next entry in the same hash bucket, or 0. */ 
+	BLOWFISH_SIZE_T			Newer;										/*!< Index + 1 of the next most recently used entry, or 0. */ 
+	BLOWFISH_SIZE_T			Older;										/*!< Index + 1 of the next least recently used entry, or 0. */ 
+ 
+} BLOWFISH_KEY_CACHE_ENTRY, *BLOWFISH_PKEY_CACHE_ENTRY;
+
+/** Blowfish key cache statistics. */ 
+
+typedef struct _BLOWFISH_KEY_CACHE_STATISTICS
+{
+	BLOWFISH_ULONGLONG		Hits;										/*!< Number of lookups satisfied by a cached key schedule. */ 
+	BLOWFISH_ULONGLONG		Misses;										/*!< Number of lookups that expanded the key. */ 
+	BLOWFISH_ULONGLONG		Evictions;									/*!< Number of key schedules evicted (and wiped) to make room for another key. */ 
+	BLOWFISH_SIZE_T			EntriesUsed;								/*!< Number of entries currently holding a key schedule. */ 
+	BLOWFISH_SIZE_T			EntryCount;									/*!< Capacity of the cache. */ 
+ 
+} BLOWFISH_KEY_CACHE_STATISTICS, *BLOWFISH_PKEY_CACHE_STATISTICS;
+
+/** Blowfish key cache record (a bounded, least recently used cache of key schedules). Treat as opaque. */ 
+
+typedef struct _BLOWFISH_KEY_CACHE
+{
+	void * volatile					Lock;								/*!< Spin lock protecting the cache (null when unlocked). */ 
+	BLOWFISH_PKEY_CACHE_ENTRY		Entries;							/*!< Caller supplied array of entries. */ 
+	BLOWFISH_SIZE_T					EntryCount;							/*!< Number of entries in the array. */ 
+	BLOWFISH_SIZE_T					Newest;								/*!< Index + 1 of the most recently used entry, or 0 if the cache is empty. */ 
+	BLOWFISH_SIZE_T					Oldest;								/*!< Index + 1 of the least recently used entry, or 0 if the cache is empty. */ 
+	BLOWFISH_KEY_CACHE_STATISTICS	Statistics;							/*!< Hit/miss counters. */ 
+ 
+} BLOWFISH_KEY_CACHE, *BLOWFISH_PKEY_CACHE;
+
+/** Callback run by an executor for a range of iterations of a parallel loop. The range is [Begin, End). */ 
+
+typedef void ( *BLOWFISH_PARALLEL_BODY ) ( void * BodyContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End );
+
+/** Callback that runs a parallel loop on an executor (see #BLOWFISH_EXECUTOR). */ 
+
+typedef void ( *BLOWFISH_PARALLEL_FOR ) ( void * ExecutorContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End, BLOWFISH_SIZE_T Grain, BLOWFISH_PARALLEL_BODY Body, void * BodyContext );
+
+/** Blowfish executor record (a caller supplied task system used to parallelise the library, see #BLOWFISH_SetExecutor). */ 
+
+typedef struct _BLOWFISH_EXECUTOR
+{
+	BLOWFISH_PARALLEL_FOR	ParallelFor;								/*!< Must call Body for disjoint ranges which together cover [Begin, End), each at least Grain iterations long (except perhaps the last), and return once every call has returned. The calls may be made concurrently from any thread, including the calling thread. */ 
+	void *					Context;									/*!< Caller defined value passed to ParallelFor. */ 
+ 
+} BLOWFISH_EXECUTOR, *BLOWFISH_PEXECUTOR;
+
+typedef const BLOWFISH_EXECUTOR * BLOWFISH_PCEXECUTOR;					/*!< Pointer to a constant executor record. */ 
+
+/** Blowfish job record (a buffer to encipher/decipher asynchronously, see #BLOWFISH_SubmitJob). */ 
+
+typedef struct _BLOWFISH_JOB
+{
+	BLOWFISH_PCONTEXT		Context;									/*!< Context record to encipher/decipher the buffer with, or null if Session is set. Must not be used by anything else until the job completes. */ 
+	BLOWFISH_PSESSION		Session;									/*!< Session record to encipher/decipher the buffer with instead of a context record (see #BLOWFISH_InitSession), or null. Must not be used by anything else until the job completes. */ 
+	BLOWFISH_OPERATION		Operation;									/*!< Whether to encipher or decipher the buffer. */ 
+	BLOWFISH_PCUCHAR		InBuffer;									/*!< Buffer to encipher/decipher. */ 
+	BLOWFISH_PUCHAR			OutBuffer;									/*!< Buffer to receive the result (may be the same as InBuffer, see #BLOWFISH_EncipherBuffer). */ 
+	BLOWFISH_SIZE_T			BufferLength;								/*!< Length of both buffers in bytes. */ 
+	volatile BLOWFISH_RC	ReturnCode;									/*!< #BLOWFISH_RC_PENDING until the job completes, then the return code of the encipher/decipher (see #BLOWFISH_PollJob). */ 
+ 
+} BLOWFISH_JOB, *BLOWFISH_PJOB;
+
+/** Blowfish job queue slot. Treat as opaque. */ 
+
+typedef struct _BLOWFISH_JOB_QUEUE_SLOT
+{
+	volatile BLOWFISH_ULONG	Sequence;									/*!< Position of the queue the slot is ready to be written (or, plus 1, read) at. */ 
+	BLOWFISH_PJOB			Job;										/*!< Job held by the slot. */ 
+ 
+} BLOWFISH_JOB_QUEUE_SLOT, *BLOWFISH_PJOB_QUEUE_SLOT;
+
+/** Blowfish job queue record (a bounded, lock-free queue of jobs shared by any number of submitting and worker threads). Treat as opaque. */ 
+
+typedef struct BLOWFISH_ALIGN ( 64 ) _BLOWFISH_JOB_QUEUE
+{
+	volatile BLOWFISH_ULONG		Head;									/*!< Position the next job is submitted at. */ 
+	BLOWFISH_UCHAR				HeadPadding [ 60 ];						/*!< Keeps submitting and worker threads on separate cache lines. */ 
+	volatile BLOWFISH_ULONG		Tail;									/*!< Position the next job is taken from. */ 
+	BLOWFISH_UCHAR				TailPadding [ 60 ];						/*!< Keeps submitting and worker threads on separate cache lines. */ 
+	BLOWFISH_PJOB_QUEUE_SLOT	Slots;									/*!< Caller supplied array of slots. */ 
+	BLOWFISH_ULONG				SlotMask;								/*!< Number of slots - 1. */ 
+ 
+} BLOWFISH_JOB_QUEUE, *BLOWFISH_PJOB_QUEUE;
+
 /* Function prototypes. */ 
 
 /**
@@ -135,7 +344,7 @@ typedef struct _BLOWFISH_CONTEXT
 
 	@param Key			Pointer to a key to use for enciphering/deciphering data.
 
-	@param KeyLength	Length of the key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes (sizeof(#BLOWFISH_CONTEXT::PArray)), or be less than #BLOWFISH_MIN_KEY_LENGTH bytes.
+	@param KeyLength	Length of the key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes (sizeof(#BLOWFISH_KEY_SCHEDULE::PArray)), or be less than #BLOWFISH_MIN_KEY_LENGTH bytes.
 
 	@param Mode			Mode to use when enciphering/decipering blocks. For supported modes see #BLOWFISH_MODE
 
@@ -169,7 +378,7 @@ BLOWFISH_RC BLOWFISH_Init ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLO
 
 	@param Key			Pointer to a new key to use for enciphering/deciphering data. (May be null to re-use the current key).
 
-	@param KeyLength	Length of the new key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes (sizeof(#BLOWFISH_CONTEXT::PArray)), or be less than #BLOWFISH_MIN_KEY_LENGTH bytes. (May be 0 if Key is null).
+	@param KeyLength	Length of the new key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes (sizeof(#BLOWFISH_KEY_SCHEDULE::PArray)), or be less than #BLOWFISH_MIN_KEY_LENGTH bytes. (May be 0 if Key is null).
 
 	@param Mode			New mode to use when enciphering/decipering blocks. Use #BLOWFISH_MODE_CURRENT to re-use the current mode and initialisation vector. For supported modes see #BLOWFISH_MODE.
 
@@ -179,6 +388,8 @@ BLOWFISH_RC BLOWFISH_Init ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLO
 
 	@remarks See #BLOWFISH_Init remarks.
 
+	@remarks If a new key or mode is specified, any keystream record attached to the context record (see #BLOWFISH_AttachKeystream) is detached and its ring wiped.
+
 	@return #BLOWFISH_RC_SUCCESS			Reinitialised the context record successfully.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	The context record pointer is null.
@@ -259,14 +470,110 @@ BLOWFISH_RC BLOWFISH_BeginStream ( BLOWFISH_PCONTEXT Context );
 
 	@remarks After calling BLOWFISH_EndStream, the context record may be used in non-stream based functions without risking corruption. (See #BLOWFISH_BeginStream remarks)
 
+	@remarks Any partial block held by the context record (see #BLOWFISH_GetStreamPending) is discarded.
+
 	@return #BLOWFISH_RC_SUCCESS			Sensitive data was cleared from the context record successfully.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied context record pointer is null.
 
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	A #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC stream ended part way through a block, and the buffered bytes were discarded (sensitive data was still cleared).
+
   */ 
 
 BLOWFISH_RC BLOWFISH_EndStream ( BLOWFISH_PCONTEXT Context );
 
+/**
+
+	Position a stream at a byte offset from its start, so that part of a stream can be enciphered/deciphered without processing the data before it.
+
+	@param Context		Pointer to an initialised context record.
+
+	@param ByteOffset	Offset from the start of the stream (for #BLOWFISH_MODE_ECB, a multiple of 8).
+
+	@remarks Only #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CTR64 streams can be positioned. The next call to #BLOWFISH_EncipherStream/#BLOWFISH_DecipherStream processes data starting at ByteOffset, and any partial block held by the context record is discarded. A #BLOWFISH_MODE_CTR64 stream positioned within a block generates the keystream of that block, and uses it from ByteOffset on.
+
+	@remarks Each thread can position its own copy of a context record (see #BLOWFISH_CloneContext) to process separate ranges of the same stream in parallel.
+
+	@return #BLOWFISH_RC_SUCCESS			The stream was positioned successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied context record pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The offset of a #BLOWFISH_MODE_ECB stream is not a multiple of 8.
+
+	@return #BLOWFISH_RC_INVALID_MODE		Streams in the mode used to initialise the context record cannot be positioned.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SeekStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_ULONGLONG ByteOffset );
+
+/**
+
+	Limit the number of threads used by each call to encipher/decipher a stream or buffer with a context record.
+
+	@param Context		Pointer to an initialised context record.
+
+	@param MaxThreads	Maximum number of threads, including the calling thread (0 for no limit other than the library's budget, 1 to always process data on the calling thread).
+
+	@remarks Without a limit, parallelised calls share a budget of OpenMP's maximum number of threads between all calling threads. A call made while other calls hold the budget uses fewer threads, down to the calling thread alone, and calls made from within a parallel region never add threads. Applications that already run one thread per core may prefer a limit of 1.
+
+	@remarks The limit is cleared whenever the mode of the context record is set (see #BLOWFISH_Init/#BLOWFISH_Reset).
+
+	@return #BLOWFISH_RC_SUCCESS			The limit was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied context record pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetThreads ( BLOWFISH_PCONTEXT Context, BLOWFISH_ULONG MaxThreads );
+
+/**
+
+	Select the byte order of the data enciphered/deciphered with a context record.
+
+	@param Context		Pointer to an initialised context record.
+
+	@param ByteOrder	Byte order of the 32-bit halves of each block in stream and buffer data.
+
+	@remarks With #BLOWFISH_BYTE_ORDER_BIG_ENDIAN, the output matches other implementations of Blowfish on any host. Data is byte swapped (if the host is little-endian) as it is loaded and stored by the stream callbacks, so no extra pass over the data is needed. Initialisation vectors and the blocks passed to #BLOWFISH_Encipher/#BLOWFISH_Decipher are integers, and are not affected.
+
+	@remarks Stream and buffer data may be at any alignment, in either byte order.
+
+	@remarks The byte order is reset to #BLOWFISH_BYTE_ORDER_HOST whenever the mode of the context record is set (see #BLOWFISH_Init/#BLOWFISH_Reset).
+
+	@return #BLOWFISH_RC_SUCCESS			The byte order was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied context record pointer is null, or the byte order is invalid.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetByteOrder ( BLOWFISH_PCONTEXT Context, BLOWFISH_BYTE_ORDER ByteOrder );
+
+/**
+
+	Retrieve the number of threads used by the last call to encipher/decipher a stream or buffer with a context record.
+
+	@param Context	Pointer to an initialised context record.
+
+	@return Number of threads requested from OpenMP, including the calling thread (1 if the data was processed by the calling thread alone), or 0 if the context record pointer is null. If an executor is registered (see #BLOWFISH_SetExecutor), the number of ranges the executor ran instead.
+
+  */ 
+
+BLOWFISH_ULONG BLOWFISH_GetThreadsUsed ( BLOWFISH_PCONTEXT Context );
+
+/**
+
+	Retrieve the number of bytes of a stream processed since its last whole block.
+
+	@param Context	Pointer to an initialised context record.
+
+	@remarks For #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC streams, this is the number of bytes buffered by the context record, which will be output by the call to #BLOWFISH_EncipherStream/#BLOWFISH_DecipherStream that completes the block. For other modes, it is the offset into the current block of keystream.
+
+	@return Number of bytes (0-7), or 0 if the context record pointer is null.
+
+  */ 
+
+BLOWFISH_ULONG BLOWFISH_GetStreamPending ( BLOWFISH_PCONTEXT Context );
+
 /**
 
 	Encipher an 8-byte block of data.
@@ -293,17 +600,19 @@ void BLOWFISH_Encipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOW
 
 	@param CipherTextStream	Pointer to a buffer within the stream to receive the enciphered data.
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers. Must be a multiple of 8.
+	@param StreamLength		Length of the plaintext stream buffer. May be any non-zero length.
 
-	@remarks The PlainTextStream and CipherTextStream pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CTR.
+	@remarks The stream may be divided into buffers of any length. For #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC, the bytes following the last whole block are buffered by the context record, and CipherTextStream receives only whole blocks: the number of bytes pending from the previous call (see #BLOWFISH_GetStreamPending) plus StreamLength, rounded down to a multiple of 8. For other modes, CipherTextStream receives StreamLength bytes.
 
-	@remarks The PlainTextStream and CipherTextStream pointers must point to an offset within the stream that is a multiple of 8.
+	@remarks The PlainTextStream and CipherTextStream pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_CTR or #BLOWFISH_MODE_CTR64, or #BLOWFISH_MODE_ECB while no bytes are pending.
 
 	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record or one of the stream buffer pointer is null.
 
-	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is not a multiple of 8.
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is zero.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The context record was initialised with #BLOWFISH_MODE_CBC_CS3 or #BLOWFISH_MODE_CBC_LANES, which cannot be streamed.
 
   */ 
 
@@ -319,15 +628,15 @@ BLOWFISH_RC BLOWFISH_EncipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHA
 
 	@param CipherTextBuffer	Pointer to a buffer to receive the enciphered data.
 
-	@param BufferLength		Length of the plaintext and ciphertext buffers. Must be a multiple of 8.
+	@param BufferLength		Length of the plaintext and ciphertext buffers. Must be a multiple of 8, or for #BLOWFISH_MODE_CBC_CS3 at least 8.
 
-	@remarks The PlainTextBuffer and CipherTextBuffer pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CTR.
+	@remarks The PlainTextBuffer and CipherTextBuffer pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB, #BLOWFISH_MODE_CTR or #BLOWFISH_MODE_CTR64. They may also be equal for #BLOWFISH_MODE_CBC_CS3 and #BLOWFISH_MODE_CBC_LANES.
 
 	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record or one of the buffer pointer is null.
 
-	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a multiple of 8.
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8 (or for #BLOWFISH_MODE_CBC_CS3 is less than 8).
 
   */ 
 
@@ -359,17 +668,19 @@ void BLOWFISH_Decipher ( BLOWFISH_PCONTEXT Context, BLOWFISH_PULONG High32, BLOW
 
 	@param PlainTextStream	Pointer to a buffer within the stream to receive the deciphered data.
 
-	@param StreamLength		Length of the plaintext and ciphertext stream buffers. Must be a multiple of 8.
+	@param StreamLength		Length of the ciphertext stream buffer. May be any non-zero length.
 
-	@remarks The PlainTextStream and CipherTextStream pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CTR.
+	@remarks The stream may be divided into buffers of any length. For #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC, the bytes following the last whole block are buffered by the context record, and PlainTextStream receives only whole blocks: the number of bytes pending from the previous call (see #BLOWFISH_GetStreamPending) plus StreamLength, rounded down to a multiple of 8. For other modes, PlainTextStream receives StreamLength bytes.
 
-	@remarks The PlainTextStream and CipherTextStream pointers must point to an offset within the stream that is a multiple of 8.
+	@remarks The PlainTextStream and CipherTextStream pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_CTR or #BLOWFISH_MODE_CTR64, or #BLOWFISH_MODE_ECB while no bytes are pending. They may also be equal (deciphering in place) for #BLOWFISH_MODE_CFB, and for #BLOWFISH_MODE_CBC while no bytes are pending.
 
 	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record or one of the stream buffer pointer is null.
 
-	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is not a multiple of 8.
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is zero.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The context record was initialised with #BLOWFISH_MODE_CBC_CS3 or #BLOWFISH_MODE_CBC_LANES, which cannot be streamed.
 
   */ 
 
@@ -385,20 +696,1018 @@ BLOWFISH_RC BLOWFISH_DecipherStream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHA
 
 	@param PlainTextBuffer	Pointer to a buffer to receive the deciphered data.
 
-	@param BufferLength		Length of the ciphertext and plaintext buffers. Must be a multiple of 8.
+	@param BufferLength		Length of the ciphertext and plaintext buffers. Must be a multiple of 8, or for #BLOWFISH_MODE_CBC_CS3 at least 8.
 
-	@remarks The PlainTextBuffer and CipherTextBuffer pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CTR.
+	@remarks The PlainTextBuffer and CipherTextBuffer pointers may overlap if the mode used to initialise the context was either #BLOWFISH_MODE_ECB, #BLOWFISH_MODE_CTR or #BLOWFISH_MODE_CTR64. They may also be equal (deciphering in place) for #BLOWFISH_MODE_CBC, #BLOWFISH_MODE_CFB, #BLOWFISH_MODE_CBC_CS3 and #BLOWFISH_MODE_CBC_LANES.
 
 	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
 
 	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record or one of the buffer pointer is null.
 
-	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a multiple of 8.
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8 (or for #BLOWFISH_MODE_CBC_CS3 is less than 8).
 
   */ 
 
 BLOWFISH_RC BLOWFISH_DecipherBuffer ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength );
 
+/**
+
+	Encipher a buffer of data of any length, padding it to a whole number of blocks as described by PKCS#7.
+
+	@param Context			Pointer to a context record initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+	@param PlainTextBuffer	Pointer to a buffer of data to encipher.
+
+	@param CipherTextBuffer	Pointer to a buffer to receive the enciphered data, of at least #BLOWFISH_PADDED_LENGTH ( PlainTextLength ) bytes.
+
+	@param PlainTextLength	Length of the plaintext buffer. May be any length, including zero.
+
+	@remarks 1-8 bytes of padding are appended, each holding the number of bytes of padding. The whole blocks of plaintext are enciphered directly from PlainTextBuffer, and only the final block is assembled separately, so no padded copy of the plaintext is needed.
+
+	@remarks The PlainTextBuffer and CipherTextBuffer pointers may be the same (enciphering in place), provided the buffer is large enough to receive the ciphertext.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record or one of the buffer pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The context record was not initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherBufferPadded ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T PlainTextLength );
+
+/**
+
+	Decipher a buffer of data enciphered by #BLOWFISH_EncipherBufferPadded, verifying and removing the padding.
+
+	@param Context			Pointer to a context record initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+	@param CipherTextBuffer	Pointer to a buffer of data to decipher.
+
+	@param PlainTextBuffer	Pointer to a buffer to receive the deciphered data, of at least BufferLength - 1 bytes.
+
+	@param BufferLength		Length of the ciphertext buffer. Must be a non-zero multiple of 8.
+
+	@param PlainTextLength	Pointer to receive the length of the plaintext, without the padding.
+
+	@remarks Only the plaintext is written to PlainTextBuffer: the final block is deciphered and its padding verified separately.
+
+	@remarks The PlainTextBuffer and CipherTextBuffer pointers may overlap under the same conditions as #BLOWFISH_DecipherBuffer.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully deciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record, one of the buffer pointer or the length pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The context record was not initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8.
+
+	@return #BLOWFISH_RC_BAD_PADDING		The padding is invalid, so the ciphertext is corrupt or the key is wrong. The contents of the plaintext buffer are undefined.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherBufferPadded ( BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength, BLOWFISH_SIZE_T * PlainTextLength );
+
+/**
+
+	Initialise a key schedule, for use by one or more sessions.
+
+	@param KeySchedule	Pointer to a key schedule to initialise.
+
+	@param Key			Pointer to a key to use for enciphering/deciphering data.
+
+	@param KeyLength	Length of the key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes, or be less than #BLOWFISH_MIN_KEY_LENGTH bytes.
+
+	@remarks The key schedule is not modified by any other function, so may be shared between sessions in any number of threads without copying.
+
+	@remarks Allocate key schedules on a 64-byte boundary for best performance.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised the key schedule successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the key schedule or key pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_KEY		The key is either too short or too long.
+
+	@return #BLOWFISH_RC_WEAK_KEY			The key has been deemed to be weak.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitKeySchedule ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength );
+
+/**
+
+	Clear a key schedule.
+
+	@param KeySchedule	Pointer to a key schedule to overwrite.
+
+	@remarks All sessions using the key schedule must be finished with before calling this function.
+
+	@return #BLOWFISH_RC_SUCCESS			The key schedule was overwritten successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied key schedule pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_ExitKeySchedule ( BLOWFISH_PKEY_SCHEDULE KeySchedule );
+
+/**
+
+	Initialise (or reinitialise) a session record to encipher/decipher data with a shared key schedule.
+
+	@param Session		Pointer to a session record to initialise.
+
+	@param KeySchedule	Pointer to an initialised key schedule, which must remain valid until the session is no longer used.
+
+	@param Mode			Mode to use when enciphering/decipering blocks. For supported modes see #BLOWFISH_MODE (#BLOWFISH_MODE_CURRENT is not supported).
+
+	@param IvHigh32		High 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+
+	@param IvLow32		Low 32-bits of the initialisation vector. Required if the Mode parameter is not #BLOWFISH_MODE_ECB.
+
+	@remarks A session record is a few tens of bytes and is cheap to initialise, so use one per stream. Operations performed on a session record are not thread safe.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised session record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or key schedule pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The specified mode is not supported.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitSession ( BLOWFISH_PSESSION Session, BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 );
+
+/**
+
+	Clear a session record.
+
+	@param Session	Pointer to a session record to overwrite.
+
+	@remarks The key schedule used by the session is not modified.
+
+	@return #BLOWFISH_RC_SUCCESS			The session record was overwritten successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_ExitSession ( BLOWFISH_PSESSION Session );
+
+/**
+
+	Initialise a session record for stream based enciphering/deciphering. See #BLOWFISH_BeginStream.
+
+	@param Session	Pointer to an initialised session record.
+
+	@return #BLOWFISH_RC_SUCCESS			The session record was initialised for stream ciphering successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_BeginSessionStream ( BLOWFISH_PSESSION Session );
+
+/**
+
+	Clear sensitive data from a session record after performing stream based enciphering/deciphering. See #BLOWFISH_EndStream.
+
+	@param Session	Pointer to an initialised session record.
+
+	@return #BLOWFISH_RC_SUCCESS			Sensitive data was cleared from the session record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	A #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC stream ended part way through a block.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EndSessionStream ( BLOWFISH_PSESSION Session );
+
+/**
+
+	Position a stream at a byte offset from its start using a session record. See #BLOWFISH_SeekStream.
+
+	@return #BLOWFISH_RC_SUCCESS			The stream was positioned successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The offset of a #BLOWFISH_MODE_ECB stream is not a multiple of 8.
+
+	@return #BLOWFISH_RC_INVALID_MODE		Streams in the mode used to initialise the session record cannot be positioned.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SeekSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_ULONGLONG ByteOffset );
+
+/**
+
+	Limit the number of threads used by each call to encipher/decipher a stream or buffer with a session record. See #BLOWFISH_SetThreads.
+
+	@return #BLOWFISH_RC_SUCCESS			The limit was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetSessionThreads ( BLOWFISH_PSESSION Session, BLOWFISH_ULONG MaxThreads );
+
+/**
+
+	Select the byte order of the data enciphered/deciphered with a session record. See #BLOWFISH_SetByteOrder.
+
+	@return #BLOWFISH_RC_SUCCESS			The byte order was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null, or the byte order is invalid.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetSessionByteOrder ( BLOWFISH_PSESSION Session, BLOWFISH_BYTE_ORDER ByteOrder );
+
+/**
+
+	Retrieve the number of threads used by the last call to encipher/decipher a stream or buffer with a session record. See #BLOWFISH_GetThreadsUsed.
+
+  */ 
+
+BLOWFISH_ULONG BLOWFISH_GetSessionThreadsUsed ( BLOWFISH_PSESSION Session );
+
+/**
+
+	Retrieve the number of bytes of a stream processed by a session record since its last whole block. See #BLOWFISH_GetStreamPending.
+
+  */ 
+
+BLOWFISH_ULONG BLOWFISH_GetSessionStreamPending ( BLOWFISH_PSESSION Session );
+
+/**
+
+	Encipher a buffer of data as part of a stream using a session record. See #BLOWFISH_EncipherStream.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or one of the stream buffer pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is zero.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextStream, BLOWFISH_PUCHAR CipherTextStream, BLOWFISH_SIZE_T StreamLength );
+
+/**
+
+	Encipher a buffer of data using a session record. See #BLOWFISH_EncipherBuffer.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or one of the buffer pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8 (or for #BLOWFISH_MODE_CBC_CS3 is less than 8).
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherSessionBuffer ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T BufferLength );
+
+/**
+
+	Decipher a buffer of data as part of a stream using a session record. See #BLOWFISH_DecipherStream.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully deciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or one of the stream buffer pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the stream buffer is zero.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherSessionStream ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextStream, BLOWFISH_PUCHAR PlainTextStream, BLOWFISH_SIZE_T StreamLength );
+
+/**
+
+	Decipher a buffer of data using a session record. See #BLOWFISH_DecipherBuffer.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully deciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or one of the buffer pointer is null.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8 (or for #BLOWFISH_MODE_CBC_CS3 is less than 8).
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherSessionBuffer ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength );
+
+/**
+
+	Encipher a buffer of data of any length with PKCS#7 padding using a session record. See #BLOWFISH_EncipherBufferPadded.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record or one of the buffer pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The session record was not initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherSessionBufferPadded ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR PlainTextBuffer, BLOWFISH_PUCHAR CipherTextBuffer, BLOWFISH_SIZE_T PlainTextLength );
+
+/**
+
+	Decipher a buffer of data with PKCS#7 padding using a session record. See #BLOWFISH_DecipherBufferPadded.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully deciphered data.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the session record, one of the buffer pointer or the length pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The session record was not initialised with #BLOWFISH_MODE_ECB or #BLOWFISH_MODE_CBC.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of the buffer is not a non-zero multiple of 8.
+
+	@return #BLOWFISH_RC_BAD_PADDING		The padding is invalid.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherSessionBufferPadded ( BLOWFISH_PSESSION Session, BLOWFISH_PCUCHAR CipherTextBuffer, BLOWFISH_PUCHAR PlainTextBuffer, BLOWFISH_SIZE_T BufferLength, BLOWFISH_SIZE_T * PlainTextLength );
+
+/**
+
+	Expand several keys into key schedules at once. See #BLOWFISH_InitKeySchedule.
+
+	@param KeySchedules	Array of key schedules to initialise.
+
+	@param Count		Number of keys (and key schedules).
+
+	@param Keys			Array of pointers to the keys.
+
+	@param KeyLengths	Array of the lengths of the keys.
+
+	@param ReturnCodes	Array to receive the return code for each key (#BLOWFISH_RC_SUCCESS, #BLOWFISH_RC_INVALID_KEY or #BLOWFISH_RC_WEAK_KEY).
+
+	@remarks Expanding a single key is a strictly serial chain of 521 encipherments. This function advances the chains of 4 keys in lockstep, which hides the S-Box load latency of each chain behind the others.
+
+	@return #BLOWFISH_RC_SUCCESS			Every key schedule was initialised successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either one of the array pointers, or one of the key pointers is null, or the key count is negative (no keys are expanded).
+
+	@return Otherwise the return code for the first key that could not be expanded. See ReturnCodes for every key.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitKeyScheduleBatch ( BLOWFISH_PKEY_SCHEDULE KeySchedules, BLOWFISH_SIZE_T Count, const BLOWFISH_PCUCHAR * Keys, const BLOWFISH_SIZE_T * KeyLengths, BLOWFISH_RC * ReturnCodes );
+
+/**
+
+	Initialise several Blowfish context records at once, with a different key for each. See #BLOWFISH_Init and #BLOWFISH_InitKeyScheduleBatch.
+
+	@param Contexts		Array of context records to initialise.
+
+	@param Count		Number of context records (and keys).
+
+	@param Keys			Array of pointers to the keys.
+
+	@param KeyLengths	Array of the lengths of the keys.
+
+	@param Mode			Mode to use for every context record. For supported modes see #BLOWFISH_MODE (#BLOWFISH_MODE_CURRENT is not supported).
+
+	@param IvHigh32		Array of the high 32-bits of the initialisation vector for each context record (may be null for zero initialisation vectors).
+
+	@param IvLow32		Array of the low 32-bits of the initialisation vector for each context record (may be null for zero initialisation vectors).
+
+	@param ReturnCodes	Array to receive the return code for each key (#BLOWFISH_RC_SUCCESS, #BLOWFISH_RC_INVALID_KEY or #BLOWFISH_RC_WEAK_KEY).
+
+	@return #BLOWFISH_RC_SUCCESS			Every context record was initialised successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either one of the array pointers, or one of the key pointers is null, or the key count is negative (no keys are expanded).
+
+	@return #BLOWFISH_RC_INVALID_MODE		The specified mode is not supported (no keys are expanded).
+
+	@return Otherwise the return code for the first key that could not be expanded. See ReturnCodes for every key.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitBatch ( BLOWFISH_PCONTEXT Contexts, BLOWFISH_SIZE_T Count, const BLOWFISH_PCUCHAR * Keys, const BLOWFISH_SIZE_T * KeyLengths, BLOWFISH_MODE Mode, BLOWFISH_PCULONG IvHigh32, BLOWFISH_PCULONG IvLow32, BLOWFISH_RC * ReturnCodes );
+
+/**
+
+	Perform the expensive key setup of EksBlowfish, as used by bcrypt.
+
+	@param KeySchedule	Pointer to a key schedule to receive the expanded key.
+
+	@param Cost			Base 2 logarithm of the number of expensive key expansion rounds (#BLOWFISH_BCRYPT_MIN_COST to #BLOWFISH_BCRYPT_MAX_COST).
+
+	@param Salt			Pointer to #BLOWFISH_BCRYPT_SALT_LENGTH bytes of salt.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key (only the first #BLOWFISH_BCRYPT_MAX_KEY_LENGTH bytes are used).
+
+	@remarks Unlike #BLOWFISH_InitKeySchedule no keys are rejected as weak, and the key is not limited to #BLOWFISH_MAX_KEY_LENGTH bytes.
+
+	@return #BLOWFISH_RC_SUCCESS			The key schedule was expanded successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the pointers is null, or the cost is out of range.
+
+	@return #BLOWFISH_RC_INVALID_KEY		The key is empty.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EksBlowfishSetup ( BLOWFISH_PKEY_SCHEDULE KeySchedule, BLOWFISH_ULONG Cost, BLOWFISH_PCUCHAR Salt, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength );
+
+/**
+
+	Hash a password with bcrypt.
+
+	@param Password	Null terminated password (only the first #BLOWFISH_BCRYPT_MAX_KEY_LENGTH bytes are used).
+
+	@param Cost		Base 2 logarithm of the number of expensive key expansion rounds (#BLOWFISH_BCRYPT_MIN_COST to #BLOWFISH_BCRYPT_MAX_COST).
+
+	@param Salt		Pointer to #BLOWFISH_BCRYPT_SALT_LENGTH bytes of random salt.
+
+	@param Hash		Buffer of #BLOWFISH_BCRYPT_HASH_LENGTH characters to receive the null terminated "$2b$" hash string.
+
+	@return #BLOWFISH_RC_SUCCESS			The password was hashed successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the pointers is null, or the cost is out of range.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_BcryptHash ( const char * Password, BLOWFISH_ULONG Cost, BLOWFISH_PCUCHAR Salt, char * Hash );
+
+/**
+
+	Verify a password against a bcrypt hash string.
+
+	@param Password	Null terminated password.
+
+	@param Hash		Null terminated "$2a$", "$2b$" or "$2y$" hash string.
+
+	@remarks The computed and supplied hash strings are compared in constant time.
+
+	@return #BLOWFISH_RC_SUCCESS			The password matches the hash.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the pointers is null.
+
+	@return #BLOWFISH_RC_INVALID_HASH		The hash string is malformed, or its version or cost is not supported.
+
+	@return #BLOWFISH_RC_HASH_MISMATCH		The password does not match the hash.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_BcryptVerify ( const char * Password, const char * Hash );
+
+/**
+
+	Verify several passwords against their bcrypt hash strings.
+
+	@param Count		Number of passwords to verify.
+
+	@param Passwords	Array of null terminated passwords.
+
+	@param Hashes		Array of null terminated hash strings.
+
+	@param ReturnCodes	Array to receive the result of each verification (see #BLOWFISH_BcryptVerify).
+
+	@remarks Hashes are verified in groups of 4, whose key setups are interleaved when every hash in the group is valid and has the same cost. When compiled with OpenMP, groups are verified in parallel.
+
+	@return #BLOWFISH_RC_SUCCESS			Every password matches its hash.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the array pointers is null, or the password count is negative.
+
+	@return Otherwise the first return code that was not #BLOWFISH_RC_SUCCESS.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_BcryptVerifyBatch ( BLOWFISH_SIZE_T Count, const char * const * Passwords, const char * const * Hashes, BLOWFISH_RC * ReturnCodes );
+
+/**
+
+	Initialise a key cache, which holds up to EntryCount expanded key schedules, evicting the least recently used.
+
+	@param Cache		Pointer to a key cache record to initialise.
+
+	@param Entries		Pointer to an array of entries for the cache to use. The array must remain valid until #BLOWFISH_ExitKeyCache is called.
+
+	@param EntryCount	Number of entries in the array.
+
+	@remarks All key cache functions are thread safe, and may be called concurrently for the same cache.
+
+	@remarks Each entry holds a #BLOWFISH_KEY_SCHEDULE, so allocate the array on a 64-byte boundary for best performance.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised the key cache successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the key cache or entries pointer is null, or the entry count is zero.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitKeyCache ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PKEY_CACHE_ENTRY Entries, BLOWFISH_SIZE_T EntryCount );
+
+/**
+
+	Overwrite every entry in a key cache, and the key cache record.
+
+	@param Cache	Pointer to an initialised key cache record.
+
+	@remarks No key schedules acquired from the cache may be in use when calling this function.
+
+	@return #BLOWFISH_RC_SUCCESS			The key cache was overwritten successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied key cache pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_ExitKeyCache ( BLOWFISH_PKEY_CACHE Cache );
+
+/**
+
+	Look up (or expand and insert) the key schedule for a key, and pin it in the cache until #BLOWFISH_ReleaseKeySchedule is called.
+
+	@param Cache		Pointer to an initialised key cache record.
+
+	@param Key			Pointer to the key.
+
+	@param KeyLength	Length of the key, which cannot exceed #BLOWFISH_MAX_KEY_LENGTH bytes, or be less than #BLOWFISH_MIN_KEY_LENGTH bytes.
+
+	@param KeySchedule	Pointer to receive the cached key schedule, which may be shared with #BLOWFISH_InitSession.
+
+	@remarks Keys are expanded without holding the cache lock, so a miss does not stall other threads.
+
+	@return #BLOWFISH_RC_SUCCESS			The key schedule was found or inserted.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the key cache, key or key schedule pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_KEY		The key is either too short or too long.
+
+	@return #BLOWFISH_RC_WEAK_KEY			The key has been deemed to be weak (weak keys are never cached).
+
+	@return #BLOWFISH_RC_CACHE_FULL			Every entry is pinned, so there is nowhere to insert the key schedule.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_AcquireKeySchedule ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_PCKEY_SCHEDULE * KeySchedule );
+
+/**
+
+	Unpin a key schedule returned by #BLOWFISH_AcquireKeySchedule, allowing it to be evicted.
+
+	@param Cache		Pointer to the key cache record the key schedule was acquired from.
+
+	@param KeySchedule	Pointer to the key schedule.
+
+	@return #BLOWFISH_RC_SUCCESS			The key schedule was released.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either pointer is null, or the key schedule was not acquired from the key cache.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_ReleaseKeySchedule ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCKEY_SCHEDULE KeySchedule );
+
+/**
+
+	Initialise a Blowfish context record, taking the key schedule from a key cache. See #BLOWFISH_Init.
+
+	@param Cache	Pointer to an initialised key cache record.
+
+	@remarks The key schedule is copied into the context record, so the context record does not pin the cache entry. If every entry is pinned, the key is expanded into the context record without being cached.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised context record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the key cache, context record or key pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_KEY		The key is either too short or too long.
+
+	@return #BLOWFISH_RC_WEAK_KEY			The key has been deemed to be weak.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The specified mode is not supported.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitFromKeyCache ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PCONTEXT Context, BLOWFISH_PCUCHAR Key, BLOWFISH_SIZE_T KeyLength, BLOWFISH_MODE Mode, BLOWFISH_ULONG IvHigh32, BLOWFISH_ULONG IvLow32 );
+
+/**
+
+	Take a snapshot of the statistics of a key cache.
+
+	@param Cache		Pointer to an initialised key cache record.
+
+	@param Statistics	Pointer to receive the statistics.
+
+	@return #BLOWFISH_RC_SUCCESS			The statistics were copied successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_GetKeyCacheStatistics ( BLOWFISH_PKEY_CACHE Cache, BLOWFISH_PKEY_CACHE_STATISTICS Statistics );
+
+/**
+
+	Encipher several independent messages in cipher block chaining mode, each with its own initialisation vector.
+
+	@param Context				Pointer to an initialised context record, which supplies the key. The mode and initialisation vector of the context record are not used.
+
+	@param BufferCount			Number of messages to encipher.
+
+	@param PlainTextBuffers		Array of pointers to the messages to encipher.
+
+	@param CipherTextBuffers	Array of pointers to buffers to receive the enciphered messages.
+
+	@param BufferLengths		Array of lengths of each plaintext and ciphertext buffer. Each must be a non-zero multiple of 8.
+
+	@param IvHigh32				Array of the high 32-bits of the initialisation vector for each message.
+
+	@param IvLow32				Array of the low 32-bits of the initialisation vector for each message.
+
+	@remarks Produces the same output as calling #BLOWFISH_EncipherBuffer for each message with a context record initialised in #BLOWFISH_MODE_CBC, but advances several messages in lockstep to hide the latency of the chain.
+
+	@remarks The PlainTextBuffers and CipherTextBuffers pointers for a message may be equal, but must not otherwise overlap.
+
+	@return #BLOWFISH_RC_SUCCESS			Successfully enciphered all messages.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the context record, one of the arrays, or one of the buffer pointers is null, or the message count is negative.
+
+	@return #BLOWFISH_RC_BAD_BUFFER_LENGTH	The size of one of the buffers is negative, or is not a non-zero multiple of 8. No messages are enciphered.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherBufferMulti ( BLOWFISH_PCONTEXT Context, BLOWFISH_SIZE_T BufferCount, const BLOWFISH_PCUCHAR * PlainTextBuffers, BLOWFISH_PUCHAR * CipherTextBuffers, const BLOWFISH_SIZE_T * BufferLengths, BLOWFISH_PCULONG IvHigh32, BLOWFISH_PCULONG IvLow32 );
+
+/**
+
+	Select the kernel used by context records to encipher/decipher streams and buffers.
+
+	@param Kernel	Kernel to use. Use #BLOWFISH_KERNEL_AUTO to select the fastest kernel supported by the processor. For supported kernels see #BLOWFISH_KERNEL.
+
+	@remarks The processor is probed once on first use, and the kernel is selected automatically, so calling this function is optional (it is intended for benchmarking and testing).
+
+	@remarks Only context records initialised, or reset with a new mode, after this call will use the new kernel. This function is thread safe.
+
+	@remarks Modes that a kernel does not accelerate fall back to the scalar implementation.
+
+	@return #BLOWFISH_RC_SUCCESS				The kernel was selected successfully.
+
+	@return #BLOWFISH_RC_KERNEL_NOT_SUPPORTED	The kernel is unknown, was not compiled in, or is not supported by the processor. The current kernel is unchanged.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetKernel ( BLOWFISH_KERNEL Kernel );
+
+/**
+
+	Retrieve the kernel used by context records to encipher/decipher streams and buffers.
+
+	@remarks This function is thread safe.
+
+	@return The current kernel (never #BLOWFISH_KERNEL_AUTO).
+
+  */ 
+
+BLOWFISH_KERNEL BLOWFISH_GetKernel ( void );
+
+/**
+
+	Set the minimum number of bytes each thread processes when a stream function is parallelised using OpenMP.
+
+	@param BytesPerThread	Minimum number of bytes per thread (#BLOWFISH_DEFAULT_PARALLEL_THRESHOLD by default).
+
+	@remarks A stream or buffer of N bytes is processed by at most N / BytesPerThread threads, so buffers shorter than twice the threshold are processed by the calling thread alone. Raise the threshold if small messages are slower with OpenMP enabled, and lower it if large buffers do not use every core.
+
+	@remarks The OpenMP runtime keeps its threads alive between calls. Set OMP_PROC_BIND and OMP_PLACES to pin them to cores, and OMP_WAIT_POLICY to control whether idle threads spin or sleep.
+
+	@remarks This function has no effect unless compiled with OpenMP or an executor is registered (see #BLOWFISH_SetExecutor). It applies to all context and session records, and may be called at any time.
+
+	@return #BLOWFISH_RC_SUCCESS			The threshold was set successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The threshold is less than 8 bytes.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetParallelThreshold ( BLOWFISH_SIZE_T BytesPerThread );
+
+/**
+
+	Retrieve the minimum number of bytes each thread processes when a stream function is parallelised using OpenMP.
+
+	@return The current threshold in bytes.
+
+  */ 
+
+BLOWFISH_SIZE_T BLOWFISH_GetParallelThreshold ( void );
+
+/**
+
+	Register an executor used to parallelise the library in place of OpenMP.
+
+	@param Executor	Pointer to an executor record, or null to go back to OpenMP (or the calling thread alone, if compiled without OpenMP).
+
+	@remarks Once registered, streams and buffers in #BLOWFISH_MODE_ECB, #BLOWFISH_MODE_CTR and #BLOWFISH_MODE_CTR64, and deciphered in #BLOWFISH_MODE_CBC and #BLOWFISH_MODE_CFB, are split into ranges of at least #BLOWFISH_GetParallelThreshold bytes that are run by the executor. The batch functions (#BLOWFISH_EncipherBufferMulti, #BLOWFISH_InitBatch, #BLOWFISH_InitKeyScheduleBatch and #BLOWFISH_BcryptVerifyBatch) run their groups on it too. This allows builds without OpenMP to be parallelised by the application's own task system or thread pool.
+
+	@remarks The output is the same whichever executor is used, and whatever order it runs the ranges in. Limits set by #BLOWFISH_SetThreads/#BLOWFISH_SetSessionThreads are honoured by making the ranges long enough, and a limit of 1 keeps the calls on the calling thread.
+
+	@remarks The executor record is referenced, not copied, and must remain valid until another executor is registered. Calls already in progress may still use the previous executor.
+
+	@remarks This function is thread safe.
+
+	@return #BLOWFISH_RC_SUCCESS			The executor was registered successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The executor record's ParallelFor pointer is null.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SetExecutor ( BLOWFISH_PCEXECUTOR Executor );
+
+/**
+
+	Retrieve the executor registered by #BLOWFISH_SetExecutor.
+
+	@remarks This function is thread safe.
+
+	@return Pointer to the executor record, or null if none is registered.
+
+  */ 
+
+BLOWFISH_PCEXECUTOR BLOWFISH_GetExecutor ( void );
+
+/**
+
+	Initialise a job queue, which holds up to SlotCount jobs submitted with #BLOWFISH_SubmitJob until a worker thread takes them.
+
+	@param Queue		Pointer to a job queue record to initialise.
+
+	@param Slots		Pointer to an array of slots for the queue to use. The array must remain valid for as long as the queue is used.
+
+	@param SlotCount	Number of slots in the array (a power of 2, no more than 2^31).
+
+	@remarks All job queue functions are thread safe, and may be called concurrently for the same queue. None of them takes a lock.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised the job queue successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the job queue or slots pointer is null, or the slot count is not a power of 2.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitJobQueue ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_PJOB_QUEUE_SLOT Slots, BLOWFISH_SIZE_T SlotCount );
+
+/**
+
+	Queue a job to encipher/decipher a buffer, without waiting for it to be processed.
+
+	@param Queue	Pointer to an initialised job queue record.
+
+	@param Job		Pointer to a job record, with every member but ReturnCode set. The job record and its buffers must remain valid until the job completes.
+
+	@remarks The buffers are not copied. The job is processed by the next thread to call #BLOWFISH_ServiceJobQueue or #BLOWFISH_WaitJob, in the same way as #BLOWFISH_EncipherBuffer/#BLOWFISH_DecipherBuffer (or #BLOWFISH_EncipherSessionBuffer/#BLOWFISH_DecipherSessionBuffer), and so may be parallelised in turn.
+
+	@remarks Poll the job for completion with #BLOWFISH_PollJob, or wait for it with #BLOWFISH_WaitJob.
+
+	@return #BLOWFISH_RC_SUCCESS			The job was queued successfully. Its return code is #BLOWFISH_RC_PENDING until it completes.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the job queue or job pointer is null, or the job's operation is not supported.
+
+	@return #BLOWFISH_RC_QUEUE_FULL			The queue is full. Service it, or try again later.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_SubmitJob ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_PJOB Job );
+
+/**
+
+	Process jobs from a job queue on the calling thread.
+
+	@param Queue	Pointer to an initialised job queue record.
+
+	@param MaxJobs	Maximum number of jobs to process (0 to process jobs until the queue is empty).
+
+	@remarks Call this function from each of a set of background worker threads (such as the application's thread pool), which sleep or do other work while it returns 0. Several jobs are processed per call to amortise the cost of waking a worker, and the jobs that are ready are taken in groups, so that those enciphered in #BLOWFISH_MODE_CBC are processed together, as by #BLOWFISH_ProcessBatch.
+
+	@return Number of jobs processed, or 0 if the queue was empty (or the job queue pointer is null).
+
+  */ 
+
+BLOWFISH_SIZE_T BLOWFISH_ServiceJobQueue ( BLOWFISH_PJOB_QUEUE Queue, BLOWFISH_SIZE_T MaxJobs );
+
+/**
+
+	Check whether a job submitted with #BLOWFISH_SubmitJob has completed, without blocking.
+
+	@param Job	Pointer to a submitted job record.
+
+	@return #BLOWFISH_RC_PENDING	The job has not completed yet.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The job pointer is null.
+
+	@return The job's return code once it has completed, see #BLOWFISH_EncipherBuffer/#BLOWFISH_DecipherBuffer.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_PollJob ( const BLOWFISH_JOB * Job );
+
+/**
+
+	Wait for a job submitted with #BLOWFISH_SubmitJob to complete.
+
+	@param Queue	Pointer to the job queue record the job was submitted to.
+
+	@param Job		Pointer to a submitted job record.
+
+	@remarks While the job is pending, the calling thread processes jobs from the queue (including, if no worker has taken it yet, the job itself). Once the queue is empty it spins until the worker processing the job completes it.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the job queue or job pointer is null.
+
+	@return The job's return code, see #BLOWFISH_EncipherBuffer/#BLOWFISH_DecipherBuffer.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_WaitJob ( BLOWFISH_PJOB_QUEUE Queue, const BLOWFISH_JOB * Job );
+
+/**
+
+	Encipher/decipher many independent buffers in one call.
+
+	@param JobCount	Number of jobs.
+
+	@param Jobs		Array of job records, with every member but ReturnCode set. Each job must use a different context or session record.
+
+	@remarks Each job is processed in the same way as #BLOWFISH_EncipherBuffer/#BLOWFISH_DecipherBuffer (or #BLOWFISH_EncipherSessionBuffer/#BLOWFISH_DecipherSessionBuffer), and receives its own return code.
+
+	@remarks The jobs are shared between threads in slices, which idle threads take from the batch until it is exhausted, so batches of many small buffers are parallelised even though each buffer is too short to be. Within a slice, buffers enciphered in #BLOWFISH_MODE_CBC are advanced 4 at a time in lockstep, each with its own key schedule and initialisation vector, to hide the latency of the chain.
+
+	@remarks This function can be parallelised using OpenMP or an executor (see #BLOWFISH_SetExecutor).
+
+	@return #BLOWFISH_RC_SUCCESS			Every job completed successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The jobs pointer is null, or the job count is negative.
+
+	@return Otherwise the return code of the first job that failed.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_ProcessBatch ( BLOWFISH_SIZE_T JobCount, BLOWFISH_PJOB Jobs );
+
+/**
+
+	Encipher many independent 8-byte blocks, each with its own key schedule (such as a per-tenant key used for tokenisation).
+
+	@param Count		Number of blocks.
+
+	@param KeySchedules	Array of pointers to the initialised key schedule for each block. The same key schedule may appear any number of times.
+
+	@param High32		Array of the high 32 bits of each block, which receives the high 32 bits of each enciphered block.
+
+	@param Low32		Array of the low 32 bits of each block, which receives the low 32 bits of each enciphered block.
+
+	@remarks Each block is enciphered as if by #BLOWFISH_Encipher with a context record holding its key schedule.
+
+	@remarks Blocks are taken in windows of 256, and grouped by key schedule within each window, so that blocks sharing a key schedule are enciphered together while it is cache resident. Groups of blocks are then enciphered in lockstep, 4 at a time or (with the AVX-512 kernel) 16 at a time, gathering S-Box entries from each block's own key schedule. When compiled with OpenMP, or if an executor is registered (see #BLOWFISH_SetExecutor), windows are enciphered in parallel.
+
+	@return #BLOWFISH_RC_SUCCESS			The blocks were enciphered.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the array pointers, or one of the key schedule pointers, is null, or the block count is negative.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherMultiKey ( BLOWFISH_SIZE_T Count, const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 );
+
+/**
+
+	Decipher many independent 8-byte blocks, each with its own key schedule.
+
+	@param Count		Number of blocks.
+
+	@param KeySchedules	Array of pointers to the initialised key schedule for each block. The same key schedule may appear any number of times.
+
+	@param High32		Array of the high 32 bits of each block, which receives the high 32 bits of each deciphered block.
+
+	@param Low32		Array of the low 32 bits of each block, which receives the low 32 bits of each deciphered block.
+
+	@remarks Each block is deciphered as if by #BLOWFISH_Decipher. See #BLOWFISH_EncipherMultiKey for more information.
+
+	@return #BLOWFISH_RC_SUCCESS			The blocks were deciphered.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	One of the array pointers, or one of the key schedule pointers, is null, or the block count is negative.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherMultiKey ( BLOWFISH_SIZE_T Count, const BLOWFISH_PCKEY_SCHEDULE * KeySchedules, BLOWFISH_PULONG High32, BLOWFISH_PULONG Low32 );
+
+/**
+
+	Encipher an array of 64-bit values, each as an independent block (for example to obfuscate database identifiers).
+
+	@param Context			Pointer to an initialised context record.
+
+	@param PlainTextArray	Array of values to encipher.
+
+	@param CipherTextArray	Array to receive the enciphered values (may be the same as PlainTextArray).
+
+	@param Count			Number of values.
+
+	@remarks Each value is enciphered as if by #BLOWFISH_Encipher, with its most significant 32 bits as the high 32 bits of the block. The result is therefore the same on every host, whatever its byte order.
+
+	@remarks Values are always enciphered in electronic codebook mode, whatever the context's mode, and the context's stream state is neither used nor changed.
+
+	@remarks Values are enciphered in chunks by the kernel selected for #BLOWFISH_MODE_ECB. When compiled with OpenMP, or if an executor is registered (see #BLOWFISH_SetExecutor), chunks are enciphered in parallel.
+
+	@return #BLOWFISH_RC_SUCCESS			The values were enciphered.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The context pointer or one of the array pointers is null, or the block count is negative.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_EncipherU64Array ( BLOWFISH_PCONTEXT Context, const BLOWFISH_ULONGLONG * PlainTextArray, BLOWFISH_ULONGLONG * CipherTextArray, BLOWFISH_SIZE_T Count );
+
+/**
+
+	Decipher an array of 64-bit values enciphered by #BLOWFISH_EncipherU64Array.
+
+	@param Context			Pointer to an initialised context record.
+
+	@param CipherTextArray	Array of values to decipher.
+
+	@param PlainTextArray	Array to receive the deciphered values (may be the same as CipherTextArray).
+
+	@param Count			Number of values.
+
+	@remarks See #BLOWFISH_EncipherU64Array for more information.
+
+	@return #BLOWFISH_RC_SUCCESS			The values were deciphered.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The context pointer or one of the array pointers is null, or the block count is negative.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_DecipherU64Array ( BLOWFISH_PCONTEXT Context, const BLOWFISH_ULONGLONG * CipherTextArray, BLOWFISH_ULONGLONG * PlainTextArray, BLOWFISH_SIZE_T Count );
+
+/**
+
+	Initialise a keystream record, which holds up to BlockCount blocks of #BLOWFISH_MODE_OFB keystream generated ahead of use.
+
+	@param Keystream	Pointer to a keystream record to initialise.
+
+	@param Blocks		Pointer to an array of BlockCount * 2 words for the keystream. The array must remain valid for as long as the keystream record is used.
+
+	@param BlockCount	Number of blocks the array holds (a power of 2, no more than 2^31).
+
+	@remarks OFB keystream depends only on the key and initialisation vector, not on the data, so it can be generated before the data arrives. Once the keystream record is attached to a context record with #BLOWFISH_AttachKeystream, a background thread keeps the ring full with #BLOWFISH_FillKeystream, and the context record's stream/buffer functions only XOR the data with keystream taken from the ring.
+
+	@return #BLOWFISH_RC_SUCCESS			Initialised the keystream record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	Either the keystream record or blocks pointer is null, or the block count is not a power of 2.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_InitKeystream ( BLOWFISH_PKEYSTREAM Keystream, BLOWFISH_PULONG Blocks, BLOWFISH_SIZE_T BlockCount );
+
+/**
+
+	Attach a keystream record to a context record initialised with #BLOWFISH_MODE_OFB, or detach it.
+
+	@param Context		Pointer to an initialised context record.
+
+	@param Keystream	Pointer to an initialised keystream record that is not attached to another context or session record, or null to detach the keystream record attached (if any).
+
+	@remarks Attaching empties the ring, which is then generated from the initialisation vector the context record was initialised with (the start of each stream). Detaching wipes the ring. Resetting the key or mode of the context record with #BLOWFISH_Reset also detaches it and wipes the ring, and initialising the context record again detaches it without wiping the ring.
+
+	@remarks Keystream is taken from the ring whenever it follows on from the context record's current position in the stream, and is otherwise generated on the calling thread as usual, so the output is the same with or without a keystream record. If the ring runs dry, it is used again once the producer has caught up with the stream. A stream that is restarted (including by each buffer function) goes back to keystream the ring has already discarded, so use a single stream, or attach the keystream record again to start the ring over.
+
+	@remarks Only the producer thread and the thread using the context record access the ring, without locking. Attach the keystream record before starting the producer, and stop the producer before detaching it or attaching it again. The context record must not be moved while it is attached, and copies made by #BLOWFISH_CloneContext are not attached.
+
+	@return #BLOWFISH_RC_SUCCESS			Attached (or detached) the keystream record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The context record pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The context record was not initialised with #BLOWFISH_MODE_OFB.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_AttachKeystream ( BLOWFISH_PCONTEXT Context, BLOWFISH_PKEYSTREAM Keystream );
+
+/**
+
+	Attach a keystream record to a session record initialised with #BLOWFISH_MODE_OFB, or detach it. See #BLOWFISH_AttachKeystream.
+
+	@return #BLOWFISH_RC_SUCCESS			Attached (or detached) the keystream record successfully.
+
+	@return #BLOWFISH_RC_INVALID_PARAMETER	The supplied session record pointer is null.
+
+	@return #BLOWFISH_RC_INVALID_MODE		The session record was not initialised with #BLOWFISH_MODE_OFB.
+
+  */ 
+
+BLOWFISH_RC BLOWFISH_AttachSessionKeystream ( BLOWFISH_PSESSION Session, BLOWFISH_PKEYSTREAM Keystream );
+
+/**
+
+	Generate keystream into the free blocks of an attached keystream record's ring, on the calling thread.
+
+	@param Keystream	Pointer to an attached keystream record.
+
+	@param MaxBlocks	Maximum number of blocks to generate (0 to generate blocks until the ring is full).
+
+	@remarks Call this function from a single background producer thread per keystream record, which sleeps or does other work while it returns 0. Each block can be taken by the session as soon as it is generated.
+
+	@return Number of blocks generated, or 0 if the ring was full (or the keystream record pointer is null, or the keystream record is not attached).
+
+  */ 
+
+BLOWFISH_SIZE_T BLOWFISH_FillKeystream ( BLOWFISH_PKEYSTREAM Keystream, BLOWFISH_SIZE_T MaxBlocks );
+
 #ifdef  __cplusplus
 }
 #endif
@@ -0,0 +1,178 @@
+/**
+
+	@file		blowfish_inline.h
+
+	@brief		Optional inline single-block functions for Bruce Schneier's
+				64-bit symmetric block cipher, Blowfish.
+
+	@author		Blowfish API contributors
+
+	@date		16-October-2026
+
+	Copyright (c) 2026, Blowfish API contributors.
+
+	Permission is hereby granted, free of charge, to any person obtaining a
+	copy of this software and associated documentation files (the "Software"),
+	to deal in the Software without restriction, including without limitation
+	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+	and/or sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	Except as contained in this notice, the name(s) of the above copyright
+	holders shall not be used in advertising or otherwise to promote the sale,
+	use or other dealings in this Software without prior written authorisation.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+	DEALINGS IN THE SOFTWARE.
+
+	@details	Including this header is optional. It provides single-block
+				functions which are compiled into the caller, so that the
+				block and key schedule pointers can be kept in registers
+				across a loop of calls, and adjacent calls interleaved by the
+				compiler. Blocks are passed and returned as 64-bit values,
+				whose most significant 32 bits are the high 32 bits of the
+				block (as for #BLOWFISH_EncipherU64Array).
+
+  */ 
+
+#ifndef __BLOWFISH_INLINE_H__
+#define __BLOWFISH_INLINE_H__
+
+#include <blowfish.h>
+
+/**
+
+	@ingroup blowfish
+	@defgroup blowfish_inline Blowfish inline functions
+	@{
+
+*/ 
+
+/** Storage class used for the inline functions, chosen to suit the compiler. */ 
+
+#if defined ( __cplusplus ) || ( defined ( __STDC_VERSION__ ) && __STDC_VERSION__ >= 199901L )
+#define BLOWFISH_INLINE	static inline
+#elif defined ( _MSC_VER ) || defined ( __GNUC__ )
+#define BLOWFISH_INLINE	static __inline
+#else
+#define BLOWFISH_INLINE	static
+#endif
+
+/**
+
+	@internal
+
+	Perform a single round of the cipher. See #_BLOWFISH_CIPHER in blowfish.c for more information.
+
+	@param XLeft		High 32-bits of the message.
+
+	@param XRight		Low 32-bits of the message.
+
+	@param KeySchedule	Pointer to the key schedule.
+
+	@param Round		Current round to perform (0-15 to encipher, 17-2 to decipher).
+
+  */ 
+
+#define _BLOWFISH_INLINE_CIPHER( XLeft, XRight, KeySchedule, Round )	\
+{																		\
+	XLeft ^= KeySchedule->PArray [ Round ];								\
+	XRight ^= ( ( ( KeySchedule->SBox [ 0 ] [ XLeft >> 24 ] +			\
+		KeySchedule->SBox [ 1 ] [ ( XLeft >> 16 ) & 0xff ] ) ^			\
+		KeySchedule->SBox [ 2 ] [ ( XLeft >> 8 ) & 0xff ] ) +			\
+		KeySchedule->SBox [ 3 ] [ XLeft & 0xff ] );						\
+}
+
+/**
+
+	Encipher an 8-byte block of data, inline.
+
+	@param KeySchedule	Pointer to an initialised key schedule (for a context record, its KeySchedule member).
+
+	@param Block		Block to encipher.
+
+	@remarks Equivalent to #BLOWFISH_Encipher. It is an unchecked runtime error to supply a null key schedule pointer.
+
+	@return The enciphered block.
+
+  */ 
+
+BLOWFISH_INLINE BLOWFISH_ULONGLONG BLOWFISH_EncipherInline ( BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_ULONGLONG Block )
+{
+	BLOWFISH_ULONG	XLeft = (BLOWFISH_ULONG)( Block >> 32 );
+	BLOWFISH_ULONG	XRight = (BLOWFISH_ULONG)Block;
+
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 0 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 1 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 2 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 3 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 4 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 5 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 6 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 7 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 8 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 9 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 10 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 11 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 12 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 13 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 14 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 15 );
+
+	/* Finalise round and unswap xL and xR: xR = xR XOR P18, xL = xL XOR P17 */ 
+
+	return ( (BLOWFISH_ULONGLONG)( XRight ^ KeySchedule->PArray [ 17 ] ) << 32 ) | ( XLeft ^ KeySchedule->PArray [ 16 ] );
+}
+
+/**
+
+	Decipher an 8-byte block of data, inline.
+
+	@param KeySchedule	Pointer to an initialised key schedule (for a context record, its KeySchedule member).
+
+	@param Block		Block to decipher.
+
+	@remarks Equivalent to #BLOWFISH_Decipher. It is an unchecked runtime error to supply a null key schedule pointer.
+
+	@return The deciphered block.
+
+  */ 
+
+BLOWFISH_INLINE BLOWFISH_ULONGLONG BLOWFISH_DecipherInline ( BLOWFISH_PCKEY_SCHEDULE KeySchedule, BLOWFISH_ULONGLONG Block )
+{
+	BLOWFISH_ULONG	XLeft = (BLOWFISH_ULONG)( Block >> 32 );
+	BLOWFISH_ULONG	XRight = (BLOWFISH_ULONG)Block;
+
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 17 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 16 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 15 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 14 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 13 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 12 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 11 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 10 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 9 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 8 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 7 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 6 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 5 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 4 );
+	_BLOWFISH_INLINE_CIPHER ( XLeft, XRight, KeySchedule, 3 );
+	_BLOWFISH_INLINE_CIPHER ( XRight, XLeft, KeySchedule, 2 );
+
+	/* Finalise round and unswap xL and xR: xR = xR XOR P1, xL = xL XOR P2 */ 
+
+	return ( (BLOWFISH_ULONGLONG)( XRight ^ KeySchedule->PArray [ 0 ] ) << 32 ) | ( XLeft ^ KeySchedule->PArray [ 1 ] );
+}
+
+/** @} */ 
+
+#endif /* __BLOWFISH_INLINE_H__ */ 
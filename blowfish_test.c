@@ -48,6 +48,7 @@
 #endif
 
 #include <blowfish.h>
+#include <blowfish_inline.h>
 
 /**
 
@@ -152,6 +153,56 @@ static const BLOWFISH_ULONG _BLOWFISH_Tv3CipherText [ ] [ 6 ] =
 
 static const BLOWFISH_MODE _BLOWFISH_Tv3Mode [ ] = { BLOWFISH_MODE_CBC, BLOWFISH_MODE_CFB, BLOWFISH_MODE_OFB };
 
+/** @internal Reference test modes. */ 
+
+static const BLOWFISH_MODE _BLOWFISH_ReferenceMode [ ] = { BLOWFISH_MODE_ECB, BLOWFISH_MODE_CBC, BLOWFISH_MODE_CFB, BLOWFISH_MODE_OFB, BLOWFISH_MODE_CTR, BLOWFISH_MODE_CTR64 };
+
+/** @internal Multi-buffer test message counts (chosen to leave idle lanes, and to span several slices). */ 
+
+static const BLOWFISH_ULONG _BLOWFISH_MultiCount [ ] = { 1, 3, 17, 203 };
+
+/** @internal Batch key expansion test key counts (chosen to exercise the single key tail, and the invalid key at index 5). */ 
+
+static const BLOWFISH_ULONG _BLOWFISH_BatchCount [ ] = { 1, 4, 7, 37 };
+
+/** @internal bcrypt test passwords (the 4th is longer than 72 characters, the 6th is not ASCII). */ 
+
+static const char * const _BLOWFISH_BcryptPassword [ ] =
+{
+	"U*U",
+	"",
+	"U*U*U",
+	"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789chars after 72 are ignored",
+	"password",
+	"\xc3\xbf\xc2\xa3",
+	"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ012345678"
+};
+
+/** @internal bcrypt test hashes. */ 
+
+static const char * const _BLOWFISH_BcryptHash [ ] =
+{
+	"$2b$05$CCCCCCCCCCCCCCCCCCCCC.E5YPO9kmyuRGyh0XouQYb4YMJKvyOeW",
+	"$2b$05$CCCCCCCCCCCCCCCCCCCCC.7uG0VCzI2bS7j6ymqJi9CdcdxiRTWNy",
+	"$2b$05$XXXXXXXXXXXXXXXXXXXXXOAcXxm9kjPGEMsLznoKqmqw7tc8WCx4a",
+	"$2b$05$abcdefghijklmnopqrstuu5s2v8.iXieOjg/.AySBTTZIIVFJeBui",
+	"$2b$04$abcdefghijklmnopqrstuughE8Ev8uGFaUgY2cNEySvxngrb/Jzdm",
+	"$2b$05$/OK.fbVrR/bpIqNJ5ianF.4Ct.Zje1bKMhQv8WPqdLb9AWQiL9yOi",
+	"$2b$04$CCCCCCCCCCCCCCCCCCCCC.rdIDyHJ69eb.FoH5QDlG5nPtz7wt6mm"
+};
+
+/** @internal Salt of the 5th bcrypt test hash ("abcdefghijklmnopqrstuu"). */ 
+
+static const BLOWFISH_UCHAR _BLOWFISH_BcryptSalt [ ] = { 0x71, 0xd7, 0x9f, 0x82, 0x18, 0xa3, 0x92, 0x59, 0xa7, 0xa2, 0x9a, 0xab, 0xb2, 0xdb, 0xaf, 0xc3 };
+
+/** @internal Reference test kernels (kernels not supported by the processor are skipped). */ 
+
+static const BLOWFISH_KERNEL _BLOWFISH_ReferenceKernel [ ] = { BLOWFISH_KERNEL_SCALAR, BLOWFISH_KERNEL_INTERLEAVED, BLOWFISH_KERNEL_AVX512 };
+
+/** @internal Reference test buffer lengths (chosen to leave partial groups of blocks for the vectorised stream functions). */ 
+
+static const BLOWFISH_ULONG _BLOWFISH_ReferenceLength [ ] = { 8, 56, 64, 136, 4104 };
+
 /** @internal Throughput test vector */ 
 
 typedef struct __BLOWFISH_THROUGHPUT_TEST
@@ -217,6 +268,34 @@ static int _BLOWFISH_PrintReturnCode ( char * FunctionName, BLOWFISH_RC ReturnCo
 		{
 			return printf ( "%s()=Self-test failed!\n", FunctionName );
 		}
+		case BLOWFISH_RC_KERNEL_NOT_SUPPORTED:
+		{
+			return printf ( "%s()=Kernel not supported!\n", FunctionName );
+		}
+		case BLOWFISH_RC_CACHE_FULL:
+		{
+			return printf ( "%s()=Key cache full!\n", FunctionName );
+		}
+		case BLOWFISH_RC_INVALID_HASH:
+		{
+			return printf ( "%s()=Invalid hash!\n", FunctionName );
+		}
+		case BLOWFISH_RC_HASH_MISMATCH:
+		{
+			return printf ( "%s()=Hash mismatch!\n", FunctionName );
+		}
+		case BLOWFISH_RC_QUEUE_FULL:
+		{
+			return printf ( "%s()=Queue full!\n", FunctionName );
+		}
+		case BLOWFISH_RC_PENDING:
+		{
+			return printf ( "%s()=Pending!\n", FunctionName );
+		}
+		case BLOWFISH_RC_BAD_PADDING:
+		{
+			return printf ( "%s()=Bad padding!\n", FunctionName );
+		}
 		default:
 		{
 			return printf ( "%s()=Unknown error!\n", FunctionName );
@@ -260,6 +339,18 @@ static int _BLOWFISH_PrintMode ( BLOWFISH_MODE Mode )
 		{
 			return printf ( "Mode=Counter (CTR)\n" );
 		}
+		case BLOWFISH_MODE_CTR64:
+		{
+			return printf ( "Mode=Counter with 64-bit block counter (CTR64)\n" );
+		}
+		case BLOWFISH_MODE_CBC_CS3:
+		{
+			return printf ( "Mode=Cipher block chaining with ciphertext stealing (CBC-CS3)\n" );
+		}
+		case BLOWFISH_MODE_CBC_LANES:
+		{
+			return printf ( "Mode=Interleaved cipher block chaining lanes (CBC-LANES)\n" );
+		}
 		default:
 		{
 			return printf ( "Mode=Invalid!\n" );
@@ -267,6 +358,41 @@ static int _BLOWFISH_PrintMode ( BLOWFISH_MODE Mode )
 	}
 }
 
+/**
+
+	@internal
+
+	Display the name of the specified kernel to stdout.
+
+	@param Kernel	Kernel to display.
+
+	@return Return code from printf().
+
+  */ 
+
+static int _BLOWFISH_PrintKernel ( BLOWFISH_KERNEL Kernel )
+{
+	switch ( Kernel )
+	{
+		case BLOWFISH_KERNEL_SCALAR:
+		{
+			return printf ( "Kernel=Scalar\n" );
+		}
+		case BLOWFISH_KERNEL_INTERLEAVED:
+		{
+			return printf ( "Kernel=Interleaved scalar\n" );
+		}
+		case BLOWFISH_KERNEL_AVX512:
+		{
+			return printf ( "Kernel=AVX-512\n" );
+		}
+		default:
+		{
+			return printf ( "Kernel=Invalid!\n" );
+		}
+	}
+}
+
 /**
 
 	@internal
@@ -383,6 +509,16 @@ static BLOWFISH_RC _BLOWFISH_Test_ECB ( BLOWFISH_PUCHAR Key, BLOWFISH_ULONG KeyL
 
 			ReturnCode = BLOWFISH_RC_TEST_FAILED;
 		}
+
+		/* The inline single-block functions must give the same results */ 
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS && ( BLOWFISH_EncipherInline ( &Context.KeySchedule, (BLOWFISH_ULONGLONG)PlainTextHigh32 << 32 | PlainTextLow32 ) != ( (BLOWFISH_ULONGLONG)CipherTextHigh32 << 32 | CipherTextLow32 ) ||
+			BLOWFISH_DecipherInline ( &Context.KeySchedule, (BLOWFISH_ULONGLONG)CipherTextHigh32 << 32 | CipherTextLow32 ) != ( (BLOWFISH_ULONGLONG)PlainTextHigh32 << 32 | PlainTextLow32 ) ) )
+		{
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherInline", BLOWFISH_RC_TEST_FAILED );
+
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
 	}
 
 	printf ( "\n" );
@@ -511,13 +647,13 @@ static BLOWFISH_RC _BLOWFISH_Test_CBC_CFB_OFB ( BLOWFISH_PUCHAR Key, BLOWFISH_UL
 
 	@internal
 
-	Perform a stream based throughput test for the selected mode.
+	Encipher/decipher a buffer of data, and verify the results against the same data enciphered one block at a time with #BLOWFISH_Encipher.
 
-	@param Mode				Mode to use for the test.
+	@param Mode				Mode with which to run the test.
 
-	@param StreamBlockSize	Size of each chunk of the stream.
+	@param BufferLength		Length of the buffer to encipher/decipher. Must be a multiple of 8.
 
-	@remarks Enciphers/deciphers data as a stream for #_BLOWFISH_THROUGHPUT_DURATION seconds, and then calculates the throughput.
+	@remarks Ensures that every stream function (including the vectorised ones) produces the same output as the reference implementation.
 
 	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
 
@@ -525,196 +661,2968 @@ static BLOWFISH_RC _BLOWFISH_Test_CBC_CFB_OFB ( BLOWFISH_PUCHAR Key, BLOWFISH_UL
 
   */ 
 
-static BLOWFISH_RC _BLOWFISH_Test_Throughput ( BLOWFISH_MODE Mode, BLOWFISH_ULONG StreamBlockSize )
+static BLOWFISH_RC _BLOWFISH_Test_Reference ( BLOWFISH_MODE Mode, BLOWFISH_ULONG BufferLength )
 {
 	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
-	BLOWFISH_CONTEXT	EncipherContext;
-	BLOWFISH_CONTEXT	DecipherContext;
-	BLOWFISH_PUCHAR		PlainTextBuffer = 0;
-	BLOWFISH_PUCHAR		CipherTextBuffer = 0;
-	BLOWFISH_SIZE_T		i = 0;
-	BLOWFISH_SIZE_T		j = 0;
-	BLOWFISH_ULONG		Sum = 0;
-	clock_t				StartTime = 0;
-	clock_t				EndTime = 0;
-	clock_t				ElapsedEncipherTime = 0;
-	clock_t				ElapsedDecipherTime = 0;
-	float				BlocksProcessed = 0;
-#ifdef _OPENMP
-	BLOWFISH_SIZE_T		Threads = omp_get_max_threads ( );
-#else
-	BLOWFISH_SIZE_T		Threads = 1;
-#endif
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_PULONG		PlainText = 0;
+	BLOWFISH_PULONG		CipherText = 0;
+	BLOWFISH_PULONG		Expected = 0;
+	BLOWFISH_ULONG		XLeft = _BLOWFISH_Tv3Iv [ 0 ];
+	BLOWFISH_ULONG		XRight = _BLOWFISH_Tv3Iv [ 1 ];
+	BLOWFISH_ULONG		i;
 
-	/* Initialise blowfish for the encipher stream */ 
+	/* Initialise blowfish */ 
 
-	ReturnCode = BLOWFISH_Init ( &EncipherContext, (BLOWFISH_PUCHAR)"0123456789abcdef", 16, Mode, _BLOWFISH_Tv3Iv [ 0 ], _BLOWFISH_Tv3Iv [ 1 ] );
+	ReturnCode = BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"0123456789abcdef", 16, Mode, _BLOWFISH_Tv3Iv [ 0 ], _BLOWFISH_Tv3Iv [ 1 ] );
 
 	_BLOWFISH_PrintReturnCode ( "BLOWFISH_Init", ReturnCode );
 
 	_BLOWFISH_PrintMode ( Mode );
 
-	printf ( "Key=\"0123456789abcdef\"\n" );
-
-	if ( Mode != BLOWFISH_MODE_ECB )
-	{
-		_BLOWFISH_PrintBuffer ( "Initialisation vector", (BLOWFISH_PUCHAR)_BLOWFISH_Tv3Iv, 8 );
-	}
+	printf ( "Buffer length=%d bytes\n", (int)BufferLength );
 
 	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
 	{
-		/* Clone the context for the decipher stream */ 
-
-		ReturnCode = BLOWFISH_CloneContext ( &EncipherContext, &DecipherContext );
-
-		_BLOWFISH_PrintReturnCode ( "BLOWFISH_CloneContext", ReturnCode );
+		PlainText = (BLOWFISH_PULONG)malloc ( BufferLength );
+		CipherText = (BLOWFISH_PULONG)malloc ( BufferLength );
+		Expected = (BLOWFISH_PULONG)malloc ( BufferLength );
 
-		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		if ( PlainText != 0 && CipherText != 0 && Expected != 0 )
 		{
-			/* Allocate the plaintext buffer */ 
-
-			PlainTextBuffer = (BLOWFISH_PUCHAR)malloc ( StreamBlockSize );
+			/* Create the plaintext, and compute the expected ciphertext one block at a time */ 
 
-			if ( PlainTextBuffer != 0 )
+			for ( i = 0; i < BufferLength / 4; i += 2 )
 			{
-				/* Allocate the ciphertext buffer */ 
-
-				CipherTextBuffer = (BLOWFISH_PUCHAR)malloc ( StreamBlockSize );
+				PlainText [ i ] = i * 0x9e3779b9;
+				PlainText [ i + 1 ] = ~PlainText [ i ];
 
-				if ( CipherTextBuffer != 0 )
+				switch ( Mode )
 				{
-					/* Create original plaintext buffer (use 0x01 for ease of vectorised verification) */ 
+					case BLOWFISH_MODE_ECB:
+					{
+						XLeft = PlainText [ i ];
+						XRight = PlainText [ i + 1 ];
 
-					memset ( PlainTextBuffer, 0x01, StreamBlockSize );
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-					/* Begin the stream for enciphering */ 
+						Expected [ i ] = XLeft;
+						Expected [ i + 1 ] = XRight;
 
-					ReturnCode = BLOWFISH_BeginStream ( &EncipherContext );
+						break;
+					}
+					case BLOWFISH_MODE_CBC:
+					{
+						XLeft ^= PlainText [ i ];
+						XRight ^= PlainText [ i + 1 ];
 
-					_BLOWFISH_PrintReturnCode ( "BLOWFISH_BeginStream", ReturnCode );
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-					if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+						Expected [ i ] = XLeft;
+						Expected [ i + 1 ] = XRight;
+
+						break;
+					}
+					case BLOWFISH_MODE_CFB:
 					{
-						/* Begin the stream for deciphering */ 
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-						ReturnCode = BLOWFISH_BeginStream ( &DecipherContext );
+						XLeft ^= PlainText [ i ];
+						XRight ^= PlainText [ i + 1 ];
 
-						_BLOWFISH_PrintReturnCode ( "BLOWFISH_BeginStream", ReturnCode );
+						Expected [ i ] = XLeft;
+						Expected [ i + 1 ] = XRight;
 
-						if ( ReturnCode == BLOWFISH_RC_SUCCESS )
-						{
-							/* While the total elapsed time (in seconds) has not passed the duration threshold, keep enciphering/deciphering the stream */ 
+						break;
+					}
+					case BLOWFISH_MODE_OFB:
+					{
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-							for ( i = 0; ( ( ElapsedEncipherTime + ElapsedDecipherTime ) / Threads ) / CLOCKS_PER_SEC <= _BLOWFISH_THROUGHPUT_DURATION; i++ )
-							{
-								/* Clear the ciphertext buffer */ 
+						Expected [ i ] = PlainText [ i ] ^ XLeft;
+						Expected [ i + 1 ] = PlainText [ i + 1 ] ^ XRight;
 
-								memset ( CipherTextBuffer, 0x00, StreamBlockSize );
+						break;
+					}
+					case BLOWFISH_MODE_CTR:
+					{
+						XLeft = _BLOWFISH_Tv3Iv [ 0 ] + i;
+						XRight = _BLOWFISH_Tv3Iv [ 1 ] + i + 1;
 
-								/* Encipher the plaintext */ 
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-								StartTime = clock ( );
+						Expected [ i ] = PlainText [ i ] ^ XLeft;
+						Expected [ i + 1 ] = PlainText [ i + 1 ] ^ XRight;
 
-								ReturnCode = BLOWFISH_EncipherStream ( &EncipherContext, PlainTextBuffer, CipherTextBuffer, StreamBlockSize );
+						break;
+					}
+					case BLOWFISH_MODE_CTR64:
+					{
+						XLeft = _BLOWFISH_Tv3Iv [ 0 ];
+						XRight = _BLOWFISH_Tv3Iv [ 1 ] + i / 2;
 
-								EndTime = clock ( );
+						/* Carry into the high 32-bits when the low 32-bits wrap */ 
 
-								/* Compute the time elapsed enciphering (in milliseconds) */ 
+						if ( XRight < _BLOWFISH_Tv3Iv [ 1 ] )
+						{
+							XLeft++;
+						}
 
-								ElapsedEncipherTime += ( EndTime - StartTime );
+						BLOWFISH_Encipher ( &Context, &XLeft, &XRight );
 
-								if ( ReturnCode != BLOWFISH_RC_SUCCESS )
-								{
-									_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherStream", ReturnCode );
+						Expected [ i ] = PlainText [ i ] ^ XLeft;
+						Expected [ i + 1 ] = PlainText [ i + 1 ] ^ XRight;
 
-									break;
-								}
+						break;
+					}
+					default:
+					{
+						break;
+					}
+				}
+			}
 
-								/* Clear the plaintext buffer */ 
+			/* Encipher the plaintext buffer */ 
 
-								memset ( PlainTextBuffer, 0x00, StreamBlockSize );
+			ReturnCode = BLOWFISH_EncipherBuffer ( &Context, (BLOWFISH_PUCHAR)PlainText, (BLOWFISH_PUCHAR)CipherText, BufferLength );
 
-								/* Decipher the ciphertext */ 
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", ReturnCode );
 
-								StartTime = clock ( );
+			if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+			{
+				/* Is the ciphertext as expected? */ 
 
-								ReturnCode = BLOWFISH_DecipherStream ( &DecipherContext, CipherTextBuffer, PlainTextBuffer, StreamBlockSize );
+				if ( memcmp ( Expected, CipherText, BufferLength ) == 0 )
+				{
+					/* Decipher the ciphertext buffer */ 
 
-								EndTime = clock ( );
+					ReturnCode = BLOWFISH_DecipherBuffer ( &Context, (BLOWFISH_PUCHAR)CipherText, (BLOWFISH_PUCHAR)Expected, BufferLength );
 
-								/* Compute the time elapsed deciphering (in milliseconds) */ 
+					_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherBuffer", ReturnCode );
 
-								ElapsedDecipherTime += ( EndTime - StartTime );
+					/* Is the plaintext as expected? */ 
 
-								if ( ReturnCode != BLOWFISH_RC_SUCCESS )
-								{
-									_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherStream", ReturnCode );
+					if ( ReturnCode == BLOWFISH_RC_SUCCESS && memcmp ( PlainText, Expected, BufferLength ) != 0 )
+					{
+						_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherBuffer", BLOWFISH_RC_TEST_FAILED );
 
-									break;
-								}
+						ReturnCode = BLOWFISH_RC_TEST_FAILED;
+					}
+				}
+				else
+				{
+					_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", BLOWFISH_RC_TEST_FAILED );
 
-								/* Verify the integrity of the deciphered plaintext (sum of all bytes should equal the buffer length) */ 
+					ReturnCode = BLOWFISH_RC_TEST_FAILED;
+				}
+			}
+		}
+		else
+		{
+			ReturnCode = BLOWFISH_RC_ERROR;
+		}
 
-								for ( j = 0, Sum = 0; j < (BLOWFISH_SIZE_T)StreamBlockSize; j++ )
-								{
-									Sum += PlainTextBuffer [ j ];
-								}
+		free ( PlainText );
+		free ( CipherText );
+		free ( Expected );
+	}
 
-								if ( Sum != StreamBlockSize )
-								{
-									printf ( "BLOWFISH_EncipherStream()/BLOWFISH_DecipherStream()=Integrity check failed!\n" );
+	printf ( "\n" );
 
-									ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	/* Overwrite the blowfish context record */ 
 
-									break;
-								}
-							}
+	BLOWFISH_Exit ( &Context );
 
-							if ( ReturnCode == BLOWFISH_RC_SUCCESS )
-							{
-								/* Ensure we managed to encipher/decipher enough data to determine the throughput in MB/s */ 
+	return ReturnCode;
+}
 
-								if ( ( i * StreamBlockSize ) > ( 1024 * 1024 ) )
-								{
-									/* Adjust elapsed time based on thread count */
+/**
 
-									ElapsedEncipherTime = ElapsedEncipherTime / Threads;
-									ElapsedDecipherTime = ElapsedDecipherTime / Threads;
+	@internal
 
-									/* Convert elapsed time from milliseconds to seconds (minimum 1 second) */ 
+	Decipher ranges of a #BLOWFISH_MODE_CTR64 stream (some starting within a block) with #BLOWFISH_SeekStream, and compare them against the stream deciphered from its start.
 
-									ElapsedEncipherTime = ElapsedEncipherTime / CLOCKS_PER_SEC > 1 ? ElapsedEncipherTime / CLOCKS_PER_SEC : 1;
-									ElapsedDecipherTime = ElapsedDecipherTime / CLOCKS_PER_SEC > 1 ? ElapsedDecipherTime / CLOCKS_PER_SEC : 1;
+	@remarks The initial counter is chosen so that its low 32-bits wrap within the stream.
 
-									/* Calculate and display the stream length */ 
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
 
-									BlocksProcessed = (float)( (float)( i * StreamBlockSize ) / ( 1024 * 1024 ) );
+	@return Specific return code, see #BLOWFISH_RC.
 
-									printf ( "Stream length=%0.2f MB (%d*%d byte blocks)\n", BlocksProcessed, (int)i, (int)StreamBlockSize );
+  */ 
 
-									/* Calculate and display throughputs */ 
+static BLOWFISH_RC _BLOWFISH_Test_Seek ( void )
+{
+	static const BLOWFISH_ULONG	Range [ ] [ 2 ] = { { 0, 4104 }, { 8, 64 }, { 120, 136 }, { 1024, 8 }, { 2048, 2056 }, { 13, 3 }, { 1021, 100 }, { 4097, 7 } };
 
-									printf ( "Encipher throughput=%0.2f MB/s\n", BlocksProcessed / ElapsedEncipherTime );
-									printf ( "Decipher throughput=%0.2f MB/s\n", BlocksProcessed / ElapsedDecipherTime );
-									printf ( "Average throughput=%0.2f MB/s\n", ( ( BlocksProcessed / ElapsedDecipherTime ) + ( BlocksProcessed / ElapsedEncipherTime ) ) / 2 );
-								}
-								else
-								{
-									printf ( "Failed to process enough data to determine throughput in MB/s!\n" );
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_UCHAR		PlainText [ 4104 ];
+	BLOWFISH_UCHAR		CipherText [ 4104 ];
+	BLOWFISH_UCHAR		Output [ 4104 ];
+	BLOWFISH_ULONG		i;
 
-									ReturnCode = BLOWFISH_RC_TEST_FAILED;
-								}
-							}
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 31 + 5 );
+	}
 
-							/* Finished decipering */ 
+	ReturnCode = BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"0123456789abcdef", 16, BLOWFISH_MODE_CTR64, 0x01234567, 0xffffffe0 );
 
-							BLOWFISH_EndStream ( &DecipherContext );
-						}
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_Init", ReturnCode );
 
-						/* Finished encipering */ 
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		ReturnCode = BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, sizeof ( PlainText ) );
 
-						BLOWFISH_EndStream ( &EncipherContext );
-					}
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", ReturnCode );
+	}
+
+	/* Decipher each range without processing the data before it */ 
+
+	for ( i = 0; i < sizeof ( Range ) / sizeof ( Range [ 0 ] ) && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+	{
+		printf ( "Offset=%d bytes, length=%d bytes\n", (int)Range [ i ] [ 0 ], (int)Range [ i ] [ 1 ] );
+
+		BLOWFISH_BeginStream ( &Context );
+
+		ReturnCode = BLOWFISH_SeekStream ( &Context, Range [ i ] [ 0 ] );
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_SeekStream", ReturnCode );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			ReturnCode = BLOWFISH_DecipherStream ( &Context, CipherText + Range [ i ] [ 0 ], Output, Range [ i ] [ 1 ] );
+
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherStream", ReturnCode );
+
+			if ( ReturnCode == BLOWFISH_RC_SUCCESS && memcmp ( Output, PlainText + Range [ i ] [ 0 ], Range [ i ] [ 1 ] ) != 0 )
+			{
+				ReturnCode = BLOWFISH_RC_TEST_FAILED;
+
+				_BLOWFISH_PrintReturnCode ( "memcmp", ReturnCode );
+			}
+		}
+
+		BLOWFISH_EndStream ( &Context );
+	}
+
+	/* #BLOWFISH_MODE_ECB streams cannot be positioned within a block, and streams in chained modes cannot be positioned at all */ 
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		BLOWFISH_Reset ( &Context, 0, 0, BLOWFISH_MODE_ECB, 0, 0 );
+
+		ReturnCode = BLOWFISH_SeekStream ( &Context, 12 ) == BLOWFISH_RC_BAD_BUFFER_LENGTH ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_TEST_FAILED;
+	}
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		BLOWFISH_Reset ( &Context, 0, 0, BLOWFISH_MODE_CBC, 0, 0 );
+
+		ReturnCode = BLOWFISH_SeekStream ( &Context, 8 ) == BLOWFISH_RC_INVALID_MODE ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_TEST_FAILED;
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_SeekStream", ReturnCode );
+	}
+
+	BLOWFISH_Exit ( &Context );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher and decipher a stream in buffers of irregular lengths in each mode, and compare the output against the stream processed as a single buffer.
+
+	@remarks #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC streams are also ended part way through a block, which must be reported. #BLOWFISH_MODE_CTR is skipped, as its counters depend on how the stream is divided.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Chunked ( void )
+{
+	static const BLOWFISH_SIZE_T	Chunk [ ] = { 1, 7, 3, 8, 13, 5, 64, 2, 9, 203, 6, 15, 4, 11 };
+
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_UCHAR		PlainText [ 1032 ];
+	BLOWFISH_UCHAR		CipherText [ 1032 ];
+	BLOWFISH_UCHAR		Output [ 1032 + 7 ];
+	BLOWFISH_UCHAR		Input [ 1032 ];
+	BLOWFISH_SIZE_T		StreamLength;
+	BLOWFISH_SIZE_T		Offset;
+	BLOWFISH_SIZE_T		Length;
+	BLOWFISH_SIZE_T		Written;
+	BLOWFISH_ULONG		i;
+	int					Mode;
+	int					Decipher;
+	int					Buffered;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 17 + 3 );
+	}
+
+	for ( Mode = BLOWFISH_MODE_ECB; Mode <= BLOWFISH_MODE_CTR64; Mode += Mode == BLOWFISH_MODE_OFB ? 2 : 1 )
+	{
+		/* Block modes can only be whole blocks in total, keystream modes need not be */ 
+
+		Buffered = Mode == BLOWFISH_MODE_ECB || Mode == BLOWFISH_MODE_CBC;
+		StreamLength = Buffered ? 1024 : 1027;
+
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"chunked stream", 14, (BLOWFISH_MODE)Mode, 0x89abcdef, 0x01234567 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, sizeof ( CipherText ) ) != BLOWFISH_RC_SUCCESS;
+
+		for ( Decipher = 0; Decipher < 2; Decipher++ )
+		{
+			memcpy ( Input, Decipher ? CipherText : PlainText, sizeof ( Input ) );
+			memset ( Output, 0, sizeof ( Output ) );
+
+			BLOWFISH_BeginStream ( &Context );
+
+			/* Start at a different chunk to decipher, so the buffers do not line up with those used to encipher */ 
+
+			for ( Offset = 0, Written = 0, i = (BLOWFISH_ULONG)Decipher * 5; Offset < StreamLength; Offset += Length, i++ )
+			{
+				Length = Chunk [ i % ( sizeof ( Chunk ) / sizeof ( Chunk [ 0 ] ) ) ];
+
+				if ( Length > StreamLength - Offset )
+				{
+					Length = StreamLength - Offset;
+				}
+
+				Failures += ( Decipher ? BLOWFISH_DecipherStream : BLOWFISH_EncipherStream ) ( &Context, Input + Offset, Output + Written, Length ) != BLOWFISH_RC_SUCCESS;
+
+				Written = Buffered ? ( Offset + Length ) & ~(BLOWFISH_SIZE_T)0x07 : Offset + Length;
+
+				Failures += BLOWFISH_GetStreamPending ( &Context ) != (BLOWFISH_ULONG)( ( Offset + Length ) & 0x07 );
+			}
+
+			Failures += memcmp ( Output, Decipher ? PlainText : CipherText, StreamLength ) != 0;
+
+			/* Bytes left over from a block mode stream are discarded and reported */ 
+
+			if ( Buffered )
+			{
+				Failures += ( Decipher ? BLOWFISH_DecipherStream : BLOWFISH_EncipherStream ) ( &Context, Input, Output, 3 ) != BLOWFISH_RC_SUCCESS;
+				Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+			}
+			else
+			{
+				Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+			}
+
+			Failures += BLOWFISH_GetStreamPending ( &Context ) != 0;
+		}
+
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText, CipherText, 0 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	printf ( "Chunked streams, lengths=%d-%d bytes\n", 1, 203 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherStream", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Byte swap each 32-bit word of a buffer.
+
+	@param Buffer		Buffer to swap.
+
+	@param BufferLength	Length of the buffer in bytes (a multiple of 4).
+
+  */ 
+
+static void _BLOWFISH_SwapBuffer ( BLOWFISH_PUCHAR Buffer, BLOWFISH_ULONG BufferLength )
+{
+	BLOWFISH_UCHAR	Byte;
+	BLOWFISH_ULONG	i;
+
+	for ( i = 0; i < BufferLength; i += 4 )
+	{
+		Byte = Buffer [ i ];
+		Buffer [ i ] = Buffer [ i + 3 ];
+		Buffer [ i + 3 ] = Byte;
+		Byte = Buffer [ i + 1 ];
+		Buffer [ i + 1 ] = Buffer [ i + 2 ];
+		Buffer [ i + 2 ] = Byte;
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Encipher and decipher unaligned buffers in big-endian byte order, comparing the output against standard test vector 3, and in each mode against the host byte order with the buffers swapped by the caller.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_ByteOrder ( void )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_UCHAR		PlainText [ 4104 + 1 ];
+	BLOWFISH_UCHAR		CipherText [ 4104 + 1 ];
+	BLOWFISH_UCHAR		Expected [ 4104 ];
+	BLOWFISH_UCHAR		Swapped [ 4104 ];
+	BLOWFISH_PCUCHAR	PlainTextBuffers [ 1 ];
+	BLOWFISH_PUCHAR		CipherTextBuffers [ 1 ];
+	BLOWFISH_SIZE_T		BufferLengths [ 1 ] = { 4104 };
+	BLOWFISH_ULONG		IvHigh32 [ 1 ] = { 0x89abcdef };
+	BLOWFISH_ULONG		IvLow32 [ 1 ] = { 0x01234567 };
+	BLOWFISH_ULONG		i;
+	BLOWFISH_ULONG		j;
+	int					Failures = 0;
+
+	/* Test vector 3 is defined as big-endian bytes, so must be reproduced from bytes on any host */ 
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_Tv3Mode ) / sizeof ( _BLOWFISH_Tv3Mode [ 0 ] ); i++ )
+	{
+		for ( j = 0; j < sizeof ( _BLOWFISH_Tv3PlainText ); j++ )
+		{
+			PlainText [ j + 1 ] = (BLOWFISH_UCHAR)( _BLOWFISH_Tv3PlainText [ j >> 2 ] >> ( 24 - ( j & 0x03 ) * 8 ) );
+			Expected [ j ] = (BLOWFISH_UCHAR)( _BLOWFISH_Tv3CipherText [ i ] [ j >> 2 ] >> ( 24 - ( j & 0x03 ) * 8 ) );
+		}
+
+		Failures += BLOWFISH_Init ( &Context, _BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ), _BLOWFISH_Tv3Mode [ i ], _BLOWFISH_Tv3Iv [ 0 ], _BLOWFISH_Tv3Iv [ 1 ] ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_SetByteOrder ( &Context, BLOWFISH_BYTE_ORDER_BIG_ENDIAN ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText + 1, CipherText + 1, sizeof ( _BLOWFISH_Tv3PlainText ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( CipherText + 1, Expected, sizeof ( _BLOWFISH_Tv3PlainText ) ) != 0;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 29 + 5 );
+	}
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ); i++ )
+	{
+		/* Encipher the swapped plaintext in host byte order, and swap the ciphertext back */ 
+
+		memcpy ( Swapped, PlainText + 1, sizeof ( Swapped ) );
+
+		_BLOWFISH_SwapBuffer ( Swapped, sizeof ( Swapped ) );
+
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"byte order", 10, _BLOWFISH_ReferenceMode [ i ], IvHigh32 [ 0 ], IvLow32 [ 0 ] ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherBuffer ( &Context, Swapped, Expected, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+
+		_BLOWFISH_SwapBuffer ( Expected, sizeof ( Expected ) );
+
+		/* Encipher and decipher the unaligned buffers in big-endian byte order */ 
+
+		Failures += BLOWFISH_SetByteOrder ( &Context, BLOWFISH_BYTE_ORDER_BIG_ENDIAN ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText + 1, CipherText + 1, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( CipherText + 1, Expected, sizeof ( Expected ) ) != 0;
+
+		Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText + 1, Swapped, sizeof ( Swapped ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( Swapped, PlainText + 1, sizeof ( Swapped ) ) != 0;
+
+		/* Multi-buffer messages are enciphered in the byte order of the context record */ 
+
+		if ( _BLOWFISH_ReferenceMode [ i ] == BLOWFISH_MODE_CBC )
+		{
+			PlainTextBuffers [ 0 ] = PlainText + 1;
+			CipherTextBuffers [ 0 ] = CipherText + 1;
+
+			memset ( CipherText, 0, sizeof ( CipherText ) );
+
+			Failures += BLOWFISH_EncipherBufferMulti ( &Context, 1, PlainTextBuffers, CipherTextBuffers, BufferLengths, IvHigh32, IvLow32 ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( CipherText + 1, Expected, sizeof ( Expected ) ) != 0;
+		}
+
+		/* Setting the mode restores the host byte order */ 
+
+		Failures += BLOWFISH_Reset ( &Context, (BLOWFISH_PUCHAR)"byte order", 10, _BLOWFISH_ReferenceMode [ i ], IvHigh32 [ 0 ], IvLow32 [ 0 ] ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText + 1, CipherText + 1, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( CipherText + 1, Expected, sizeof ( Expected ) ) == 0;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	Failures += BLOWFISH_SetByteOrder ( 0, BLOWFISH_BYTE_ORDER_HOST ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_SetByteOrder ( &Context, (BLOWFISH_BYTE_ORDER)( BLOWFISH_BYTE_ORDER_BIG_ENDIAN + 1 ) ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+	printf ( "Big-endian unaligned buffers, length=%d bytes\n", 4104 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_SetByteOrder", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher and decipher buffers of every length up to several blocks with PKCS#7 padding in #BLOWFISH_MODE_ECB and #BLOWFISH_MODE_CBC, comparing against buffers padded by the caller, both out of place and in place.
+
+	@remarks Final blocks with padding bytes of zero, greater than 8, or that differ, must be rejected.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Padded ( void )
+{
+	static const BLOWFISH_UCHAR		BadFinalBlock [ ] [ 8 ] =
+	{
+		{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x00 },
+		{ 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09 },
+		{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x02, 0x03 },
+		{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x04, 0x04, 0x04 }
+	};
+
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_UCHAR		PlainText [ 1032 ];
+	BLOWFISH_UCHAR		Padded [ 1032 + 8 ];
+	BLOWFISH_UCHAR		Expected [ 1032 + 8 ];
+	BLOWFISH_UCHAR		CipherText [ 1032 + 8 ];
+	BLOWFISH_UCHAR		InPlace [ 1032 + 8 ];
+	BLOWFISH_SIZE_T		Length;
+	BLOWFISH_SIZE_T		PaddedLength;
+	BLOWFISH_SIZE_T		PlainTextLength;
+	BLOWFISH_ULONG		i;
+	int					Mode;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 13 + 11 );
+	}
+
+	for ( Mode = BLOWFISH_MODE_ECB; Mode <= BLOWFISH_MODE_CBC; Mode++ )
+	{
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"padded buffer", 13, (BLOWFISH_MODE)Mode, 0x89abcdef, 0x01234567 ) != BLOWFISH_RC_SUCCESS;
+
+		for ( Length = 0; Length <= 1027; Length += Length < 24 ? 1 : 1003 )
+		{
+			PaddedLength = BLOWFISH_PADDED_LENGTH ( Length );
+
+			Failures += PaddedLength <= Length || PaddedLength > Length + 8 || ( PaddedLength & 0x07 ) != 0;
+
+			/* Pad a copy of the plaintext, and encipher it as a whole number of blocks */ 
+
+			memcpy ( Padded, PlainText, Length );
+			memset ( Padded + Length, (int)( PaddedLength - Length ), PaddedLength - Length );
+
+			Failures += BLOWFISH_EncipherBuffer ( &Context, Padded, Expected, PaddedLength ) != BLOWFISH_RC_SUCCESS;
+
+			/* Encipher and decipher the plaintext directly */ 
+
+			memset ( CipherText, 0, sizeof ( CipherText ) );
+
+			Failures += BLOWFISH_EncipherBufferPadded ( &Context, PlainText, CipherText, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( CipherText, Expected, PaddedLength ) != 0;
+
+			memset ( Padded, 0, sizeof ( Padded ) );
+
+			Failures += BLOWFISH_DecipherBufferPadded ( &Context, CipherText, Padded, PaddedLength, &PlainTextLength ) != BLOWFISH_RC_SUCCESS;
+			Failures += PlainTextLength != Length || memcmp ( Padded, PlainText, Length ) != 0;
+
+			/* Only the plaintext is written, not the padding */ 
+
+			Failures += Padded [ Length ] != 0;
+
+			/* Encipher and decipher in place */ 
+
+			memcpy ( InPlace, PlainText, Length );
+
+			Failures += BLOWFISH_EncipherBufferPadded ( &Context, InPlace, InPlace, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( InPlace, Expected, PaddedLength ) != 0;
+
+			Failures += BLOWFISH_DecipherBufferPadded ( &Context, InPlace, InPlace, PaddedLength, &PlainTextLength ) != BLOWFISH_RC_SUCCESS;
+			Failures += PlainTextLength != Length || memcmp ( InPlace, PlainText, Length ) != 0;
+		}
+
+		/* Reject final blocks that are not correctly padded */ 
+
+		for ( i = 0; i < sizeof ( BadFinalBlock ) / sizeof ( BadFinalBlock [ 0 ] ); i++ )
+		{
+			memcpy ( Padded, PlainText, 16 );
+			memcpy ( Padded + 16, BadFinalBlock [ i ], 8 );
+
+			Failures += BLOWFISH_EncipherBuffer ( &Context, Padded, CipherText, 24 ) != BLOWFISH_RC_SUCCESS;
+			Failures += BLOWFISH_DecipherBufferPadded ( &Context, CipherText, Padded, 24, &PlainTextLength ) != BLOWFISH_RC_BAD_PADDING;
+		}
+
+		Failures += BLOWFISH_DecipherBufferPadded ( &Context, CipherText, Padded, 12, &PlainTextLength ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		Failures += BLOWFISH_DecipherBufferPadded ( &Context, CipherText, Padded, 24, 0 ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	/* Padding is not defined for the other modes */ 
+
+	Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"padded buffer", 13, BLOWFISH_MODE_CTR64, 0x89abcdef, 0x01234567 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBufferPadded ( &Context, PlainText, CipherText, 8 ) != BLOWFISH_RC_INVALID_MODE;
+	Failures += BLOWFISH_DecipherBufferPadded ( &Context, CipherText, Padded, 8, &PlainTextLength ) != BLOWFISH_RC_INVALID_MODE;
+
+	BLOWFISH_Exit ( &Context );
+
+	printf ( "PKCS#7 padded buffers, lengths=%d-%d bytes\n", 0, 1027 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBufferPadded", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher and decipher buffers of every length up to several blocks in #BLOWFISH_MODE_CBC_CS3, comparing against #BLOWFISH_MODE_CBC buffers padded with zeros by the caller, whose last two blocks are swapped and truncated.
+
+	@remarks Larger buffers are deciphered in parallel ranges where a thread or executor is available. Enciphering in place, the job API, and rejecting short buffers and streams are also tested.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_CBC_CS3 ( void )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_CONTEXT	Reference;
+	BLOWFISH_JOB		Job;
+	BLOWFISH_UCHAR		PlainText [ 4100 ];
+	BLOWFISH_UCHAR		Padded [ 4104 ];
+	BLOWFISH_UCHAR		Expected [ 4104 ];
+	BLOWFISH_UCHAR		CipherText [ 4104 ];
+	BLOWFISH_UCHAR		InPlace [ 4104 ];
+	BLOWFISH_SIZE_T		Length;
+	BLOWFISH_SIZE_T		WholeLength;
+	BLOWFISH_SIZE_T		FinalLength;
+	BLOWFISH_ULONG		i;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 29 + 3 );
+	}
+
+	Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"ciphertext stealing", 19, BLOWFISH_MODE_CBC_CS3, 0x76543210, 0xfedcba98 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_Init ( &Reference, (BLOWFISH_PUCHAR)"ciphertext stealing", 19, BLOWFISH_MODE_CBC, 0x76543210, 0xfedcba98 ) != BLOWFISH_RC_SUCCESS;
+
+	_BLOWFISH_PrintMode ( BLOWFISH_MODE_CBC_CS3 );
+
+	for ( Length = 8; Length <= 4100; Length += Length < 40 ? 1 : Length < 1027 ? 987 : 3073 )
+	{
+		WholeLength = ( Length - 1 ) & ~(BLOWFISH_SIZE_T)0x07;
+		FinalLength = Length - WholeLength;
+
+		/* Encipher a copy of the plaintext padded with zeros, then swap the last two blocks and truncate the final one */ 
+
+		memset ( Padded, 0, sizeof ( Padded ) );
+		memcpy ( Padded, PlainText, Length );
+
+		Failures += BLOWFISH_EncipherBuffer ( &Reference, Padded, Expected, WholeLength + 8 ) != BLOWFISH_RC_SUCCESS;
+
+		if ( WholeLength != 0 )
+		{
+			memcpy ( Padded, Expected + WholeLength - 8, 8 );
+			memcpy ( Expected + WholeLength - 8, Expected + WholeLength, 8 );
+			memcpy ( Expected + WholeLength, Padded, FinalLength );
+		}
+
+		/* Encipher and decipher the plaintext directly, without writing beyond the end of either buffer */ 
+
+		memset ( CipherText, 0xa5, sizeof ( CipherText ) );
+
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, Length ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( CipherText, Expected, Length ) != 0 || CipherText [ Length ] != 0xa5;
+
+		memset ( Padded, 0xa5, sizeof ( Padded ) );
+
+		Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Padded, Length ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( Padded, PlainText, Length ) != 0 || Padded [ Length ] != 0xa5;
+
+		/* Encipher and decipher in place */ 
+
+		memcpy ( InPlace, PlainText, Length );
+
+		Failures += BLOWFISH_EncipherBuffer ( &Context, InPlace, InPlace, Length ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( InPlace, Expected, Length ) != 0;
+
+		Failures += BLOWFISH_DecipherBuffer ( &Context, InPlace, InPlace, Length ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( InPlace, PlainText, Length ) != 0;
+
+		/* Decipher as a job */ 
+
+		memset ( &Job, 0, sizeof ( Job ) );
+
+		Job.Context = &Context;
+		Job.Operation = BLOWFISH_OPERATION_DECIPHER;
+		Job.InBuffer = CipherText;
+		Job.OutBuffer = Padded;
+		Job.BufferLength = Length;
+
+		memset ( Padded, 0, sizeof ( Padded ) );
+
+		Failures += BLOWFISH_ProcessBatch ( 1, &Job ) != BLOWFISH_RC_SUCCESS || Job.ReturnCode != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( Padded, PlainText, Length ) != 0;
+	}
+
+	/* Buffers shorter than a block cannot steal ciphertext, and the final block cannot be known while streaming */ 
+
+	Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, 7 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Padded, 7 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	Failures += BLOWFISH_EncipherStream ( &Context, PlainText, CipherText, 16 ) != BLOWFISH_RC_INVALID_MODE;
+	Failures += BLOWFISH_DecipherStream ( &Context, CipherText, Padded, 16 ) != BLOWFISH_RC_INVALID_MODE;
+
+	/* Without ciphertext stealing, buffers must be whole blocks */ 
+
+	Failures += BLOWFISH_Reset ( &Context, 0, 0, BLOWFISH_MODE_CBC, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, 12 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Padded, 12 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+
+	BLOWFISH_Exit ( &Reference );
+	BLOWFISH_Exit ( &Context );
+
+	printf ( "Ciphertext stealing buffers, lengths=%d-%d bytes\n", 8, 4100 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher and decipher buffers in #BLOWFISH_MODE_CBC_LANES in both byte orders, comparing each lane against a #BLOWFISH_MODE_CBC buffer of its blocks enciphered with the lane's initialisation vector.
+
+	@remarks The lengths leave lanes with no blocks, lanes one block longer than the others, and (with a lowered parallel threshold) buffers split into slices run in parallel. Deciphering in place, the job API, and rejecting partial blocks, streams and padding are also tested.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_CBC_Lanes ( void )
+{
+	static const BLOWFISH_ULONG		Lengths [ ] = { 8, 504, 512, 520, 4104, 16392 };
+
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_SESSION	Lane;
+	BLOWFISH_JOB		Job;
+	BLOWFISH_UCHAR		PlainText [ 16392 ];
+	BLOWFISH_UCHAR		Expected [ 16392 ];
+	BLOWFISH_UCHAR		CipherText [ 16392 ];
+	BLOWFISH_UCHAR		Gathered [ 16392 ];
+	BLOWFISH_ULONG		BaseHigh32 = 0x89abcdef;
+	BLOWFISH_ULONG		BaseLow32 = 0x01234567;
+	BLOWFISH_ULONG		LaneHigh32;
+	BLOWFISH_ULONG		LaneLow32;
+	BLOWFISH_SIZE_T		Length;
+	BLOWFISH_SIZE_T		Blocks;
+	BLOWFISH_ULONG		i;
+	BLOWFISH_ULONG		j;
+	BLOWFISH_ULONG		k;
+	int					ByteOrder;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 41 + 7 );
+	}
+
+	_BLOWFISH_PrintMode ( BLOWFISH_MODE_CBC_LANES );
+
+	BLOWFISH_SetParallelThreshold ( 1024 );
+
+	for ( ByteOrder = BLOWFISH_BYTE_ORDER_HOST; ByteOrder <= BLOWFISH_BYTE_ORDER_BIG_ENDIAN; ByteOrder++ )
+	{
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"interleaved lanes", 17, BLOWFISH_MODE_CBC_LANES, BaseHigh32, BaseLow32 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_SetByteOrder ( &Context, (BLOWFISH_BYTE_ORDER)ByteOrder ) != BLOWFISH_RC_SUCCESS;
+
+		for ( i = 0; i < sizeof ( Lengths ) / sizeof ( Lengths [ 0 ] ); i++ )
+		{
+			Length = Lengths [ i ];
+			Blocks = Length / 8;
+
+			/* Encipher the blocks of each lane as a CBC buffer, with the initialisation vector Ek ( Ek ( Iv ) XOR j ) */ 
+
+			for ( j = 0; j < BLOWFISH_CBC_LANES && j < Blocks; j++ )
+			{
+				LaneHigh32 = BaseHigh32;
+				LaneLow32 = BaseLow32;
+
+				BLOWFISH_Encipher ( &Context, &LaneHigh32, &LaneLow32 );
+
+				LaneLow32 ^= j;
+
+				BLOWFISH_Encipher ( &Context, &LaneHigh32, &LaneLow32 );
+
+				Failures += BLOWFISH_InitSession ( &Lane, &Context.KeySchedule, BLOWFISH_MODE_CBC, LaneHigh32, LaneLow32 ) != BLOWFISH_RC_SUCCESS;
+				Failures += BLOWFISH_SetSessionByteOrder ( &Lane, (BLOWFISH_BYTE_ORDER)ByteOrder ) != BLOWFISH_RC_SUCCESS;
+
+				for ( k = 0; j + k * BLOWFISH_CBC_LANES < Blocks; k++ )
+				{
+					memcpy ( Gathered + k * 8, PlainText + ( j + k * BLOWFISH_CBC_LANES ) * 8, 8 );
+				}
+
+				Failures += BLOWFISH_EncipherSessionBuffer ( &Lane, Gathered, Gathered, k * 8 ) != BLOWFISH_RC_SUCCESS;
+
+				for ( k = 0; j + k * BLOWFISH_CBC_LANES < Blocks; k++ )
+				{
+					memcpy ( Expected + ( j + k * BLOWFISH_CBC_LANES ) * 8, Gathered + k * 8, 8 );
+				}
+
+				BLOWFISH_ExitSession ( &Lane );
+			}
+
+			/* Encipher and decipher the buffer, out of place and in place */ 
+
+			Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( CipherText, Expected, Length ) != 0;
+
+			Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Gathered, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( Gathered, PlainText, Length ) != 0;
+
+			memcpy ( Gathered, PlainText, Length );
+
+			Failures += BLOWFISH_EncipherBuffer ( &Context, Gathered, Gathered, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( Gathered, Expected, Length ) != 0;
+
+			Failures += BLOWFISH_DecipherBuffer ( &Context, Gathered, Gathered, Length ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( Gathered, PlainText, Length ) != 0;
+
+			/* Decipher as a job */ 
+
+			memset ( &Job, 0, sizeof ( Job ) );
+
+			Job.Context = &Context;
+			Job.Operation = BLOWFISH_OPERATION_DECIPHER;
+			Job.InBuffer = CipherText;
+			Job.OutBuffer = Gathered;
+			Job.BufferLength = Length;
+
+			memset ( Gathered, 0, sizeof ( Gathered ) );
+
+			Failures += BLOWFISH_ProcessBatch ( 1, &Job ) != BLOWFISH_RC_SUCCESS || Job.ReturnCode != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( Gathered, PlainText, Length ) != 0;
+		}
+
+		/* Only whole buffers of whole blocks can be split into lanes */ 
+
+		Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, 12 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Gathered, 12 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText, CipherText, 16 ) != BLOWFISH_RC_INVALID_MODE;
+		Failures += BLOWFISH_DecipherStream ( &Context, CipherText, Gathered, 16 ) != BLOWFISH_RC_INVALID_MODE;
+		Failures += BLOWFISH_EncipherBufferPadded ( &Context, PlainText, CipherText, 12 ) != BLOWFISH_RC_INVALID_MODE;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	BLOWFISH_SetParallelThreshold ( BLOWFISH_DEFAULT_PARALLEL_THRESHOLD );
+
+	printf ( "Interleaved CBC lanes buffers, lengths=%d-%d bytes\n", 8, 16392 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Decipher buffers in place in #BLOWFISH_MODE_CBC and #BLOWFISH_MODE_CFB, with a parallel threshold low enough that longer buffers are split between threads, and compare them against buffers deciphered out of place.
+
+	@remarks The lengths leave partial groups for the interleaved and vectorised kernels, and ranges that are not a whole number of groups.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_InPlace ( void )
+{
+	static const BLOWFISH_ULONG		Lengths [ ] = { 8, 40, 136, 1032, 4104 };
+
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_UCHAR		PlainText [ 4104 ];
+	BLOWFISH_UCHAR		CipherText [ 4104 ];
+	BLOWFISH_UCHAR		InPlace [ 4104 ];
+	BLOWFISH_ULONG		i;
+	BLOWFISH_ULONG		j;
+	int					Mode;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 37 + 5 );
+	}
+
+	BLOWFISH_SetParallelThreshold ( 64 );
+
+	for ( Mode = BLOWFISH_MODE_CBC; Mode <= BLOWFISH_MODE_CFB; Mode++ )
+	{
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"in place", 8, (BLOWFISH_MODE)Mode, 0x13579bdf, 0x02468ace ) != BLOWFISH_RC_SUCCESS;
+
+		for ( j = 0; j < sizeof ( Lengths ) / sizeof ( Lengths [ 0 ] ); j++ )
+		{
+			Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, CipherText, Lengths [ j ] ) != BLOWFISH_RC_SUCCESS;
+
+			memcpy ( InPlace, CipherText, Lengths [ j ] );
+
+			Failures += BLOWFISH_DecipherBuffer ( &Context, InPlace, InPlace, Lengths [ j ] ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( InPlace, PlainText, Lengths [ j ] ) != 0;
+		}
+
+		/* A stream deciphered in place in two calls chains the second from the end of the first */ 
+
+		memcpy ( InPlace, CipherText, sizeof ( InPlace ) );
+
+		Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_DecipherStream ( &Context, InPlace, InPlace, 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_DecipherStream ( &Context, InPlace + 1024, InPlace + 1024, sizeof ( InPlace ) - 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+		Failures += memcmp ( InPlace, PlainText, sizeof ( PlainText ) ) != 0;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	BLOWFISH_SetParallelThreshold ( BLOWFISH_DEFAULT_PARALLEL_THRESHOLD );
+
+	printf ( "In place CBC/CFB decipher, lengths=%d-%d bytes\n", 8, 4104 );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherBuffer", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher blocks with a mix of key schedules using #BLOWFISH_EncipherMultiKey, compare each against #BLOWFISH_Encipher with the same key, then decipher them back with #BLOWFISH_DecipherMultiKey.
+
+	@remarks The block count leaves a partial window, and a partial group of blocks for the interleaved and vectorised kernels.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_MultiKey ( void )
+{
+	BLOWFISH_RC				ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT		Contexts [ 5 ];
+	BLOWFISH_PCKEY_SCHEDULE	KeySchedules [ 605 ];
+	BLOWFISH_ULONG			High32 [ 605 ];
+	BLOWFISH_ULONG			Low32 [ 605 ];
+	BLOWFISH_ULONG			ExpectedHigh32;
+	BLOWFISH_ULONG			ExpectedLow32;
+	BLOWFISH_UCHAR			Key [ 8 ] = { 'm', 'u', 'l', 't', 'i', 'k', 'e', 'y' };
+	BLOWFISH_SIZE_T			BlockCount = (BLOWFISH_SIZE_T)( sizeof ( High32 ) / sizeof ( High32 [ 0 ] ) );
+	BLOWFISH_SIZE_T			i;
+	int						Failures = 0;
+
+	printf ( "Multi-key blocks=%d\n", (int)BlockCount );
+
+	for ( i = 0; i < 5; i++ )
+	{
+		Key [ 0 ] = (BLOWFISH_UCHAR)( 'a' + i );
+
+		Failures += BLOWFISH_Init ( &Contexts [ i ], Key, sizeof ( Key ), BLOWFISH_MODE_ECB, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	/* Runs of the same key schedule mixed with keys changing every block */ 
+
+	for ( i = 0; i < BlockCount; i++ )
+	{
+		KeySchedules [ i ] = &Contexts [ ( i & 32 ) != 0 ? 0 : ( i * 3 ) % 5 ].KeySchedule;
+		High32 [ i ] = (BLOWFISH_ULONG)( i * 0x9e3779b9UL );
+		Low32 [ i ] = (BLOWFISH_ULONG)( i ^ 0xdeadbeefUL );
+	}
+
+	Failures += BLOWFISH_EncipherMultiKey ( BlockCount, 0, High32, Low32 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_EncipherMultiKey ( 0, KeySchedules, High32, Low32 ) != BLOWFISH_RC_SUCCESS;
+
+#ifdef _OPENMP
+
+	Failures += BLOWFISH_EncipherMultiKey ( -1, KeySchedules, High32, Low32 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_DecipherMultiKey ( -1, KeySchedules, High32, Low32 ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+#endif
+
+	Failures += BLOWFISH_EncipherMultiKey ( BlockCount, KeySchedules, High32, Low32 ) != BLOWFISH_RC_SUCCESS;
+
+	for ( i = 0; i < BlockCount; i++ )
+	{
+		ExpectedHigh32 = (BLOWFISH_ULONG)( i * 0x9e3779b9UL );
+		ExpectedLow32 = (BLOWFISH_ULONG)( i ^ 0xdeadbeefUL );
+
+		BLOWFISH_Encipher ( &Contexts [ ( i & 32 ) != 0 ? 0 : ( i * 3 ) % 5 ], &ExpectedHigh32, &ExpectedLow32 );
+
+		Failures += High32 [ i ] != ExpectedHigh32 || Low32 [ i ] != ExpectedLow32;
+	}
+
+	Failures += BLOWFISH_DecipherMultiKey ( BlockCount, KeySchedules, High32, Low32 ) != BLOWFISH_RC_SUCCESS;
+
+	for ( i = 0; i < BlockCount; i++ )
+	{
+		Failures += High32 [ i ] != (BLOWFISH_ULONG)( i * 0x9e3779b9UL ) || Low32 [ i ] != (BLOWFISH_ULONG)( i ^ 0xdeadbeefUL );
+	}
+
+	/* A null key schedule pointer must be rejected before any block is changed */ 
+
+	KeySchedules [ 300 ] = 0;
+
+	Failures += BLOWFISH_DecipherMultiKey ( BlockCount, KeySchedules, High32, Low32 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += High32 [ 0 ] != 0 || Low32 [ 0 ] != 0xdeadbeefUL;
+
+	for ( i = 0; i < 5; i++ )
+	{
+		BLOWFISH_Exit ( &Contexts [ i ] );
+	}
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherMultiKey", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher an array of 64-bit values with #BLOWFISH_EncipherU64Array, check a known answer and compare every value against #BLOWFISH_Encipher, then decipher the array in place with #BLOWFISH_DecipherU64Array.
+
+	@remarks The value count leaves a partial chunk, and a partial group of blocks for the interleaved and vectorised kernels.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_U64Array ( void )
+{
+	BLOWFISH_RC				ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT		Context;
+	BLOWFISH_ULONGLONG		PlainText [ 1037 ];
+	BLOWFISH_ULONGLONG		CipherText [ 1037 ];
+	BLOWFISH_ULONG			High32;
+	BLOWFISH_ULONG			Low32;
+	BLOWFISH_SIZE_T			Count = (BLOWFISH_SIZE_T)( sizeof ( PlainText ) / sizeof ( PlainText [ 0 ] ) );
+	BLOWFISH_SIZE_T			i;
+	int						Failures = 0;
+
+	printf ( "U64 values=%d\n", (int)Count );
+
+	/* The first value is an ECB test vector, so the halves of each value must be in a fixed order on every host */ 
+
+	for ( i = 0; i < Count; i++ )
+	{
+		PlainText [ i ] = ( (BLOWFISH_ULONGLONG)_BLOWFISH_EcbTv1 [ 3 ].PlainText [ 0 ] << 32 | _BLOWFISH_EcbTv1 [ 3 ].PlainText [ 1 ] ) + (BLOWFISH_ULONGLONG)i * 0x9e3779b97f4a7c15ULL;
+	}
+
+	Failures += BLOWFISH_Init ( &Context, _BLOWFISH_EcbTv1 [ 3 ].Key, sizeof ( _BLOWFISH_EcbTv1 [ 3 ].Key ), BLOWFISH_MODE_CBC, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+
+	Failures += BLOWFISH_EncipherU64Array ( 0, PlainText, CipherText, Count ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_EncipherU64Array ( &Context, PlainText, 0, Count ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+#ifdef _OPENMP
+
+	Failures += BLOWFISH_EncipherU64Array ( &Context, PlainText, CipherText, -1 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_DecipherU64Array ( &Context, PlainText, CipherText, -1 ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+#endif
+
+	Failures += BLOWFISH_EncipherU64Array ( &Context, PlainText, CipherText, Count ) != BLOWFISH_RC_SUCCESS;
+
+	Failures += CipherText [ 0 ] != ( (BLOWFISH_ULONGLONG)_BLOWFISH_EcbTv1 [ 3 ].CipherText [ 0 ] << 32 | _BLOWFISH_EcbTv1 [ 3 ].CipherText [ 1 ] );
+
+	for ( i = 0; i < Count; i++ )
+	{
+		High32 = (BLOWFISH_ULONG)( PlainText [ i ] >> 32 );
+		Low32 = (BLOWFISH_ULONG)PlainText [ i ];
+
+		BLOWFISH_Encipher ( &Context, &High32, &Low32 );
+
+		Failures += CipherText [ i ] != ( (BLOWFISH_ULONGLONG)High32 << 32 | Low32 );
+	}
+
+	/* Decipher in place */ 
+
+	Failures += BLOWFISH_DecipherU64Array ( &Context, CipherText, CipherText, Count ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( CipherText, PlainText, sizeof ( PlainText ) ) != 0;
+
+	BLOWFISH_Exit ( &Context );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherU64Array", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Verify the number of threads used by stream functions, with and without a limit, for chained modes, and when called from within a parallel region.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Threads ( void )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Contexts [ 4 ];
+	BLOWFISH_UCHAR		PlainText [ 4096 ];
+	BLOWFISH_UCHAR		CipherText [ 4 ] [ 4096 ];
+	BLOWFISH_ULONG		Expected = 1;
+	BLOWFISH_SIZE_T		i;
+	int					Failures = 0;
+
+#ifdef _OPENMP
+
+	Expected = omp_get_max_threads ( ) < 4 ? (BLOWFISH_ULONG)omp_get_max_threads ( ) : 4;
+
+#endif
+
+	memset ( PlainText, 0x5a, sizeof ( PlainText ) );
+
+	for ( i = 0; i < 4; i++ )
+	{
+		Failures += BLOWFISH_Init ( &Contexts [ i ], (BLOWFISH_PUCHAR)"0123456789abcdef", 16, BLOWFISH_MODE_CTR64, 0, (BLOWFISH_ULONG)i ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	/* Without a limit, 4096 bytes with a 1024 byte threshold use up to 4 threads */ 
+
+	BLOWFISH_SetParallelThreshold ( 1024 );
+
+	Failures += BLOWFISH_EncipherBuffer ( &Contexts [ 0 ], PlainText, CipherText [ 0 ], sizeof ( PlainText ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_GetThreadsUsed ( &Contexts [ 0 ] ) != Expected;
+
+	/* A limit of 1 keeps the work on the calling thread */ 
+
+	Failures += BLOWFISH_SetThreads ( &Contexts [ 0 ], 1 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Contexts [ 0 ], PlainText, CipherText [ 0 ], sizeof ( PlainText ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_GetThreadsUsed ( &Contexts [ 0 ] ) != 1;
+
+	/* Calls from within a parallel region, and in modes that are not parallelised, use only the calling thread */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( Contexts, PlainText, CipherText ) reduction ( + : Failures ) schedule ( static )
+
+#endif
+
+	for ( i = 1; i < 4; i++ )
+	{
+		Failures += BLOWFISH_EncipherBuffer ( &Contexts [ i ], PlainText, CipherText [ i ], sizeof ( PlainText ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_GetThreadsUsed ( &Contexts [ i ] ) != 1;
+	}
+
+	Failures += BLOWFISH_Reset ( &Contexts [ 0 ], 0, 0, BLOWFISH_MODE_CBC, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Contexts [ 0 ], PlainText, CipherText [ 0 ], sizeof ( PlainText ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_GetThreadsUsed ( &Contexts [ 0 ] ) != 1;
+
+	BLOWFISH_SetParallelThreshold ( BLOWFISH_DEFAULT_PARALLEL_THRESHOLD );
+
+	for ( i = 0; i < 4; i++ )
+	{
+		BLOWFISH_Exit ( &Contexts [ i ] );
+	}
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_GetThreadsUsed", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher several messages of different lengths with #BLOWFISH_EncipherBufferMulti, and verify the results against each message enciphered separately with #BLOWFISH_EncipherBuffer.
+
+	@param BufferCount	Number of messages to encipher.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Multi ( BLOWFISH_ULONG BufferCount )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_PUCHAR		PlainText = 0;
+	BLOWFISH_PUCHAR		CipherText = 0;
+	BLOWFISH_PUCHAR		Expected = 0;
+	BLOWFISH_PCUCHAR *	PlainTextBuffers = 0;
+	BLOWFISH_PUCHAR *	CipherTextBuffers = 0;
+	BLOWFISH_SIZE_T *	BufferLengths = 0;
+	BLOWFISH_PULONG		IvHigh32 = 0;
+	BLOWFISH_PULONG		IvLow32 = 0;
+	BLOWFISH_ULONG		TotalLength = 0;
+	BLOWFISH_ULONG		i;
+
+	/* Initialise blowfish (the mode and initialisation vector are replaced for each message) */ 
+
+	ReturnCode = BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"0123456789abcdef", 16, BLOWFISH_MODE_CBC, _BLOWFISH_Tv3Iv [ 0 ], _BLOWFISH_Tv3Iv [ 1 ] );
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_Init", ReturnCode );
+
+	printf ( "Multi-buffer CBC messages=%d\n", (int)BufferCount );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		PlainTextBuffers = (BLOWFISH_PCUCHAR *)malloc ( BufferCount * sizeof ( BLOWFISH_PCUCHAR ) );
+		CipherTextBuffers = (BLOWFISH_PUCHAR *)malloc ( BufferCount * sizeof ( BLOWFISH_PUCHAR ) );
+		BufferLengths = (BLOWFISH_SIZE_T *)malloc ( BufferCount * sizeof ( BLOWFISH_SIZE_T ) );
+		IvHigh32 = (BLOWFISH_PULONG)malloc ( BufferCount * sizeof ( BLOWFISH_ULONG ) );
+		IvLow32 = (BLOWFISH_PULONG)malloc ( BufferCount * sizeof ( BLOWFISH_ULONG ) );
+
+		/* Vary the message lengths between 1 and 13 blocks */ 
+
+		for ( i = 0; i < BufferCount && BufferLengths != 0; i++ )
+		{
+			BufferLengths [ i ] = ( ( i * 7 ) % 13 + 1 ) * 8;
+
+			TotalLength += (BLOWFISH_ULONG)BufferLengths [ i ];
+		}
+
+		PlainText = (BLOWFISH_PUCHAR)malloc ( TotalLength );
+		CipherText = (BLOWFISH_PUCHAR)malloc ( TotalLength );
+		Expected = (BLOWFISH_PUCHAR)malloc ( TotalLength );
+
+		if ( PlainTextBuffers != 0 && CipherTextBuffers != 0 && BufferLengths != 0 && IvHigh32 != 0 && IvLow32 != 0 && PlainText != 0 && CipherText != 0 && Expected != 0 )
+		{
+			for ( i = 0; i < TotalLength; i++ )
+			{
+				PlainText [ i ] = (BLOWFISH_UCHAR)( i * 31 );
+			}
+
+			/* Encipher each message separately to compute the expected ciphertext */ 
+
+			for ( i = 0, TotalLength = 0; i < BufferCount && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+			{
+				PlainTextBuffers [ i ] = PlainText + TotalLength;
+				CipherTextBuffers [ i ] = CipherText + TotalLength;
+				IvHigh32 [ i ] = _BLOWFISH_Tv3Iv [ 0 ] + i;
+				IvLow32 [ i ] = _BLOWFISH_Tv3Iv [ 1 ] ^ i;
+
+				ReturnCode = BLOWFISH_Reset ( &Context, 0, 0, BLOWFISH_MODE_CBC, IvHigh32 [ i ], IvLow32 [ i ] );
+
+				if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+				{
+					ReturnCode = BLOWFISH_EncipherBuffer ( &Context, PlainTextBuffers [ i ], Expected + TotalLength, BufferLengths [ i ] );
+				}
+
+				TotalLength += (BLOWFISH_ULONG)BufferLengths [ i ];
+			}
+
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBuffer", ReturnCode );
+
+			if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+			{
+				/* Encipher all messages at once */ 
+
+				ReturnCode = BLOWFISH_EncipherBufferMulti ( &Context, BufferCount, PlainTextBuffers, CipherTextBuffers, BufferLengths, IvHigh32, IvLow32 );
+
+				_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBufferMulti", ReturnCode );
+
+				/* Is the ciphertext as expected? */ 
+
+				if ( ReturnCode == BLOWFISH_RC_SUCCESS && memcmp ( Expected, CipherText, TotalLength ) != 0 )
+				{
+					_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBufferMulti", BLOWFISH_RC_TEST_FAILED );
+
+					ReturnCode = BLOWFISH_RC_TEST_FAILED;
+				}
+
+#ifdef _OPENMP
+
+				/* Negative message counts and buffer lengths must be rejected */ 
+
+				if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+				{
+					BufferLengths [ BufferCount - 1 ] = -8;
+
+					if ( BLOWFISH_EncipherBufferMulti ( &Context, -1, PlainTextBuffers, CipherTextBuffers, BufferLengths, IvHigh32, IvLow32 ) != BLOWFISH_RC_INVALID_PARAMETER || BLOWFISH_EncipherBufferMulti ( &Context, BufferCount, PlainTextBuffers, CipherTextBuffers, BufferLengths, IvHigh32, IvLow32 ) != BLOWFISH_RC_BAD_BUFFER_LENGTH )
+					{
+						_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherBufferMulti", BLOWFISH_RC_TEST_FAILED );
+
+						ReturnCode = BLOWFISH_RC_TEST_FAILED;
+					}
+				}
+
+#endif
+			}
+		}
+		else
+		{
+			ReturnCode = BLOWFISH_RC_ERROR;
+		}
+
+		free ( PlainTextBuffers );
+		free ( CipherTextBuffers );
+		free ( BufferLengths );
+		free ( IvHigh32 );
+		free ( IvLow32 );
+		free ( PlainText );
+		free ( CipherText );
+		free ( Expected );
+	}
+
+	printf ( "\n" );
+
+	/* Overwrite the blowfish context record */ 
+
+	BLOWFISH_Exit ( &Context );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher the same buffer with several sessions sharing one key schedule, interleaving their stream operations, and verify each result against a context record initialised with the same key, mode and initialisation vector.
+
+	@param Mode	Mode to use for the test.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Session ( BLOWFISH_MODE Mode )
+{
+	BLOWFISH_RC				ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_KEY_SCHEDULE	KeySchedule;
+	BLOWFISH_SESSION		Session [ 3 ];
+	BLOWFISH_CONTEXT		Context;
+	BLOWFISH_UCHAR			PlainText [ 136 ];
+	BLOWFISH_UCHAR			CipherText [ 3 ] [ 136 ];
+	BLOWFISH_UCHAR			Expected [ 136 ];
+	BLOWFISH_UCHAR			Deciphered [ 136 ];
+	BLOWFISH_ULONG			i;
+	BLOWFISH_ULONG			j;
+
+	printf ( "Shared key schedule sessions=%d\n", (int)( sizeof ( Session ) / sizeof ( Session [ 0 ] ) ) );
+
+	_BLOWFISH_PrintMode ( Mode );
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 17 );
+	}
+
+	/* Initialise the shared key schedule, and a session for each initialisation vector */ 
+
+	ReturnCode = BLOWFISH_InitKeySchedule ( &KeySchedule, _BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ) );
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitKeySchedule", ReturnCode );
+
+	for ( i = 0; i < sizeof ( Session ) / sizeof ( Session [ 0 ] ) && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+	{
+		ReturnCode = BLOWFISH_InitSession ( &Session [ i ], &KeySchedule, Mode, _BLOWFISH_Tv3Iv [ 0 ] + i, _BLOWFISH_Tv3Iv [ 1 ] ^ i );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			ReturnCode = BLOWFISH_BeginSessionStream ( &Session [ i ] );
+		}
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitSession", ReturnCode );
+
+	/* Encipher the buffer as a stream of two chunks per session, alternating between the sessions */ 
+
+	for ( j = 0; j < 2 && ReturnCode == BLOWFISH_RC_SUCCESS; j++ )
+	{
+		for ( i = 0; i < sizeof ( Session ) / sizeof ( Session [ 0 ] ) && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+		{
+			ReturnCode = BLOWFISH_EncipherSessionStream ( &Session [ i ], PlainText + j * 64, CipherText [ i ] + j * 64, j == 0 ? 64 : sizeof ( PlainText ) - 64 );
+		}
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherSessionStream", ReturnCode );
+
+	for ( i = 0; i < sizeof ( Session ) / sizeof ( Session [ 0 ] ) && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+	{
+		/* Encipher the buffer with a context record in the same chunks (counter mode advances per chunk), and compare */ 
+
+		ReturnCode = BLOWFISH_Init ( &Context, _BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ), Mode, _BLOWFISH_Tv3Iv [ 0 ] + i, _BLOWFISH_Tv3Iv [ 1 ] ^ i );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			BLOWFISH_BeginStream ( &Context );
+
+			ReturnCode = BLOWFISH_EncipherStream ( &Context, PlainText, Expected, 64 );
+
+			if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+			{
+				ReturnCode = BLOWFISH_EncipherStream ( &Context, PlainText + 64, Expected + 64, sizeof ( PlainText ) - 64 );
+			}
+
+			BLOWFISH_EndStream ( &Context );
+		}
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS && memcmp ( Expected, CipherText [ i ], sizeof ( Expected ) ) != 0 )
+		{
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
+
+		/* Decipher the session ciphertext in the same chunks, and compare */ 
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			BLOWFISH_BeginSessionStream ( &Session [ i ] );
+
+			ReturnCode = BLOWFISH_DecipherSessionStream ( &Session [ i ], CipherText [ i ], Deciphered, 64 );
+
+			if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+			{
+				ReturnCode = BLOWFISH_DecipherSessionStream ( &Session [ i ], CipherText [ i ] + 64, Deciphered + 64, sizeof ( Deciphered ) - 64 );
+			}
+		}
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS && memcmp ( PlainText, Deciphered, sizeof ( PlainText ) ) != 0 )
+		{
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherSessionStream", ReturnCode );
+
+	printf ( "\n" );
+
+	/* Overwrite the session records and the key schedule */ 
+
+	for ( i = 0; i < sizeof ( Session ) / sizeof ( Session [ 0 ] ); i++ )
+	{
+		BLOWFISH_EndSessionStream ( &Session [ i ] );
+		BLOWFISH_ExitSession ( &Session [ i ] );
+	}
+
+	BLOWFISH_ExitKeySchedule ( &KeySchedule );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Exercise a key cache: hits, least recently used eviction of unpinned entries, a full cache, and concurrent lookups, verifying every key schedule against one expanded with #BLOWFISH_InitKeySchedule.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_KeyCache ( )
+{
+	BLOWFISH_RC						ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_KEY_CACHE				Cache;
+	BLOWFISH_KEY_CACHE_ENTRY		Entries [ 4 ];
+	BLOWFISH_KEY_CACHE_STATISTICS	Statistics;
+	BLOWFISH_KEY_SCHEDULE			Reference [ 6 ];
+	BLOWFISH_UCHAR					Keys [ 6 ] [ sizeof ( _BLOWFISH_Tv3Key ) ];
+	BLOWFISH_PCKEY_SCHEDULE			Pinned [ 4 ];
+	BLOWFISH_PCKEY_SCHEDULE			KeySchedule;
+	BLOWFISH_CONTEXT				Context;
+	BLOWFISH_ULONG					Failures = 0;
+	BLOWFISH_SIZE_T					Used;
+	BLOWFISH_SIZE_T					i;
+	BLOWFISH_ULONG					j;
+
+	printf ( "Key cache entries=%d keys=%d\n", (int)( sizeof ( Entries ) / sizeof ( Entries [ 0 ] ) ), (int)( sizeof ( Keys ) / sizeof ( Keys [ 0 ] ) ) );
+
+	/* Expand each key directly, for reference */ 
+
+	for ( i = 0; i < (BLOWFISH_SIZE_T)( sizeof ( Keys ) / sizeof ( Keys [ 0 ] ) ) && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+	{
+		memcpy ( Keys [ i ], _BLOWFISH_Tv3Key, sizeof ( Keys [ i ] ) );
+
+		Keys [ i ] [ 0 ] ^= (BLOWFISH_UCHAR)i;
+
+		ReturnCode = BLOWFISH_InitKeySchedule ( &Reference [ i ], Keys [ i ], sizeof ( Keys [ i ] ) );
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitKeySchedule", ReturnCode );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		ReturnCode = BLOWFISH_InitKeyCache ( &Cache, Entries, sizeof ( Entries ) / sizeof ( Entries [ 0 ] ) );
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitKeyCache", ReturnCode );
+	}
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		printf ( "\n" );
+
+		return ReturnCode;
+	}
+
+	/* Miss, then hit, on key 0 */ 
+
+	for ( i = 0; i < 2; i++ )
+	{
+		ReturnCode = BLOWFISH_InitFromKeyCache ( &Cache, &Context, Keys [ 0 ], sizeof ( Keys [ 0 ] ), BLOWFISH_MODE_ECB, 0, 0 );
+
+		Failures += ReturnCode != BLOWFISH_RC_SUCCESS || memcmp ( Context.KeySchedule.PArray, Reference [ 0 ].PArray, sizeof ( Reference [ 0 ].PArray ) ) != 0 || memcmp ( Context.KeySchedule.SBox, Reference [ 0 ].SBox, sizeof ( Reference [ 0 ].SBox ) ) != 0;
+	}
+
+	/* Pin key 1, then insert keys 2 to 5, evicting keys 0 and 2 (key 1 is pinned) */ 
+
+	ReturnCode = BLOWFISH_AcquireKeySchedule ( &Cache, Keys [ 1 ], sizeof ( Keys [ 1 ] ), &Pinned [ 0 ] );
+
+	Failures += ReturnCode != BLOWFISH_RC_SUCCESS || memcmp ( Pinned [ 0 ]->PArray, Reference [ 1 ].PArray, sizeof ( Reference [ 1 ].PArray ) ) != 0;
+
+	for ( i = 2; i < 6; i++ )
+	{
+		Failures += BLOWFISH_InitFromKeyCache ( &Cache, &Context, Keys [ i ], sizeof ( Keys [ i ] ), BLOWFISH_MODE_ECB, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	ReturnCode = BLOWFISH_AcquireKeySchedule ( &Cache, Keys [ 1 ], sizeof ( Keys [ 1 ] ), &KeySchedule );
+
+	Failures += ReturnCode != BLOWFISH_RC_SUCCESS || KeySchedule != Pinned [ 0 ];
+
+	Failures += BLOWFISH_ReleaseKeySchedule ( &Cache, KeySchedule ) != BLOWFISH_RC_SUCCESS;
+
+	BLOWFISH_GetKeyCacheStatistics ( &Cache, &Statistics );
+
+	Failures += Statistics.Hits != 2 || Statistics.Misses != 6 || Statistics.Evictions != 2 || Statistics.EntriesUsed != 4;
+
+	/* Pin every entry (keys 1, 3, 4 and 5), so key 0 cannot be cached */ 
+
+	for ( i = 1; i < 4 && Failures == 0; i++ )
+	{
+		Failures += BLOWFISH_AcquireKeySchedule ( &Cache, Keys [ i + 2 ], sizeof ( Keys [ i + 2 ] ), &Pinned [ i ] ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	Failures += BLOWFISH_AcquireKeySchedule ( &Cache, Keys [ 0 ], sizeof ( Keys [ 0 ] ), &KeySchedule ) != BLOWFISH_RC_CACHE_FULL;
+
+	ReturnCode = BLOWFISH_InitFromKeyCache ( &Cache, &Context, Keys [ 0 ], sizeof ( Keys [ 0 ] ), BLOWFISH_MODE_ECB, 0, 0 );
+
+	Failures += ReturnCode != BLOWFISH_RC_SUCCESS || memcmp ( Context.KeySchedule.SBox, Reference [ 0 ].SBox, sizeof ( Reference [ 0 ].SBox ) ) != 0;
+
+	for ( i = 0; i < 4; i++ )
+	{
+		Failures += BLOWFISH_ReleaseKeySchedule ( &Cache, Pinned [ i ] ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	Failures += BLOWFISH_ReleaseKeySchedule ( &Cache, Pinned [ 0 ] ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_ReleaseKeySchedule ( &Cache, &Reference [ 0 ] ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+	BLOWFISH_GetKeyCacheStatistics ( &Cache, &Statistics );
+
+	Failures += Statistics.Hits != 5 || Statistics.Misses != 8 || Statistics.Evictions != 2;
+
+	/* Look up as many keys as there are entries concurrently (a lookup may find every entry pinned by other threads) */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i, ReturnCode, KeySchedule ) shared ( Cache, Keys, Reference ) reduction ( + : Failures ) schedule ( static )
+
+#endif
+
+	for ( i = 0; i < 1024; i++ )
+	{
+		ReturnCode = BLOWFISH_AcquireKeySchedule ( &Cache, Keys [ i % 4 ], sizeof ( Keys [ i % 4 ] ), &KeySchedule );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			Failures += memcmp ( KeySchedule->PArray, Reference [ i % 4 ].PArray, sizeof ( Reference [ i % 4 ].PArray ) ) != 0;
+			Failures += BLOWFISH_ReleaseKeySchedule ( &Cache, KeySchedule ) != BLOWFISH_RC_SUCCESS;
+		}
+		else
+		{
+			Failures += ReturnCode != BLOWFISH_RC_CACHE_FULL;
+		}
+	}
+
+	BLOWFISH_GetKeyCacheStatistics ( &Cache, &Statistics );
+
+	/* Entries left unused by threads racing to insert the same key must have been wiped, and every other entry counted as used */ 
+
+	for ( i = 0, Used = 0; i < (BLOWFISH_SIZE_T)( sizeof ( Entries ) / sizeof ( Entries [ 0 ] ) ); i++ )
+	{
+		if ( Entries [ i ].KeyLength != 0 )
+		{
+			Used++;
+
+			continue;
+		}
+
+		for ( j = 0; j < sizeof ( Entries [ i ].KeySchedule ); j++ )
+		{
+			Failures += ( (BLOWFISH_PCUCHAR)&Entries [ i ].KeySchedule ) [ j ] != 0;
+		}
+
+		for ( j = 0; j < sizeof ( Entries [ i ].Key ); j++ )
+		{
+			Failures += Entries [ i ].Key [ j ] != 0;
+		}
+	}
+
+	Failures += Statistics.EntriesUsed != Used;
+
+	printf ( "Hits=%llu Misses=%llu Evictions=%llu\n", Statistics.Hits, Statistics.Misses, Statistics.Evictions );
+
+	ReturnCode = Failures == 0 ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_TEST_FAILED;
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_AcquireKeySchedule", ReturnCode );
+
+	printf ( "\n" );
+
+	/* Overwrite the key cache and the context record */ 
+
+	BLOWFISH_ExitKeyCache ( &Cache );
+	BLOWFISH_Exit ( &Context );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Initialise several context records with #BLOWFISH_InitBatch (including one invalid key), and verify each against a context record initialised with #BLOWFISH_Init.
+
+	@param Count	Number of context records to initialise.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Batch ( BLOWFISH_ULONG Count )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_RC			Expected;
+	BLOWFISH_CONTEXT	Reference;
+	BLOWFISH_PCONTEXT	Contexts;
+	BLOWFISH_PUCHAR		KeyData;
+	BLOWFISH_PCUCHAR *	Keys;
+	BLOWFISH_SIZE_T *	KeyLengths;
+	BLOWFISH_PULONG		IvHigh32;
+	BLOWFISH_PULONG		IvLow32;
+	BLOWFISH_RC *		ReturnCodes;
+	BLOWFISH_ULONG		i;
+
+	printf ( "Batch key expansion keys=%d\n", (int)Count );
+
+	Contexts = (BLOWFISH_PCONTEXT)malloc ( Count * sizeof ( BLOWFISH_CONTEXT ) );
+	KeyData = (BLOWFISH_PUCHAR)malloc ( Count * BLOWFISH_MAX_KEY_LENGTH );
+	Keys = (BLOWFISH_PCUCHAR *)calloc ( Count, sizeof ( BLOWFISH_PCUCHAR ) );
+	KeyLengths = (BLOWFISH_SIZE_T *)calloc ( Count, sizeof ( BLOWFISH_SIZE_T ) );
+	IvHigh32 = (BLOWFISH_PULONG)calloc ( Count, sizeof ( BLOWFISH_ULONG ) );
+	IvLow32 = (BLOWFISH_PULONG)calloc ( Count, sizeof ( BLOWFISH_ULONG ) );
+	ReturnCodes = (BLOWFISH_RC *)malloc ( Count * sizeof ( BLOWFISH_RC ) );
+
+	if ( Contexts != 0 && KeyData != 0 && Keys != 0 && KeyLengths != 0 && IvHigh32 != 0 && IvLow32 != 0 && ReturnCodes != 0 )
+	{
+		/* Vary the key lengths across the valid range, making the key at index 5 too short */ 
+
+		for ( i = 0; i < Count * BLOWFISH_MAX_KEY_LENGTH; i++ )
+		{
+			KeyData [ i ] = (BLOWFISH_UCHAR)( i * 13 + 7 );
+		}
+
+		for ( i = 0; i < Count; i++ )
+		{
+			Keys [ i ] = KeyData + i * BLOWFISH_MAX_KEY_LENGTH;
+			KeyLengths [ i ] = i == 5 ? BLOWFISH_MIN_KEY_LENGTH - 1 : BLOWFISH_MIN_KEY_LENGTH + ( i * 11 ) % ( BLOWFISH_MAX_KEY_LENGTH - BLOWFISH_MIN_KEY_LENGTH + 1 );
+			IvHigh32 [ i ] = _BLOWFISH_Tv3Iv [ 0 ] + i;
+			IvLow32 [ i ] = _BLOWFISH_Tv3Iv [ 1 ] ^ i;
+		}
+
+		ReturnCode = BLOWFISH_InitBatch ( Contexts, Count, Keys, KeyLengths, BLOWFISH_MODE_CBC, IvHigh32, IvLow32, ReturnCodes );
+
+		Expected = Count > 5 ? BLOWFISH_RC_INVALID_KEY : BLOWFISH_RC_SUCCESS;
+
+		ReturnCode = ReturnCode == Expected ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_TEST_FAILED;
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitBatch", ReturnCode );
+
+		/* Compare each context record with one initialised singly */ 
+
+		for ( i = 0; i < Count && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+		{
+			Expected = BLOWFISH_Init ( &Reference, Keys [ i ], KeyLengths [ i ], BLOWFISH_MODE_CBC, IvHigh32 [ i ], IvLow32 [ i ] );
+
+			if ( ReturnCodes [ i ] != Expected )
+			{
+				ReturnCode = BLOWFISH_RC_TEST_FAILED;
+			}
+			else if ( Expected == BLOWFISH_RC_SUCCESS )
+			{
+				if ( memcmp ( Contexts [ i ].KeySchedule.PArray, Reference.KeySchedule.PArray, sizeof ( Reference.KeySchedule.PArray ) ) != 0 ||
+					memcmp ( Contexts [ i ].KeySchedule.SBox, Reference.KeySchedule.SBox, sizeof ( Reference.KeySchedule.SBox ) ) != 0 ||
+					Contexts [ i ].Session.OriginalIvHigh32 != IvHigh32 [ i ] || Contexts [ i ].Session.OriginalIvLow32 != IvLow32 [ i ] )
+				{
+					ReturnCode = BLOWFISH_RC_TEST_FAILED;
+				}
+			}
+
+			BLOWFISH_Exit ( &Reference );
+		}
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_Init", ReturnCode );
+
+#ifdef _OPENMP
+
+		/* Negative key counts must be rejected */ 
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			if ( BLOWFISH_InitBatch ( Contexts, -1, Keys, KeyLengths, BLOWFISH_MODE_CBC, IvHigh32, IvLow32, ReturnCodes ) != BLOWFISH_RC_INVALID_PARAMETER || BLOWFISH_InitKeyScheduleBatch ( &Reference.KeySchedule, -1, Keys, KeyLengths, ReturnCodes ) != BLOWFISH_RC_INVALID_PARAMETER )
+			{
+				ReturnCode = BLOWFISH_RC_TEST_FAILED;
+			}
+
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_InitBatch", ReturnCode );
+		}
+
+#endif
+
+		for ( i = 0; i < Count; i++ )
+		{
+			BLOWFISH_Exit ( &Contexts [ i ] );
+		}
+	}
+	else
+	{
+		ReturnCode = BLOWFISH_RC_ERROR;
+	}
+
+	free ( Contexts );
+	free ( KeyData );
+	free ( Keys );
+	free ( KeyLengths );
+	free ( IvHigh32 );
+	free ( IvLow32 );
+	free ( ReturnCodes );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Search the unused stack below the caller for the first 64 characters of the 4th bcrypt test password. Called through #_BLOWFISH_SearchStack so that it is not inlined, and its frame overlaps the frames of functions the caller has just returned from.
+
+	@param Found	Pointer to a counter, incremented if the password is found.
+
+  */ 
+
+static void _BLOWFISH_SearchStackUnused ( BLOWFISH_ULONG * Found )
+{
+	BLOWFISH_UCHAR							Stack [ 65536 ];
+	const volatile BLOWFISH_UCHAR * volatile	Unused = Stack;
+	const char *							Password = _BLOWFISH_BcryptPassword [ 3 ];
+	BLOWFISH_ULONG							i;
+	BLOWFISH_ULONG							j;
+
+	/* The array is deliberately left uninitialised, and read through a volatile pointer so that the reads are not optimised away */ 
+
+	for ( i = 0; i + 64 <= sizeof ( Stack ); i++ )
+	{
+		for ( j = 0; j < 64 && Unused [ i + j ] == (BLOWFISH_UCHAR)Password [ j ]; j++ )
+		{
+		}
+
+		if ( j == 64 )
+		{
+			( *Found )++;
+
+			return;
+		}
+	}
+
+	return;
+}
+
+/** @internal Pointer to #_BLOWFISH_SearchStackUnused, volatile so that the call cannot be inlined. */ 
+
+static void ( * volatile _BLOWFISH_SearchStack ) ( BLOWFISH_ULONG * Found ) = &_BLOWFISH_SearchStackUnused;
+
+/**
+
+	@internal
+
+	Executor used by #_BLOWFISH_Test_Bcrypt. Runs the loop on the calling thread in one range, then searches the stack the range used for a password it failed to wipe.
+
+	@param ExecutorContext	Pointer to a counter of the times the password was found (see #_BLOWFISH_SearchStackUnused).
+
+	@param Begin			First iteration of the loop.
+
+	@param End				Iteration following the loop.
+
+	@param Grain			Minimum number of iterations per range.
+
+	@param Body				Callback to run for the range.
+
+	@param BodyContext		Value passed to the callback.
+
+  */ 
+
+static void _BLOWFISH_WipeParallelFor ( void * ExecutorContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End, BLOWFISH_SIZE_T Grain, BLOWFISH_PARALLEL_BODY Body, void * BodyContext )
+{
+	( void )Grain;
+
+	Body ( BodyContext, Begin, End );
+
+	_BLOWFISH_SearchStack ( (BLOWFISH_ULONG *)ExecutorContext );
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Verify bcrypt hashing against known hashes, both singly and with #BLOWFISH_BcryptVerifyBatch (including wrong passwords and malformed hashes). Then verify that the batch leaves no copy of a password on the stack.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Bcrypt ( void )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_EXECUTOR	Executor;
+	BLOWFISH_RC			ReturnCodes [ 24 ];
+	BLOWFISH_RC			Expected [ 24 ];
+	const char *		Passwords [ 24 ];
+	const char *		Hashes [ 24 ];
+	char				Hash [ BLOWFISH_BCRYPT_HASH_LENGTH ];
+	char				Variant [ BLOWFISH_BCRYPT_HASH_LENGTH ];
+	BLOWFISH_ULONG		Vectors = sizeof ( _BLOWFISH_BcryptHash ) / sizeof ( _BLOWFISH_BcryptHash [ 0 ] );
+	BLOWFISH_ULONG		Count;
+	BLOWFISH_ULONG		Found = 0;
+	BLOWFISH_ULONG		i;
+
+	/* Hash a password with a known salt */ 
+
+	ReturnCode = BLOWFISH_BcryptHash ( _BLOWFISH_BcryptPassword [ 4 ], 4, _BLOWFISH_BcryptSalt, Hash );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && strcmp ( Hash, _BLOWFISH_BcryptHash [ 4 ] ) != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_BcryptHash", ReturnCode );
+
+	/* Verify each known hash singly, then against the wrong password */ 
+
+	for ( i = 0; i < Vectors && ReturnCode == BLOWFISH_RC_SUCCESS; i++ )
+	{
+		if ( BLOWFISH_BcryptVerify ( _BLOWFISH_BcryptPassword [ i ], _BLOWFISH_BcryptHash [ i ] ) != BLOWFISH_RC_SUCCESS ||
+			BLOWFISH_BcryptVerify ( _BLOWFISH_BcryptPassword [ ( i + 1 ) % Vectors ], _BLOWFISH_BcryptHash [ i ] ) != BLOWFISH_RC_HASH_MISMATCH )
+		{
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
+	}
+
+	/* The "$2a$" and "$2y$" variants are accepted, but malformed hashes are not */ 
+
+	strcpy ( Variant, _BLOWFISH_BcryptHash [ 4 ] );
+
+	Variant [ 2 ] = 'y';
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && BLOWFISH_BcryptVerify ( _BLOWFISH_BcryptPassword [ 4 ], Variant ) != BLOWFISH_RC_SUCCESS )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	Variant [ 2 ] = 'c';
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && BLOWFISH_BcryptVerify ( _BLOWFISH_BcryptPassword [ 4 ], Variant ) != BLOWFISH_RC_INVALID_HASH )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	Variant [ 2 ] = 'b';
+	Variant [ 10 ] = '*';
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && BLOWFISH_BcryptVerify ( _BLOWFISH_BcryptPassword [ 4 ], Variant ) != BLOWFISH_RC_INVALID_HASH )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_BcryptVerify", ReturnCode );
+
+	/* Verify a batch mixing costs, wrong passwords and a malformed hash, so that some groups are interleaved and some are not */ 
+
+	for ( Count = 0; Count < sizeof ( Passwords ) / sizeof ( Passwords [ 0 ] ); Count++ )
+	{
+		i = Count % Vectors;
+
+		Passwords [ Count ] = _BLOWFISH_BcryptPassword [ i ];
+		Hashes [ Count ] = _BLOWFISH_BcryptHash [ i ];
+		Expected [ Count ] = BLOWFISH_RC_SUCCESS;
+
+		if ( Count % 5 == 3 )
+		{
+			Passwords [ Count ] = _BLOWFISH_BcryptPassword [ ( i + 2 ) % Vectors ];
+			Expected [ Count ] = BLOWFISH_RC_HASH_MISMATCH;
+		}
+	}
+
+	Hashes [ 17 ] = _BLOWFISH_BcryptHash [ 0 ] + 1;
+	Expected [ 17 ] = BLOWFISH_RC_INVALID_HASH;
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		ReturnCode = BLOWFISH_BcryptVerifyBatch ( Count, Passwords, Hashes, ReturnCodes ) == BLOWFISH_RC_HASH_MISMATCH ? BLOWFISH_RC_SUCCESS : BLOWFISH_RC_TEST_FAILED;
+
+		for ( i = 0; i < Count; i++ )
+		{
+			if ( ReturnCodes [ i ] != Expected [ i ] )
+			{
+				ReturnCode = BLOWFISH_RC_TEST_FAILED;
+			}
+		}
+	}
+
+#ifdef _OPENMP
+
+	/* Negative password counts must be rejected */ 
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && BLOWFISH_BcryptVerifyBatch ( -1, Passwords, Hashes, ReturnCodes ) != BLOWFISH_RC_INVALID_PARAMETER )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+#endif
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_BcryptVerifyBatch", ReturnCode );
+
+	/* Verify an interleaved group of 4 and a single password on the calling thread, then search the stack they used for the password */ 
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		Executor.ParallelFor = &_BLOWFISH_WipeParallelFor;
+		Executor.Context = &Found;
+
+		for ( i = 0; i < 5; i++ )
+		{
+			Passwords [ i ] = _BLOWFISH_BcryptPassword [ 3 ];
+			Hashes [ i ] = _BLOWFISH_BcryptHash [ 3 ];
+		}
+
+		BLOWFISH_SetExecutor ( &Executor );
+
+		if ( BLOWFISH_BcryptVerifyBatch ( 5, Passwords, Hashes, ReturnCodes ) != BLOWFISH_RC_SUCCESS || Found != 0 )
+		{
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
+
+		BLOWFISH_SetExecutor ( 0 );
+
+		_BLOWFISH_PrintReturnCode ( "_BLOWFISH_Wipe", ReturnCode );
+	}
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Executor used by #_BLOWFISH_Test_Executor. Runs the loop on the calling thread in ranges of Grain iterations, last range first, so that results depending on the order the ranges run in are caught.
+
+	@param ExecutorContext	Pointer to a counter of the ranges run.
+
+	@param Begin			First iteration of the loop.
+
+	@param End				Iteration following the loop.
+
+	@param Grain			Minimum number of iterations per range.
+
+	@param Body				Callback to run for each range.
+
+	@param BodyContext		Value passed to the callback.
+
+  */ 
+
+static void _BLOWFISH_TestParallelFor ( void * ExecutorContext, BLOWFISH_SIZE_T Begin, BLOWFISH_SIZE_T End, BLOWFISH_SIZE_T Grain, BLOWFISH_PARALLEL_BODY Body, void * BodyContext )
+{
+	BLOWFISH_SIZE_T	Ranges = ( End - Begin + Grain - 1 ) / Grain;
+
+	while ( Ranges-- > 0 )
+	{
+		Body ( BodyContext, Begin + Ranges * Grain, Begin + ( Ranges + 1 ) * Grain < End ? Begin + ( Ranges + 1 ) * Grain : End );
+
+		( *(BLOWFISH_SIZE_T *)ExecutorContext )++;
+	}
+
+	return;
+}
+
+/**
+
+	@internal
+
+	Register an executor, and verify that streams in every mode, enciphered and deciphered in two calls, match the streams processed without it. Then verify the batch functions with the executor registered.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Executor ( void )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_RC			ReturnCodes [ 7 ];
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_EXECUTOR	Executor;
+	BLOWFISH_EXECUTOR	Invalid;
+	BLOWFISH_SIZE_T		Ranges = 0;
+	BLOWFISH_UCHAR		PlainText [ 4104 ];
+	BLOWFISH_UCHAR		CipherText [ 4104 ];
+	BLOWFISH_UCHAR		Expected [ 4104 ];
+	BLOWFISH_UCHAR		Deciphered [ 4104 ];
+	BLOWFISH_ULONG		Parallel;
+	BLOWFISH_ULONG		i;
+	int					Failures = 0;
+
+	Executor.ParallelFor = &_BLOWFISH_TestParallelFor;
+	Executor.Context = &Ranges;
+
+	Invalid.ParallelFor = 0;
+	Invalid.Context = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 7 );
+	}
+
+	Failures += BLOWFISH_SetExecutor ( &Invalid ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_GetExecutor ( ) != 0;
+
+	BLOWFISH_SetParallelThreshold ( 64 );
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ); i++ )
+	{
+		Parallel = _BLOWFISH_ReferenceMode [ i ] != BLOWFISH_MODE_OFB;
+
+		/* Encipher without the executor */ 
+
+		Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)_BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ), _BLOWFISH_ReferenceMode [ i ], 0x01234567, 0xfffffff0 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText, Expected, 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText + 1024, Expected + 1024, sizeof ( PlainText ) - 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+
+		/* Encipher and decipher with the executor */ 
+
+		Failures += BLOWFISH_SetExecutor ( &Executor ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_GetExecutor ( ) != &Executor;
+
+		Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText, CipherText, 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText + 1024, CipherText + 1024, sizeof ( PlainText ) - 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += ( BLOWFISH_GetThreadsUsed ( &Context ) > 1 ) != ( Parallel && _BLOWFISH_ReferenceMode [ i ] != BLOWFISH_MODE_CBC && _BLOWFISH_ReferenceMode [ i ] != BLOWFISH_MODE_CFB );
+		Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+
+		Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_DecipherStream ( &Context, CipherText, Deciphered, 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_DecipherStream ( &Context, CipherText + 1024, Deciphered + 1024, sizeof ( CipherText ) - 1024 ) != BLOWFISH_RC_SUCCESS;
+		Failures += ( BLOWFISH_GetThreadsUsed ( &Context ) > 1 ) != Parallel;
+		Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+
+		Failures += memcmp ( CipherText, Expected, sizeof ( CipherText ) ) != 0;
+		Failures += memcmp ( Deciphered, PlainText, sizeof ( PlainText ) ) != 0;
+
+		/* Ranges deciphered in place (other than in OFB mode, which cannot be) must not depend on ciphertext overwritten by another range */ 
+
+		if ( Parallel )
+		{
+			Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, Deciphered, sizeof ( PlainText ) ) != BLOWFISH_RC_SUCCESS;
+			Failures += BLOWFISH_DecipherBuffer ( &Context, Deciphered, Deciphered, sizeof ( Deciphered ) ) != BLOWFISH_RC_SUCCESS;
+			Failures += memcmp ( Deciphered, PlainText, sizeof ( PlainText ) ) != 0;
+		}
+
+		/* A limit of 2 threads splits the stream into at most 2 ranges */ 
+
+		Failures += BLOWFISH_SetThreads ( &Context, 2 ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Deciphered, sizeof ( CipherText ) ) != BLOWFISH_RC_SUCCESS;
+		Failures += BLOWFISH_GetThreadsUsed ( &Context ) != ( Parallel ? 2 : 1 );
+
+		Failures += BLOWFISH_SetExecutor ( 0 ) != BLOWFISH_RC_SUCCESS;
+
+		BLOWFISH_Exit ( &Context );
+	}
+
+	BLOWFISH_SetParallelThreshold ( BLOWFISH_DEFAULT_PARALLEL_THRESHOLD );
+
+	if ( Failures != 0 || Ranges == 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_SetExecutor", ReturnCode );
+
+	printf ( "\n" );
+
+	/* Run the batch functions on the executor */ 
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		BLOWFISH_SetExecutor ( &Executor );
+
+		Ranges = 0;
+
+		ReturnCode = _BLOWFISH_Test_Multi ( 203 );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			ReturnCode = _BLOWFISH_Test_Batch ( 37 );
+		}
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			ReturnCode = BLOWFISH_BcryptVerifyBatch ( sizeof ( ReturnCodes ) / sizeof ( ReturnCodes [ 0 ] ), _BLOWFISH_BcryptPassword, _BLOWFISH_BcryptHash, ReturnCodes );
+
+			_BLOWFISH_PrintReturnCode ( "BLOWFISH_BcryptVerifyBatch", ReturnCode );
+		}
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS && Ranges < 3 )
+		{
+			ReturnCode = BLOWFISH_RC_TEST_FAILED;
+		}
+
+		BLOWFISH_SetExecutor ( 0 );
+
+		printf ( "\n" );
+	}
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Submit jobs to a job queue until it is full, service and wait for them, then submit and wait for jobs from several threads at once. Verify each job's output against the buffer enciphered/deciphered directly.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_JobQueue ( void )
+{
+	BLOWFISH_RC					ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_JOB_QUEUE			Queue;
+	BLOWFISH_JOB_QUEUE_SLOT		Slots [ 4 ];
+	BLOWFISH_JOB				Jobs [ 16 ];
+	BLOWFISH_PCONTEXT			Contexts = 0;
+	BLOWFISH_PUCHAR				Buffers = 0;
+	BLOWFISH_UCHAR				Expected [ 1024 ];
+	BLOWFISH_SIZE_T				JobCount = (BLOWFISH_SIZE_T)( sizeof ( Jobs ) / sizeof ( Jobs [ 0 ] ) );
+	BLOWFISH_SIZE_T				i;
+	int							Failures = 0;
+
+	printf ( "Job queue slots=%d jobs=%d\n", (int)( sizeof ( Slots ) / sizeof ( Slots [ 0 ] ) ), (int)JobCount );
+
+	Contexts = (BLOWFISH_PCONTEXT)malloc ( JobCount * sizeof ( BLOWFISH_CONTEXT ) );
+	Buffers = (BLOWFISH_PUCHAR)malloc ( JobCount * sizeof ( Expected ) );
+
+	if ( Contexts == 0 || Buffers == 0 )
+	{
+		free ( Contexts );
+		free ( Buffers );
+
+		ReturnCode = BLOWFISH_RC_ERROR;
+
+		_BLOWFISH_PrintReturnCode ( "malloc", ReturnCode );
+
+		printf ( "\n" );
+
+		return ReturnCode;
+	}
+
+	Failures += BLOWFISH_InitJobQueue ( &Queue, Slots, 3 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_InitJobQueue ( &Queue, Slots, sizeof ( Slots ) / sizeof ( Slots [ 0 ] ) ) != BLOWFISH_RC_SUCCESS;
+
+	/* Encipher even buffers and decipher odd ones, each with its own context record */ 
+
+	for ( i = 0; i < JobCount; i++ )
+	{
+		Failures += BLOWFISH_Init ( &Contexts [ i ], (BLOWFISH_PUCHAR)_BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ), _BLOWFISH_ReferenceMode [ i % ( sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ) ) ], (BLOWFISH_ULONG)i, 0xfffffff0 ) != BLOWFISH_RC_SUCCESS;
+
+		memset ( Buffers + i * sizeof ( Expected ), (int)i, sizeof ( Expected ) );
+
+		Jobs [ i ].Context = &Contexts [ i ];
+		Jobs [ i ].Session = 0;
+		Jobs [ i ].Operation = ( i & 1 ) != 0 ? BLOWFISH_OPERATION_DECIPHER : BLOWFISH_OPERATION_ENCIPHER;
+		Jobs [ i ].InBuffer = Buffers + i * sizeof ( Expected );
+		Jobs [ i ].OutBuffer = Buffers + i * sizeof ( Expected );
+		Jobs [ i ].BufferLength = sizeof ( Expected );
+	}
+
+	/* Fill the queue, then make room for one more job and wait for it */ 
+
+	for ( i = 0; i < 4; i++ )
+	{
+		Failures += BLOWFISH_SubmitJob ( &Queue, &Jobs [ i ] ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	/* A job rejected as the queue is full must not be left pending */ 
+
+	Jobs [ 4 ].ReturnCode = BLOWFISH_RC_SUCCESS;
+
+	Failures += BLOWFISH_SubmitJob ( &Queue, &Jobs [ 4 ] ) != BLOWFISH_RC_QUEUE_FULL;
+	Failures += BLOWFISH_PollJob ( &Jobs [ 4 ] ) == BLOWFISH_RC_PENDING;
+	Failures += BLOWFISH_PollJob ( &Jobs [ 0 ] ) != BLOWFISH_RC_PENDING;
+
+	Failures += BLOWFISH_ServiceJobQueue ( &Queue, 2 ) != 2;
+	Failures += BLOWFISH_PollJob ( &Jobs [ 0 ] ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_PollJob ( &Jobs [ 2 ] ) != BLOWFISH_RC_PENDING;
+
+	Failures += BLOWFISH_SubmitJob ( &Queue, &Jobs [ 4 ] ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_WaitJob ( &Queue, &Jobs [ 4 ] ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_ServiceJobQueue ( &Queue, 0 ) != 0;
+
+	/* Submit and wait for the remaining jobs from several threads, retrying while the queue is full */ 
+
+#ifdef _OPENMP
+
+	#pragma omp parallel for default ( none ) private ( i ) shared ( Queue, Jobs, JobCount ) reduction ( + : Failures ) schedule ( dynamic )
+
+#endif
+
+	for ( i = 5; i < JobCount; i++ )
+	{
+		while ( BLOWFISH_SubmitJob ( &Queue, &Jobs [ i ] ) == BLOWFISH_RC_QUEUE_FULL )
+		{
+			BLOWFISH_ServiceJobQueue ( &Queue, 1 );
+		}
+
+		Failures += BLOWFISH_WaitJob ( &Queue, &Jobs [ i ] ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	/* Compare every job's output against the buffer enciphered/deciphered directly */ 
+
+	for ( i = 0; i < JobCount; i++ )
+	{
+		memset ( Expected, (int)i, sizeof ( Expected ) );
+
+		if ( ( i & 1 ) != 0 )
+		{
+			Failures += BLOWFISH_DecipherBuffer ( &Contexts [ i ], Expected, Expected, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+		}
+		else
+		{
+			Failures += BLOWFISH_EncipherBuffer ( &Contexts [ i ], Expected, Expected, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+		}
+
+		Failures += memcmp ( Buffers + i * sizeof ( Expected ), Expected, sizeof ( Expected ) ) != 0;
+
+		BLOWFISH_Exit ( &Contexts [ i ] );
+	}
+
+	free ( Contexts );
+	free ( Buffers );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_SubmitJob", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Encipher/decipher a #BLOWFISH_MODE_OFB stream with a keystream record attached, refilling its ring between calls by varying amounts so that it wraps around, runs dry and catches up with the stream again, and compare against the stream enciphered without one.
+
+	@remarks Restarted streams, cloned context records and detaching are also tested, as is a producer running on another thread when compiled with OpenMP.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Keystream ( void )
+{
+	static const BLOWFISH_ULONG		Chunks [ ] = { 3, 13, 200, 5, 7, 96, 1 };
+
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	Context;
+	BLOWFISH_CONTEXT	Clone;
+	BLOWFISH_KEYSTREAM	Keystream;
+	BLOWFISH_ULONG		Blocks [ 16 * 2 ];
+	BLOWFISH_UCHAR		PlainText [ 4096 ];
+	BLOWFISH_UCHAR		Expected [ 4096 ];
+	BLOWFISH_UCHAR		CipherText [ 4096 ];
+	BLOWFISH_UCHAR		Output [ 4096 ];
+	BLOWFISH_ULONG		Offset;
+	BLOWFISH_ULONG		Length;
+	BLOWFISH_ULONG		i;
+	int					Done;
+	int					Finished;
+	int					Failures = 0;
+
+	for ( i = 0; i < sizeof ( PlainText ); i++ )
+	{
+		PlainText [ i ] = (BLOWFISH_UCHAR)( i * 43 + 11 );
+	}
+
+	printf ( "Keystream ring blocks=%d, length=%d bytes\n", (int)( sizeof ( Blocks ) / 8 ), (int)sizeof ( PlainText ) );
+
+	Failures += BLOWFISH_Init ( &Context, (BLOWFISH_PUCHAR)"keystream", 9, BLOWFISH_MODE_OFB, 0x0badf00d, 0xdeadbeef ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, Expected, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+
+	Failures += BLOWFISH_InitKeystream ( &Keystream, Blocks, 12 ) != BLOWFISH_RC_INVALID_PARAMETER;
+	Failures += BLOWFISH_InitKeystream ( &Keystream, Blocks, sizeof ( Blocks ) / 8 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 0;
+
+	/* Only output feedback keystream can be generated ahead of the data */ 
+
+	Failures += BLOWFISH_Init ( &Clone, (BLOWFISH_PUCHAR)"keystream", 9, BLOWFISH_MODE_CBC, 0x0badf00d, 0xdeadbeef ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_AttachKeystream ( &Clone, &Keystream ) != BLOWFISH_RC_INVALID_MODE;
+
+	BLOWFISH_Exit ( &Clone );
+
+	Failures += BLOWFISH_AttachKeystream ( &Context, &Keystream ) != BLOWFISH_RC_SUCCESS;
+
+	/* Fill the ring, then take half of it */ 
+
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 4 ) != 4;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 12;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 0;
+
+	Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherStream ( &Context, PlainText, CipherText, 64 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 8;
+
+	/* Wrap around the ring, refilling it between calls */ 
+
+	for ( Offset = 64; Offset < 464; Offset += 40 )
+	{
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, CipherText + Offset, 40 ) != BLOWFISH_RC_SUCCESS;
+
+		BLOWFISH_FillKeystream ( &Keystream, 0 );
+	}
+
+	/* Run the ring dry, leaving the producer behind the stream, then let it catch up a block at a time */ 
+
+	Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, CipherText + Offset, 1024 ) != BLOWFISH_RC_SUCCESS;
+
+	for ( Offset += 1024; Offset < 1616; Offset += 8 )
+	{
+		BLOWFISH_FillKeystream ( &Keystream, 0 );
+
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, CipherText + Offset, 8 ) != BLOWFISH_RC_SUCCESS;
+	}
+
+	Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, CipherText + Offset, 64 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 9;
+
+	/* Stream the rest in chunks with partial blocks, refilling the ring by varying amounts */ 
+
+	for ( Offset += 64, i = 0; Offset < sizeof ( PlainText ); Offset += Length, i++ )
+	{
+		Length = Chunks [ i % ( sizeof ( Chunks ) / sizeof ( Chunks [ 0 ] ) ) ];
+		Length = Length < sizeof ( PlainText ) - Offset ? Length : sizeof ( PlainText ) - Offset;
+
+		Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, CipherText + Offset, Length ) != BLOWFISH_RC_SUCCESS;
+
+		BLOWFISH_FillKeystream ( &Keystream, i % 3 );
+	}
+
+	Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( CipherText, Expected, sizeof ( Expected ) ) != 0;
+
+	/* A restarted stream goes back to keystream the ring has discarded */ 
+
+	BLOWFISH_FillKeystream ( &Keystream, 0 );
+
+	Failures += BLOWFISH_DecipherBuffer ( &Context, CipherText, Output, sizeof ( Output ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( Output, PlainText, sizeof ( PlainText ) ) != 0;
+
+	/* A clone is not attached, so leaves the ring alone */ 
+
+	BLOWFISH_FillKeystream ( &Keystream, 0 );
+
+	Failures += BLOWFISH_CloneContext ( &Context, &Clone ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_DecipherBuffer ( &Clone, CipherText, Output, sizeof ( Output ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( Output, PlainText, sizeof ( PlainText ) ) != 0;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 0;
+
+	BLOWFISH_Exit ( &Clone );
+
+	/* Attach the ring again to start it over, and fill it from another thread while the stream is enciphered */ 
+
+	Failures += BLOWFISH_AttachKeystream ( &Context, &Keystream ) != BLOWFISH_RC_SUCCESS;
+
+	Done = 0;
+
+#ifdef _OPENMP
+
+	#pragma omp parallel sections default ( none ) private ( Offset, Finished ) shared ( Context, Keystream, PlainText, Output, Done ) reduction ( + : Failures ) num_threads ( 2 )
+
+#endif
+
+	{
+
+#ifdef _OPENMP
+
+		#pragma omp section
+
+#endif
+
+		{
+			Failures += BLOWFISH_BeginStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+
+			for ( Offset = 0; Offset < sizeof ( PlainText ); Offset += 64 )
+			{
+				Failures += BLOWFISH_EncipherStream ( &Context, PlainText + Offset, Output + Offset, 64 ) != BLOWFISH_RC_SUCCESS;
+			}
+
+			Failures += BLOWFISH_EndStream ( &Context ) != BLOWFISH_RC_SUCCESS;
+
+#ifdef _OPENMP
+
+			#pragma omp atomic write
+
+#endif
+
+			Done = 1;
+		}
+
+#ifdef _OPENMP
+
+		#pragma omp section
+
+#endif
+
+		{
+			/* Refill the ring until the stream has been enciphered (the flag is read atomically, as it is written by the other thread) */ 
+
+			for ( Finished = 0; Finished == 0; )
+			{
+				BLOWFISH_FillKeystream ( &Keystream, 0 );
+
+#ifdef _OPENMP
+
+				#pragma omp atomic read
+
+#endif
+
+				Finished = Done;
+			}
+		}
+	}
+
+	Failures += memcmp ( Output, Expected, sizeof ( Expected ) ) != 0;
+
+	/* Detaching wipes the ring, and the stream is generated on the calling thread again */ 
+
+	Failures += BLOWFISH_AttachKeystream ( &Context, 0 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 0;
+
+	for ( i = 0; i < sizeof ( Blocks ) / sizeof ( Blocks [ 0 ] ); i++ )
+	{
+		Failures += Blocks [ i ] != 0;
+	}
+
+	Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, Output, sizeof ( Output ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( Output, Expected, sizeof ( Expected ) ) != 0;
+
+	/* Resetting the key detaches the ring and wipes it, so keystream generated with the old key is not used */ 
+
+	Failures += BLOWFISH_AttachKeystream ( &Context, &Keystream ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 16;
+	Failures += BLOWFISH_Reset ( &Context, (BLOWFISH_PUCHAR)"rekeyed", 7, BLOWFISH_MODE_CURRENT, 0, 0 ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_FillKeystream ( &Keystream, 0 ) != 0;
+
+	for ( i = 0; i < sizeof ( Blocks ) / sizeof ( Blocks [ 0 ] ); i++ )
+	{
+		Failures += Blocks [ i ] != 0;
+	}
+
+	Failures += BLOWFISH_Init ( &Clone, (BLOWFISH_PUCHAR)"rekeyed", 7, BLOWFISH_MODE_OFB, 0x0badf00d, 0xdeadbeef ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Clone, PlainText, Expected, sizeof ( Expected ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_EncipherBuffer ( &Context, PlainText, Output, sizeof ( Output ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += memcmp ( Output, Expected, sizeof ( Expected ) ) != 0;
+
+	BLOWFISH_Exit ( &Clone );
+	BLOWFISH_Exit ( &Context );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_FillKeystream", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Process a batch of jobs of different lengths, in every mode, with context records and with session records sharing key schedules, and verify each job against its buffer enciphered/deciphered directly. Invalid jobs must fail without affecting the others.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_ProcessBatch ( void )
+{
+	BLOWFISH_RC				ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_KEY_SCHEDULE	KeySchedules [ 2 ];
+	BLOWFISH_CONTEXT		Contexts [ 2 ];
+	BLOWFISH_SESSION		Sessions [ 100 ];
+	BLOWFISH_JOB			Jobs [ 100 ];
+	BLOWFISH_PUCHAR			Buffers = 0;
+	BLOWFISH_UCHAR			Expected [ 1032 ];
+	BLOWFISH_SIZE_T			JobCount = (BLOWFISH_SIZE_T)( sizeof ( Jobs ) / sizeof ( Jobs [ 0 ] ) );
+	BLOWFISH_SIZE_T			ModeCount = (BLOWFISH_SIZE_T)( sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ) );
+	BLOWFISH_SIZE_T			i;
+	int						Failures = 0;
+
+	printf ( "Batch jobs=%d\n", (int)JobCount );
+
+	Buffers = (BLOWFISH_PUCHAR)malloc ( JobCount * sizeof ( Expected ) );
+
+	if ( Buffers == 0 )
+	{
+		ReturnCode = BLOWFISH_RC_ERROR;
+
+		_BLOWFISH_PrintReturnCode ( "malloc", ReturnCode );
+
+		printf ( "\n" );
+
+		return ReturnCode;
+	}
+
+	Failures += BLOWFISH_InitKeySchedule ( &KeySchedules [ 0 ], _BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ) ) != BLOWFISH_RC_SUCCESS;
+	Failures += BLOWFISH_InitKeySchedule ( &KeySchedules [ 1 ], (BLOWFISH_PUCHAR)"0123456789abcdef", 16 ) != BLOWFISH_RC_SUCCESS;
+
+	/* Mostly cipher block chaining, so that lanes are refilled with jobs of different lengths and keys */ 
+
+	for ( i = 0; i < JobCount; i++ )
+	{
+		Failures += BLOWFISH_InitSession ( &Sessions [ i ], &KeySchedules [ i & 1 ], i % 3 != 0 ? BLOWFISH_MODE_CBC : _BLOWFISH_ReferenceMode [ ( i / 3 ) % ModeCount ], (BLOWFISH_ULONG)i, 0x89abcdef ) != BLOWFISH_RC_SUCCESS;
+
+		memset ( Buffers + i * sizeof ( Expected ), (int)i, sizeof ( Expected ) );
+
+		Jobs [ i ].Context = 0;
+		Jobs [ i ].Session = &Sessions [ i ];
+		Jobs [ i ].Operation = i % 5 == 4 ? BLOWFISH_OPERATION_DECIPHER : BLOWFISH_OPERATION_ENCIPHER;
+		Jobs [ i ].InBuffer = Buffers + i * sizeof ( Expected );
+		Jobs [ i ].OutBuffer = Buffers + i * sizeof ( Expected );
+		Jobs [ i ].BufferLength = ( ( i * 37 ) % ( sizeof ( Expected ) / 8 ) + 1 ) * 8;
+	}
+
+	/* Two jobs use context records instead, and two are invalid */ 
+
+	for ( i = 0; i < 2; i++ )
+	{
+		Failures += BLOWFISH_Init ( &Contexts [ i ], _BLOWFISH_Tv3Key, sizeof ( _BLOWFISH_Tv3Key ), BLOWFISH_MODE_CBC, 0x01234567, (BLOWFISH_ULONG)i ) != BLOWFISH_RC_SUCCESS;
+
+		Jobs [ 41 + i ].Context = &Contexts [ i ];
+		Jobs [ 41 + i ].Session = 0;
+	}
+
+	Jobs [ 50 ].BufferLength = 12;
+	Jobs [ 51 ].InBuffer = 0;
+
+	Failures += BLOWFISH_ProcessBatch ( JobCount, 0 ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+#ifdef _OPENMP
+
+	Failures += BLOWFISH_ProcessBatch ( -1, Jobs ) != BLOWFISH_RC_INVALID_PARAMETER;
+
+#endif
+
+	Failures += BLOWFISH_ProcessBatch ( JobCount, Jobs ) != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	Failures += Jobs [ 50 ].ReturnCode != BLOWFISH_RC_BAD_BUFFER_LENGTH;
+	Failures += Jobs [ 51 ].ReturnCode != BLOWFISH_RC_INVALID_PARAMETER;
+
+	/* Compare every valid job's output against the buffer enciphered/deciphered directly */ 
+
+	for ( i = 0; i < JobCount; i++ )
+	{
+		if ( i == 50 || i == 51 )
+		{
+			continue;
+		}
+
+		Failures += Jobs [ i ].ReturnCode != BLOWFISH_RC_SUCCESS;
+
+		memset ( Expected, (int)i, sizeof ( Expected ) );
+
+		if ( Jobs [ i ].Context != 0 )
+		{
+			Failures += BLOWFISH_EncipherBuffer ( Jobs [ i ].Context, Expected, Expected, Jobs [ i ].BufferLength ) != BLOWFISH_RC_SUCCESS;
+		}
+		else if ( Jobs [ i ].Operation == BLOWFISH_OPERATION_DECIPHER )
+		{
+			Failures += BLOWFISH_DecipherSessionBuffer ( &Sessions [ i ], Expected, Expected, Jobs [ i ].BufferLength ) != BLOWFISH_RC_SUCCESS;
+		}
+		else
+		{
+			Failures += BLOWFISH_EncipherSessionBuffer ( &Sessions [ i ], Expected, Expected, Jobs [ i ].BufferLength ) != BLOWFISH_RC_SUCCESS;
+		}
+
+		Failures += memcmp ( Buffers + i * sizeof ( Expected ), Expected, sizeof ( Expected ) ) != 0;
+	}
+
+	for ( i = 0; i < 2; i++ )
+	{
+		BLOWFISH_Exit ( &Contexts [ i ] );
+	}
+
+	free ( Buffers );
+
+	if ( Failures != 0 )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_ProcessBatch", ReturnCode );
+
+	printf ( "\n" );
+
+	return ReturnCode;
+}
+
+/**
+
+	@internal
+
+	Perform a stream based throughput test for the selected mode.
+
+	@param Mode				Mode to use for the test.
+
+	@param StreamBlockSize	Size of each chunk of the stream.
+
+	@remarks Enciphers/deciphers data as a stream for #_BLOWFISH_THROUGHPUT_DURATION seconds, and then calculates the throughput.
+
+	@return #BLOWFISH_RC_SUCCESS	Test passed successfully.
+
+	@return Specific return code, see #BLOWFISH_RC.
+
+  */ 
+
+static BLOWFISH_RC _BLOWFISH_Test_Throughput ( BLOWFISH_MODE Mode, BLOWFISH_ULONG StreamBlockSize )
+{
+	BLOWFISH_RC			ReturnCode = BLOWFISH_RC_SUCCESS;
+	BLOWFISH_CONTEXT	EncipherContext;
+	BLOWFISH_CONTEXT	DecipherContext;
+	BLOWFISH_PUCHAR		PlainTextBuffer = 0;
+	BLOWFISH_PUCHAR		CipherTextBuffer = 0;
+	BLOWFISH_SIZE_T		i = 0;
+	BLOWFISH_SIZE_T		j = 0;
+	BLOWFISH_ULONG		Sum = 0;
+	clock_t				StartTime = 0;
+	clock_t				EndTime = 0;
+	clock_t				ElapsedEncipherTime = 0;
+	clock_t				ElapsedDecipherTime = 0;
+	float				BlocksProcessed = 0;
+#ifdef _OPENMP
+	BLOWFISH_SIZE_T		Threads = omp_get_max_threads ( );
+#else
+	BLOWFISH_SIZE_T		Threads = 1;
+#endif
+
+	/* Initialise blowfish for the encipher stream */ 
+
+	ReturnCode = BLOWFISH_Init ( &EncipherContext, (BLOWFISH_PUCHAR)"0123456789abcdef", 16, Mode, _BLOWFISH_Tv3Iv [ 0 ], _BLOWFISH_Tv3Iv [ 1 ] );
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_Init", ReturnCode );
+
+	_BLOWFISH_PrintMode ( Mode );
+
+	_BLOWFISH_PrintKernel ( BLOWFISH_GetKernel ( ) );
+
+	printf ( "Key=\"0123456789abcdef\"\n" );
+
+	if ( Mode != BLOWFISH_MODE_ECB )
+	{
+		_BLOWFISH_PrintBuffer ( "Initialisation vector", (BLOWFISH_PUCHAR)_BLOWFISH_Tv3Iv, 8 );
+	}
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+	{
+		/* Clone the context for the decipher stream */ 
+
+		ReturnCode = BLOWFISH_CloneContext ( &EncipherContext, &DecipherContext );
+
+		_BLOWFISH_PrintReturnCode ( "BLOWFISH_CloneContext", ReturnCode );
+
+		if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+		{
+			/* Allocate the plaintext buffer */ 
+
+			PlainTextBuffer = (BLOWFISH_PUCHAR)malloc ( StreamBlockSize );
+
+			if ( PlainTextBuffer != 0 )
+			{
+				/* Allocate the ciphertext buffer */ 
+
+				CipherTextBuffer = (BLOWFISH_PUCHAR)malloc ( StreamBlockSize );
+
+				if ( CipherTextBuffer != 0 )
+				{
+					/* Create original plaintext buffer (use 0x01 for ease of vectorised verification) */ 
+
+					memset ( PlainTextBuffer, 0x01, StreamBlockSize );
+
+					/* Begin the stream for enciphering */ 
+
+					ReturnCode = BLOWFISH_BeginStream ( &EncipherContext );
+
+					_BLOWFISH_PrintReturnCode ( "BLOWFISH_BeginStream", ReturnCode );
+
+					if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+					{
+						/* Begin the stream for deciphering */ 
+
+						ReturnCode = BLOWFISH_BeginStream ( &DecipherContext );
+
+						_BLOWFISH_PrintReturnCode ( "BLOWFISH_BeginStream", ReturnCode );
+
+						if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+						{
+							/* While the total elapsed time (in seconds) has not passed the duration threshold, keep enciphering/deciphering the stream */ 
+
+							for ( i = 0; ( ( ElapsedEncipherTime + ElapsedDecipherTime ) / Threads ) / CLOCKS_PER_SEC <= _BLOWFISH_THROUGHPUT_DURATION; i++ )
+							{
+								/* Clear the ciphertext buffer */ 
+
+								memset ( CipherTextBuffer, 0x00, StreamBlockSize );
+
+								/* Encipher the plaintext */ 
+
+								StartTime = clock ( );
+
+								ReturnCode = BLOWFISH_EncipherStream ( &EncipherContext, PlainTextBuffer, CipherTextBuffer, StreamBlockSize );
+
+								EndTime = clock ( );
+
+								/* Compute the time elapsed enciphering (in milliseconds) */ 
+
+								ElapsedEncipherTime += ( EndTime - StartTime );
+
+								if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+								{
+									_BLOWFISH_PrintReturnCode ( "BLOWFISH_EncipherStream", ReturnCode );
+
+									break;
+								}
+
+								/* Clear the plaintext buffer */ 
+
+								memset ( PlainTextBuffer, 0x00, StreamBlockSize );
+
+								/* Decipher the ciphertext */ 
+
+								StartTime = clock ( );
+
+								ReturnCode = BLOWFISH_DecipherStream ( &DecipherContext, CipherTextBuffer, PlainTextBuffer, StreamBlockSize );
+
+								EndTime = clock ( );
+
+								/* Compute the time elapsed deciphering (in milliseconds) */ 
+
+								ElapsedDecipherTime += ( EndTime - StartTime );
+
+								if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+								{
+									_BLOWFISH_PrintReturnCode ( "BLOWFISH_DecipherStream", ReturnCode );
+
+									break;
+								}
+
+								/* Verify the integrity of the deciphered plaintext (sum of all bytes should equal the buffer length) */ 
+
+								for ( j = 0, Sum = 0; j < (BLOWFISH_SIZE_T)StreamBlockSize; j++ )
+								{
+									Sum += PlainTextBuffer [ j ];
+								}
+
+								if ( Sum != StreamBlockSize )
+								{
+									printf ( "BLOWFISH_EncipherStream()/BLOWFISH_DecipherStream()=Integrity check failed!\n" );
+
+									ReturnCode = BLOWFISH_RC_TEST_FAILED;
+
+									break;
+								}
+							}
+
+							if ( ReturnCode == BLOWFISH_RC_SUCCESS )
+							{
+								/* Ensure we managed to encipher/decipher enough data to determine the throughput in MB/s */ 
+
+								if ( ( i * StreamBlockSize ) > ( 1024 * 1024 ) )
+								{
+									/* Adjust elapsed time based on thread count */ 
+
+									ElapsedEncipherTime = ElapsedEncipherTime / Threads;
+									ElapsedDecipherTime = ElapsedDecipherTime / Threads;
+
+									/* Convert elapsed time from milliseconds to seconds (minimum 1 second) */ 
+
+									ElapsedEncipherTime = ElapsedEncipherTime / CLOCKS_PER_SEC > 1 ? ElapsedEncipherTime / CLOCKS_PER_SEC : 1;
+									ElapsedDecipherTime = ElapsedDecipherTime / CLOCKS_PER_SEC > 1 ? ElapsedDecipherTime / CLOCKS_PER_SEC : 1;
+
+									/* Calculate and display the stream length */ 
+
+									BlocksProcessed = (float)( (float)( i * StreamBlockSize ) / ( 1024 * 1024 ) );
+
+									printf ( "Stream length=%0.2f MB (%d*%d byte blocks)\n", BlocksProcessed, (int)i, (int)StreamBlockSize );
+
+									/* Calculate and display throughputs */ 
+
+									printf ( "Encipher throughput=%0.2f MB/s\n", BlocksProcessed / ElapsedEncipherTime );
+									printf ( "Decipher throughput=%0.2f MB/s\n", BlocksProcessed / ElapsedDecipherTime );
+									printf ( "Average throughput=%0.2f MB/s\n", ( ( BlocksProcessed / ElapsedDecipherTime ) + ( BlocksProcessed / ElapsedEncipherTime ) ) / 2 );
+								}
+								else
+								{
+									printf ( "Failed to process enough data to determine throughput in MB/s!\n" );
+
+									ReturnCode = BLOWFISH_RC_TEST_FAILED;
+								}
+							}
+
+							/* Finished decipering */ 
+
+							BLOWFISH_EndStream ( &DecipherContext );
+						}
+
+						/* Finished encipering */ 
+
+						BLOWFISH_EndStream ( &EncipherContext );
+					}
 
 					/* Free the ciphertext */ 
 
@@ -757,6 +3665,8 @@ static BLOWFISH_RC _BLOWFISH_SelfTest ( )
 {
 	BLOWFISH_RC		ReturnCode;
 	BLOWFISH_ULONG	i = 0;
+	BLOWFISH_ULONG	j = 0;
+	BLOWFISH_ULONG	k = 0;
 
 	printf ( "Standard test vectors...\n\n" );
 
@@ -796,6 +3706,264 @@ static BLOWFISH_RC _BLOWFISH_SelfTest ( )
 		}
 	}
 
+	/* Compare the stream functions for every mode against the single block reference, using each kernel supported by the processor */ 
+
+	printf ( "Reference tests...\n\n" );
+
+	/* Parallelise even the shortest buffers, so that every thread count is compared against the reference */ 
+
+	ReturnCode = BLOWFISH_SetParallelThreshold ( 8 );
+
+	if ( ReturnCode == BLOWFISH_RC_SUCCESS && ( BLOWFISH_GetParallelThreshold ( ) != 8 || BLOWFISH_SetParallelThreshold ( 4 ) != BLOWFISH_RC_INVALID_PARAMETER ) )
+	{
+		ReturnCode = BLOWFISH_RC_TEST_FAILED;
+	}
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_SetParallelThreshold", ReturnCode );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	for ( k = 0; k < sizeof ( _BLOWFISH_ReferenceKernel ) / sizeof ( _BLOWFISH_ReferenceKernel [ 0 ] ); k++ )
+	{
+		if ( BLOWFISH_SetKernel ( _BLOWFISH_ReferenceKernel [ k ] ) != BLOWFISH_RC_SUCCESS )
+		{
+			continue;
+		}
+
+		_BLOWFISH_PrintKernel ( _BLOWFISH_ReferenceKernel [ k ] );
+
+		printf ( "\n" );
+
+		for ( i = 0; i < sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ); i++ )
+		{
+			for ( j = 0; j < sizeof ( _BLOWFISH_ReferenceLength ) / sizeof ( _BLOWFISH_ReferenceLength [ 0 ] ); j++ )
+			{
+				ReturnCode = _BLOWFISH_Test_Reference ( _BLOWFISH_ReferenceMode [ i ], _BLOWFISH_ReferenceLength [ j ] );
+
+				if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+				{
+					return ReturnCode;
+				}
+			}
+		}
+
+		/* Decipher ranges of a stream with a 64-bit block counter */ 
+
+		ReturnCode = _BLOWFISH_Test_Seek ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher streams divided into buffers of any length */ 
+
+		ReturnCode = _BLOWFISH_Test_Chunked ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher unaligned buffers in big-endian byte order */ 
+
+		ReturnCode = _BLOWFISH_Test_ByteOrder ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher buffers of any length with PKCS#7 padding */ 
+
+		ReturnCode = _BLOWFISH_Test_Padded ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher buffers of any length with ciphertext stealing */ 
+
+		ReturnCode = _BLOWFISH_Test_CBC_CS3 ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher buffers in interleaved CBC lanes */ 
+
+		ReturnCode = _BLOWFISH_Test_CBC_Lanes ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Decipher chained modes in place, split between threads */ 
+
+		ReturnCode = _BLOWFISH_Test_InPlace ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher blocks with a different key schedule for each */ 
+
+		ReturnCode = _BLOWFISH_Test_MultiKey ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+
+		/* Encipher/decipher arrays of 64-bit values */ 
+
+		ReturnCode = _BLOWFISH_Test_U64Array ( );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	BLOWFISH_SetParallelThreshold ( BLOWFISH_DEFAULT_PARALLEL_THRESHOLD );
+
+	/* Compare multi-buffer CBC enciphering against enciphering each message separately */ 
+
+	printf ( "Multi-buffer tests...\n\n" );
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_MultiCount ) / sizeof ( _BLOWFISH_MultiCount [ 0 ] ); i++ )
+	{
+		ReturnCode = _BLOWFISH_Test_Multi ( _BLOWFISH_MultiCount [ i ] );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	/* Compare sessions sharing a key schedule against context records */ 
+
+	printf ( "Shared key schedule tests...\n\n" );
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_ReferenceMode ) / sizeof ( _BLOWFISH_ReferenceMode [ 0 ] ); i++ )
+	{
+		ReturnCode = _BLOWFISH_Test_Session ( _BLOWFISH_ReferenceMode [ i ] );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	/* Verify the number of threads used by stream functions */ 
+
+	printf ( "Thread budget tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_Threads ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Exercise the key schedule cache */ 
+
+	printf ( "Key cache tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_KeyCache ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Compare batched key expansion against expanding each key singly */ 
+
+	printf ( "Batch key expansion tests...\n\n" );
+
+	for ( i = 0; i < sizeof ( _BLOWFISH_BatchCount ) / sizeof ( _BLOWFISH_BatchCount [ 0 ] ); i++ )
+	{
+		ReturnCode = _BLOWFISH_Test_Batch ( _BLOWFISH_BatchCount [ i ] );
+
+		if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+		{
+			return ReturnCode;
+		}
+	}
+
+	/* Verify bcrypt against known hashes */ 
+
+	printf ( "bcrypt tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_Bcrypt ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Parallelise with a caller supplied executor in place of OpenMP */ 
+
+	printf ( "Executor tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_Executor ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Encipher/decipher buffers asynchronously through a job queue */ 
+
+	printf ( "Job queue tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_JobQueue ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Encipher/decipher an output feedback stream with keystream generated ahead of it */ 
+
+	printf ( "Keystream tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_Keystream ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Encipher/decipher many small buffers in one call */ 
+
+	printf ( "Batch job tests...\n\n" );
+
+	ReturnCode = _BLOWFISH_Test_ProcessBatch ( );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
+	/* Restore the automatically selected kernel for the throughput tests */ 
+
+	ReturnCode = BLOWFISH_SetKernel ( BLOWFISH_KERNEL_AUTO );
+
+	_BLOWFISH_PrintReturnCode ( "BLOWFISH_SetKernel", ReturnCode );
+
+	if ( ReturnCode != BLOWFISH_RC_SUCCESS )
+	{
+		return ReturnCode;
+	}
+
 #ifdef _OPENMP
 
 	/* Perform parallelised throughput tests if there is more than 1 available thread */ 